@@ -0,0 +1,343 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include <juce_cmp/juce_cmp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+/**
+ * IPC and rendering pipeline benchmark.
+ *
+ * Drives juce_cmp::Ipc against the headless echo child (benchmark/echo),
+ * which sends every ValueTree and MIDI message back and acknowledges each
+ * input event with a MIDI active sensing message. With --ui it also launches
+ * a real Compose UI through ComposeProvider and measures time to first frame
+ * and resize to SURFACE_READY.
+ *
+ * Prints one JSON object per line on stdout, so CI can track the numbers.
+ */
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int replyTimeoutMs = 10000;
+constexpr int launchTimeoutMs = 30000;
+
+struct Options
+{
+    juce::String echo;
+    juce::String ui;
+    int roundTrips = 1000;
+    int messages = 10000;
+    bool sharedMemory = false;
+};
+
+double microsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+juce::var percentiles(std::vector<double> values)
+{
+    auto* result = new juce::DynamicObject();
+    if (!values.empty())
+    {
+        std::sort(values.begin(), values.end());
+        auto at = [&values](double fraction) { return values[static_cast<size_t>(fraction * (values.size() - 1))]; };
+        result->setProperty("p50", at(0.5));
+        result->setProperty("p99", at(0.99));
+        result->setProperty("max", values.back());
+    }
+    return juce::var(result);
+}
+
+void print(const juce::var& result)
+{
+    std::printf("%s\n", juce::JSON::toString(result, true).toRawUTF8());
+    std::fflush(stdout);
+}
+
+juce::ValueTree makeTree(int numProperties)
+{
+    juce::ValueTree tree("bench");
+    for (int i = 0; i < numProperties; ++i)
+        tree.setProperty(juce::Identifier("p" + juce::String(i)), i * 0.5, nullptr);
+    return tree;
+}
+
+size_t encodedSize(const juce::ValueTree& tree)
+{
+    juce::MemoryOutputStream stream;
+    tree.writeToStream(stream);
+    return stream.getDataSize();
+}
+
+/** Counts replies from the echo child, on the Ipc reader thread. */
+class Replies
+{
+public:
+    void received(int count)
+    {
+        count_.fetch_add(count);
+        signal_.signal();
+    }
+
+    bool waitFor(int total, int timeoutMs)
+    {
+        auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(timeoutMs);
+        while (count_.load() < total)
+        {
+            auto now = juce::Time::getMillisecondCounter();
+            if (now >= deadline)
+                return false;
+            signal_.wait(static_cast<double>(deadline - now));
+        }
+        return true;
+    }
+
+    void reset() { count_.store(0); }
+
+private:
+    std::atomic<int> count_ { 0 };
+    juce::WaitableEvent signal_;
+};
+
+/** One echo child and the channel to it. */
+class EchoSession
+{
+public:
+    ~EchoSession()
+    {
+        child_.stop();
+        ipc_.stop();
+    }
+
+    bool start(const Options& options)
+    {
+        int shmFD = options.sharedMemory ? ipc_.createSharedMemory() : -1;
+        if (options.sharedMemory && shmFD < 0)
+            return false;
+
+        if (!child_.launch(options.echo.toStdString(), 1.0f, "", "", shmFD))
+            return false;
+
+        ipc_.closeSharedMemoryFD();
+        ipc_.setSocketFD(child_.getSocketFD());
+        ipc_.setOverflowPolicy(juce_cmp::Ipc::OverflowPolicy::Block);
+        ipc_.setEventHandler([this](const std::vector<juce::ValueTree>& trees) {
+            replies_.received(static_cast<int>(trees.size()));
+        }, juce_cmp::Ipc::Delivery::ReaderThread);
+        ipc_.setMidiHandler([this](const juce::MidiBuffer& messages) {
+            replies_.received(messages.getNumEvents());
+        }, juce_cmp::Ipc::Delivery::ReaderThread);
+        ipc_.startReceiving();
+
+        // The first reply also waits for the JVM to start
+        replies_.reset();
+        ipc_.sendMidi(juce::MidiMessage::noteOn(1, 60, 0.5f));
+        return replies_.waitFor(1, launchTimeoutMs);
+    }
+
+    /**
+     * Round-trip latency one message at a time, then throughput with all
+     * messages sent back to back. Each send must cause exactly one reply.
+     */
+    bool measure(juce::DynamicObject* result, const Options& options, const std::function<void()>& send)
+    {
+        // Let the child's JIT settle first
+        for (int i = 0; i < options.roundTrips; ++i)
+            if (!roundTrip(send))
+                return false;
+
+        std::vector<double> roundTrips;
+        roundTrips.reserve(static_cast<size_t>(options.roundTrips));
+        for (int i = 0; i < options.roundTrips; ++i)
+        {
+            auto start = Clock::now();
+            if (!roundTrip(send))
+                return false;
+            roundTrips.push_back(microsSince(start));
+        }
+
+        replies_.reset();
+        auto start = Clock::now();
+        for (int i = 0; i < options.messages; ++i)
+            send();
+        if (!replies_.waitFor(options.messages, replyTimeoutMs))
+            return false;
+        double seconds = microsSince(start) / 1e6;
+
+        result->setProperty("transport", options.sharedMemory ? "shm" : "socket");
+        result->setProperty("messages_per_sec", options.messages / seconds);
+        result->setProperty("rtt_us", percentiles(std::move(roundTrips)));
+        return true;
+    }
+
+    juce_cmp::Ipc& getIpc() { return ipc_; }
+
+private:
+    bool roundTrip(const std::function<void()>& send)
+    {
+        replies_.reset();
+        send();
+        return replies_.waitFor(1, replyTimeoutMs);
+    }
+
+    juce_cmp::ChildProcess child_;
+    juce_cmp::Ipc ipc_;
+    Replies replies_;
+};
+
+bool runIpcBenchmarks(const Options& options)
+{
+    EchoSession session;
+    if (!session.start(options))
+    {
+        std::fprintf(stderr, "Echo child did not start: %s\n", options.echo.toRawUTF8());
+        return false;
+    }
+
+    auto& ipc = session.getIpc();
+    auto run = [&](const char* name, const std::function<void(juce::DynamicObject*)>& describe,
+                   const std::function<void()>& send) {
+        juce::DynamicObject::Ptr result = new juce::DynamicObject();
+        result->setProperty("benchmark", name);
+        describe(result.get());
+        if (!session.measure(result.get(), options, send))
+        {
+            std::fprintf(stderr, "%s: echo child stopped replying\n", name);
+            return false;
+        }
+        print(juce::var(result.get()));
+        return true;
+    };
+
+    int x = 0;
+    bool ok = run("sendInput", [](juce::DynamicObject*) {}, [&] {
+        auto e = juce_cmp::InputEventFactory::mouseMove(x++ & 0xFF, 0, 0);
+        ipc.sendInput(e);
+    });
+
+    ok = ok && run("sendMidi", [](juce::DynamicObject*) {}, [&] {
+        ipc.sendMidi(juce::MidiMessage::noteOn(1, 60, 0.5f));
+    });
+
+    for (int numProperties : { 1, 16, 256, 4096 })
+    {
+        auto tree = makeTree(numProperties);
+        ok = ok && run("sendEvent", [&](juce::DynamicObject* result) {
+            result->setProperty("properties", numProperties);
+            result->setProperty("bytes", static_cast<juce::int64>(encodedSize(tree)));
+        }, [&] { ipc.sendEvent(tree); });
+    }
+
+    return ok;
+}
+
+/** Run the message loop until done() or the timeout. Returns done(). */
+bool pumpUntil(const std::function<bool()>& done, int timeoutMs)
+{
+    auto deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(timeoutMs);
+    while (!done() && juce::Time::getMillisecondCounter() < deadline)
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+    return done();
+}
+
+bool runProviderBenchmarks(const Options& options)
+{
+#if JUCE_MAC
+    constexpr int launches = 5;
+    constexpr int resizes = 20;
+
+    std::vector<double> firstFrame;
+    std::vector<double> resize;
+
+    for (int i = 0; i < launches; ++i)
+    {
+        juce_cmp::ComposeProvider provider;
+        provider.setSharedMemoryTransport(options.sharedMemory);
+
+        // Called for the first frame of every swap chain or scene size (SURFACE_READY)
+        bool surfaceReady = false;
+        provider.setFirstFrameCallback([&surfaceReady] { surfaceReady = true; });
+
+        auto start = Clock::now();
+        if (!provider.launch(options.ui.toStdString(), 400, 300, 2.0f)
+            || !pumpUntil([&] { return surfaceReady; }, launchTimeoutMs))
+        {
+            std::fprintf(stderr, "UI did not render its first frame: %s\n", options.ui.toRawUTF8());
+            return false;
+        }
+        firstFrame.push_back(microsSince(start) / 1000.0);
+
+        for (int r = 0; r < resizes; ++r)
+        {
+            surfaceReady = false;
+            start = Clock::now();
+            provider.resize(400 + (r % 2) * 100, 300, 0, 0);
+            if (!pumpUntil([&] { return surfaceReady; }, replyTimeoutMs))
+            {
+                std::fprintf(stderr, "UI did not answer a resize\n");
+                return false;
+            }
+            resize.push_back(microsSince(start) / 1000.0);
+        }
+
+        provider.stop();
+    }
+
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("benchmark", "composeProvider");
+    result->setProperty("transport", options.sharedMemory ? "shm" : "socket");
+    result->setProperty("first_frame_ms", percentiles(std::move(firstFrame)));
+    result->setProperty("resize_to_surface_ready_ms", percentiles(std::move(resize)));
+    print(juce::var(result.get()));
+    return true;
+#else
+    (void)options;
+    std::fprintf(stderr, "--ui is only supported on macOS\n");
+    return false;
+#endif
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    Options options;
+    options.echo = args.getValueForOption("--echo");
+    options.ui = args.getValueForOption("--ui");
+    options.sharedMemory = args.containsOption("--shm");
+    if (args.containsOption("--round-trips"))
+        options.roundTrips = juce::jmax(1, args.getValueForOption("--round-trips").getIntValue());
+    if (args.containsOption("--messages"))
+        options.messages = juce::jmax(1, args.getValueForOption("--messages").getIntValue());
+
+    if (options.echo.isEmpty() && options.ui.isEmpty())
+    {
+        std::fprintf(stderr,
+                     "Usage: %s [--echo=<echo child>] [--ui=<Compose UI>] [--shm]\n"
+                     "       [--round-trips=<n>] [--messages=<n>]\n",
+                     args.executableName.toRawUTF8());
+        return 2;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    bool ok = true;
+    if (options.echo.isNotEmpty())
+        ok = runIpcBenchmarks(options);
+    if (ok && options.ui.isNotEmpty())
+        ok = runProviderBenchmarks(options);
+
+    return ok ? 0 : 1;
+}
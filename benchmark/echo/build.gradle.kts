@@ -0,0 +1,17 @@
+plugins {
+    alias(libs.plugins.kotlinJvm)
+    application
+}
+
+kotlin {
+    jvmToolchain(21)
+}
+
+dependencies {
+    implementation("com.github.juce-cmp:lib")
+}
+
+application {
+    mainClass = "juce_cmp.benchmark.EchoKt"
+    applicationDefaultJvmArgs = listOf("--enable-native-access=ALL-UNNAMED")
+}
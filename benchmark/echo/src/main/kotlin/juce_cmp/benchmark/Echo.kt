@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.benchmark
+
+import juce_cmp.ipc.Ipc
+import javax.sound.midi.ShortMessage
+
+/**
+ * Headless echo child for the IPC benchmark (benchmark/Benchmark.cpp).
+ *
+ * Sends every ValueTree and MIDI message back to the host, and acknowledges
+ * each input event with MIDI active sensing since input has no UI → host
+ * counterpart. Renders nothing; exits when the host closes the socket.
+ */
+fun main(args: Array<String>) {
+    fun flag(name: String) = args.firstOrNull { it.startsWith("--$name=") }?.substringAfter("=")?.toIntOrNull()
+
+    val socketFD = flag("socket-fd") ?: error("Missing --socket-fd")
+    val ipc = Ipc(socketFD, flag("shm-fd"))
+    val ack = ShortMessage(ShortMessage.ACTIVE_SENSING)
+
+    ipc.startReceiving(
+        onInputEvent = { ipc.sendMidiEvent(ack) },
+        onJuceEvent = { ipc.sendJuceEvent(it) },
+        onMidiEvent = { ipc.sendMidiEvent(it) }
+    )
+
+    // The receiver exits the process on EOF
+    while (true) Thread.sleep(Long.MAX_VALUE)
+}
@@ -10,53 +10,44 @@
 #include "PluginEditor.h"
 
 PluginEditor::PluginEditor(PluginProcessor& p)
-    : AudioProcessorEditor(&p), processorRef(p)
+    : AudioProcessorEditor(&p), composeComponent(p.uiProvider)
 {
     setSize(768, 480);
     setResizable(true, true);  // Keep native corner for AU plugin compatibility
     setResizeLimits(400, 300, 2048, 2048);
     juce_cmp::ui_helpers::hideResizeHandle(*this);
 
-    // Set up loading preview from embedded data
+    // Set up loading preview from embedded data. ImageCache shares the decoded
+    // image between instances and the processor keeps it across editor reopens
     // NOTE: Background color should match Compose UI background in UserInterface.kt
-    composeComponent.setLoadingPreview(
-        juce::ImageFileFormat::loadFrom(loading_preview_png, loading_preview_png_len),
-        juce::Colour(0xFF6F97FF));
+    if (!p.loadingPreview.isValid())
+        p.loadingPreview = juce::ImageCache::getFromMemory(loading_preview_png,
+                                                           static_cast<int>(loading_preview_png_len));
+    composeComponent.setLoadingPreview(p.loadingPreview, juce::Colour(0xFF6F97FF));
 
-    // Wire up UI→Host events (interpret JuceValueTree as parameter changes)
-    composeComponent.onEvent([&p](const juce::ValueTree& tree) {
-        if (tree.getType() == juce::Identifier("param"))
-        {
-            auto paramId = static_cast<int>(tree.getProperty("id", -1));
-            auto value = static_cast<float>(static_cast<double>(tree.getProperty("value", 0.0)));
-
-            switch (paramId) {
-                case 0:
-                    if (p.shapeParameter != nullptr)
-                        p.shapeParameter->setValueNotifyingHost(value);
-                    break;
-                // Add more parameters here as needed
-            }
+    // Wire up UI→Host parameter changes, with gestures around knob drags
+    composeComponent.onParameter([&p](int index, float value, int flags) {
+        juce::AudioProcessorParameter* parameter = nullptr;
+        switch (index) {
+            case 0:
+                parameter = p.shapeParameter;
+                break;
+            // Add more parameters here as needed
         }
-    });
+        if (parameter == nullptr)
+            return;
 
-    // Wire up Host→UI parameter changes (automation from DAW, etc.)
-    p.setParameterChangedCallback([this](int paramIndex, float value) {
-        // Forward to Compose UI as event of type JUCE with ValueTree payload
-        juce::ValueTree tree("param");
-        tree.setProperty("id", paramIndex, nullptr);
-        tree.setProperty("value", static_cast<double>(value), nullptr);
-        composeComponent.sendEvent(tree);
+        if (flags & PARAM_FLAG_GESTURE_BEGIN)
+            parameter->beginChangeGesture();
+        parameter->setValueNotifyingHost(value);
+        if (flags & PARAM_FLAG_GESTURE_END)
+            parameter->endChangeGesture();
     });
 
     // Send initial parameter values when child process is ready
     composeComponent.onProcessReady([this, &p]() {
-        if (p.shapeParameter != nullptr) {
-            juce::ValueTree tree("param");
-            tree.setProperty("id", 0, nullptr);
-            tree.setProperty("value", static_cast<double>(p.shapeParameter->get()), nullptr);
-            composeComponent.sendEvent(tree);
-        }
+        if (p.shapeParameter != nullptr)
+            composeComponent.setParameter(0, p.shapeParameter->get());
         // Add more parameters here as needed
     });
 
@@ -70,11 +61,7 @@ PluginEditor::PluginEditor(PluginProcessor& p)
     repaint();  // Trigger initial paint to show "Starting UI..." text
 }
 
-PluginEditor::~PluginEditor()
-{
-    // Clear the callback to avoid dangling reference
-    processorRef.setParameterChangedCallback(nullptr);
-}
+PluginEditor::~PluginEditor() = default;
 
 void PluginEditor::paint(juce::Graphics& g)
 {
@@ -22,7 +22,6 @@ public:
     void resized() override;
 
 private:
-    PluginProcessor& processorRef;
     juce_cmp::ComposeComponent composeComponent;
     bool uiReady = false;
 
@@ -24,6 +24,10 @@ PluginProcessor::PluginProcessor()
     
     // Register to receive notifications when host changes parameter
     shapeParameter->addListener(this);
+
+    // Pre-warm the UI so opening the editor only takes a frame
+    uiProvider->setSharedProcess(uiProcess);
+    uiProcess->ensureRunning(juce_cmp::ui_helpers::getUIExecutable().getFullPathName().toStdString());
 }
 
 PluginProcessor::~PluginProcessor()
@@ -164,10 +168,9 @@ void PluginProcessor::setStateInformation(const void* data, int sizeInBytes)
 
 void PluginProcessor::parameterValueChanged(int parameterIndex, float newValue)
 {
-    // Notify the editor (if any) about the parameter change
-    // This fires when the host changes the parameter (automation, preset, etc.)
-    if (paramCallback)
-        paramCallback(parameterIndex, newValue);
+    // Host changes (automation, presets) reach the UI whether or not the editor is open.
+    // May be called on the audio thread - setParameter() only stores the value
+    uiProvider->setParameter(static_cast<uint32_t>(parameterIndex), newValue);
 }
 
 void PluginProcessor::parameterGestureChanged(int parameterIndex, bool gestureIsStarting)
@@ -4,7 +4,8 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
-#include <functional>
+#include <juce_cmp/juce_cmp.h>
+#include <memory>
 
 /**
  * AudioProcessor with shape parameter exposed to AU/VST hosts.
@@ -13,6 +14,10 @@
  * The shape parameter is automatable and saved with plugin state.
  * 
  * Implements Listener to notify the UI when host changes parameters.
+ *
+ * Owns the UI process and starts it on construction, so the editor opens
+ * on an already warm child instead of a cold JVM. Also owns the provider,
+ * so closing the editor keeps the UI and its state for the next one.
  */
 class PluginProcessor : public juce::AudioProcessor,
                         public juce::AudioProcessorParameter::Listener
@@ -54,15 +59,19 @@ public:
     void parameterValueChanged(int parameterIndex, float newValue) override;
     void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
 
-    /// Callback for parameter changes (used by editor to sync UI)
-    using ParameterChangedCallback = std::function<void(int paramIndex, float value)>;
-    void setParameterChangedCallback(ParameterChangedCallback cb) { paramCallback = std::move(cb); }
-
     /// Shape parameter (0 = sine, 1 = square) - exposed to host
     juce::AudioParameterFloat* shapeParameter = nullptr;
 
+    /// UI process kept warm for this instance's editor
+    std::shared_ptr<juce_cmp::UIProcess> uiProcess = std::make_shared<juce_cmp::UIProcess>();
+
+    /// Compose UI connection that outlives the editor
+    std::shared_ptr<juce_cmp::ComposeProvider> uiProvider = std::make_shared<juce_cmp::ComposeProvider>();
+
+    /// Loading preview, decoded when the first editor opens and kept for the next ones
+    juce::Image loadingPreview;
+
 private:
-    ParameterChangedCallback paramCallback;
     double currentSampleRate = 44100.0;
     double phase = 0.0;
     static constexpr double frequency = 440.0;
@@ -25,6 +25,8 @@ import kotlin.math.sin
  *
  * @param value Current value from 0f to 1f
  * @param onValueChange Callback when value changes
+ * @param onGestureStart Callback when a drag starts
+ * @param onGestureEnd Callback when a drag ends or is cancelled
  * @param modifier Modifier for the component
  * @param size Diameter of the knob
  * @param trackColor Color of the background track
@@ -37,6 +39,8 @@ import kotlin.math.sin
 fun Knob(
     value: Float,
     onValueChange: (Float) -> Unit,
+    onGestureStart: () -> Unit = {},
+    onGestureEnd: () -> Unit = {},
     modifier: Modifier = Modifier,
     size: Dp = 60.dp,
     trackColor: Color = Color.DarkGray,
@@ -51,12 +55,18 @@ fun Knob(
     // Use rememberUpdatedState to access current value without restarting gesture
     val currentValue by rememberUpdatedState(value)
     val currentOnValueChange by rememberUpdatedState(onValueChange)
+    val currentOnGestureStart by rememberUpdatedState(onGestureStart)
+    val currentOnGestureEnd by rememberUpdatedState(onGestureEnd)
     
     Canvas(
         modifier = modifier
             .size(size)
             .pointerInput(Unit) {
-                detectDragGestures { change, dragAmount ->
+                detectDragGestures(
+                    onDragStart = { currentOnGestureStart() },
+                    onDragEnd = { currentOnGestureEnd() },
+                    onDragCancel = { currentOnGestureEnd() }
+                ) { change, dragAmount ->
                     change.consume()
                     // Vertical drag (up = increase) and horizontal drag (right = increase)
                     val delta = (-dragAmount.y + dragAmount.x) * sensitivity
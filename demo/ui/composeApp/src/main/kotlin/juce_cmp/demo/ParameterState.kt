@@ -6,14 +6,15 @@ package juce_cmp.demo
 import androidx.compose.runtime.mutableStateMapOf
 import androidx.compose.runtime.snapshots.SnapshotStateMap
 import juce_cmp.Library
-import juce_cmp.ipc.JuceValueTree
+import juce_cmp.ipc.Param
 
 /**
  * Global parameter state that syncs between host and UI.
  *
  * Handles bidirectional parameter synchronization:
- * - RX: Host sends "param" events via onHostEvent() to update UI state
- * - TX: UI calls set() which updates state and notifies host
+ * - RX: Host parameter records arrive via onParameter() to update UI state
+ * - TX: UI calls set() which updates state and notifies host, with
+ *   beginGesture()/endGesture() around drags so the host groups automation
  *
  * The Compose UI observes these values and recomposes automatically.
  *
@@ -51,10 +52,17 @@ object ParameterState {
      */
     fun set(paramId: Int, value: Float) {
         parameters[paramId] = value
-        val tree = JuceValueTree("param")
-        tree["id"] = paramId
-        tree["value"] = value.toDouble()
-        Library.sendJuceEvent(tree)
+        Library.sendParameter(paramId, value)
+    }
+
+    /** Tell the host a drag started (AudioProcessorParameter::beginChangeGesture). */
+    fun beginGesture(paramId: Int) {
+        Library.sendParameter(paramId, get(paramId), Param.FLAG_GESTURE_BEGIN)
+    }
+
+    /** Tell the host a drag ended (AudioProcessorParameter::endChangeGesture). */
+    fun endGesture(paramId: Int) {
+        Library.sendParameter(paramId, get(paramId), Param.FLAG_GESTURE_END)
     }
 
     /**
@@ -63,16 +71,10 @@ object ParameterState {
     fun getState(): SnapshotStateMap<Int, Float> = parameters
 
     /**
-     * Handle a "param" event from the host.
+     * Handle a parameter value from the host.
      * Updates local state without sending back to host.
      */
-    fun onEvent(tree: JuceValueTree) {
-        if (tree.type == "param") {
-            val id = tree["id"].toInt()
-            val value = tree["value"].toDouble().toFloat()
-            if (id >= 0) {
-                parameters[id] = value
-            }
-        }
+    fun onParameter(id: Int, value: Float, flags: Int) {
+        parameters[id] = value
     }
 }
@@ -62,7 +62,9 @@ fun UserInterface() {
                     Spacer(modifier = Modifier.height(8.dp))
                     Knob(
                         value = shapeValue,
-                        onValueChange = { ParameterState.set(Shape, it) }
+                        onValueChange = { ParameterState.set(Shape, it) },
+                        onGestureStart = { ParameterState.beginGesture(Shape) },
+                        onGestureEnd = { ParameterState.endGesture(Shape) }
                     )
                     Spacer(modifier = Modifier.height(8.dp))
                     Text(
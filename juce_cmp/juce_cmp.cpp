@@ -5,5 +5,21 @@
 
 // Include all C++ implementation files
 #include "juce_cmp/ChildProcess.cpp"
+#include "juce_cmp/UIProcess.cpp"
+#include "juce_cmp/SharedRing.cpp"
+#include "juce_cmp/SharedBlob.cpp"
+#include "juce_cmp/VisualStream.cpp"
+#include "juce_cmp/ParameterSlots.cpp"
+#include "juce_cmp/FrameStats.cpp"
+#include "juce_cmp/MidiFifo.cpp"
+#include "juce_cmp/ValueTreeSync.cpp"
 #include "juce_cmp/Ipc.cpp"
 #include "juce_cmp/ComposeProvider.cpp"
+
+// Linux swap chains and view (macOS has its own in juce_cmp.mm)
+#if JUCE_LINUX
+#include "juce_cmp/Surface.cpp"
+#include "juce_cmp/Surface_linux.cpp"
+#include "juce_cmp/SurfaceView_linux.cpp"
+#include "juce_cmp/ComposeComponent.cpp"
+#endif
@@ -8,12 +8,13 @@
   vendor:           lucianoiam
   version:          0.0.1
   name:             Compose Multiplatform Embedding
-  description:      Embed Compose Multiplatform UI in JUCE plugins via IOSurface
+  description:      Embed Compose Multiplatform UI in JUCE plugins via IOSurface or DMA-BUF
   website:          https://github.com/lucianoiam/juce-cmp
   license:          MIT
 
   dependencies:     juce_gui_basics, juce_audio_processors, juce_data_structures
   OSXFrameworks:    IOSurface CoreVideo
+  linuxLibs:        gbm xcb xcb-dri3 xcb-present
 
  END_JUCE_MODULE_DECLARATION
 *******************************************************************************/
@@ -34,8 +35,16 @@ namespace juce_cmp
 // Internal implementation headers
 #include "juce_cmp/ipc_protocol.h"
 #include "juce_cmp/input_event.h"
+#include "juce_cmp/SharedRing.h"
+#include "juce_cmp/SharedBlob.h"
+#include "juce_cmp/VisualStream.h"
+#include "juce_cmp/ParameterSlots.h"
+#include "juce_cmp/FrameStats.h"
+#include "juce_cmp/MidiFifo.h"
+#include "juce_cmp/ValueTreeSync.h"
 #include "juce_cmp/Ipc.h"
 #include "juce_cmp/MachPort.h"
+#include "juce_cmp/UIProcess.h"
 #include "juce_cmp/ComposeProvider.h"
 #include "juce_cmp/ComposeComponent.h"
 #include "juce_cmp/ui_helpers.h"
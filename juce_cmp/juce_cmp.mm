@@ -5,10 +5,19 @@
 
 // Include all C++ implementation files (can be compiled in .mm on macOS)
 #include "juce_cmp/ChildProcess.cpp"
+#include "juce_cmp/UIProcess.cpp"
+#include "juce_cmp/SharedRing.cpp"
+#include "juce_cmp/SharedBlob.cpp"
+#include "juce_cmp/VisualStream.cpp"
+#include "juce_cmp/ParameterSlots.cpp"
+#include "juce_cmp/FrameStats.cpp"
+#include "juce_cmp/MidiFifo.cpp"
+#include "juce_cmp/ValueTreeSync.cpp"
 #include "juce_cmp/Ipc.cpp"
 #include "juce_cmp/ComposeProvider.cpp"
 
 // Include all Objective-C++ implementation files
+#include "juce_cmp/Surface.cpp"
 #include "juce_cmp/Surface.mm"
 #include "juce_cmp/SurfaceView.mm"
 #include "juce_cmp/MachPort.mm"
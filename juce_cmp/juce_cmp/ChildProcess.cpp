@@ -3,10 +3,17 @@
 
 #include "ChildProcess.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
 #include <vector>
 
 #if __APPLE__ || __linux__
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
 #include <spawn.h>
 #include <sys/wait.h>
@@ -24,12 +31,46 @@ ChildProcess::ChildProcess() = default;
 ChildProcess::~ChildProcess()
 {
     stop();
+    if (reaper_.joinable())
+        reaper_.join();
 }
 
 bool ChildProcess::launch(const std::string& executable,
                           float scale,
                           const std::string& machServiceName,
-                          const std::string& workingDir)
+                          const std::string& workingDir,
+                          int sharedMemoryFD,
+                          int visualStreamFD)
+{
+    std::vector<std::string> args;
+    std::vector<InheritedFD> inherited;
+    args.push_back("--scale=" + std::to_string(scale));
+    if (!machServiceName.empty())
+        args.push_back("--mach-service=" + machServiceName);
+    if (sharedMemoryFD >= 0)
+    {
+        args.push_back("--shm-fd=" + std::to_string(childSharedMemoryFD));
+        inherited.push_back({ sharedMemoryFD, childSharedMemoryFD });
+    }
+    if (visualStreamFD >= 0)
+    {
+        args.push_back("--stream-fd=" + std::to_string(childVisualStreamFD));
+        inherited.push_back({ visualStreamFD, childVisualStreamFD });
+    }
+
+    return spawn(executable, "--socket-fd=", args, workingDir, inherited);
+}
+
+bool ChildProcess::launchShared(const std::string& executable, const std::string& workingDir)
+{
+    return spawn(executable, "--control-fd=", {}, workingDir);
+}
+
+bool ChildProcess::spawn(const std::string& executable,
+                         const std::string& socketFlag,
+                         const std::vector<std::string>& args,
+                         const std::string& workingDir,
+                         std::vector<InheritedFD> inherited)
 {
 #if __APPLE__ || __linux__
     // Verify executable exists
@@ -37,41 +78,97 @@ bool ChildProcess::launch(const std::string& executable,
     if (stat(executable.c_str(), &st) != 0)
         return false;
 
-    std::string scaleArg = "--scale=" + std::to_string(scale);
-    std::string machServiceArg;
-    if (!machServiceName.empty())
-        machServiceArg = "--mach-service=" + machServiceName;
-
-    // Create Unix socket pair for bidirectional IPC
+    // Create Unix socket pair for bidirectional IPC. Both ends are close-on-exec,
+    // so no other process the host spawns meanwhile inherits them
     int sockets[2];
+#ifdef SOCK_CLOEXEC
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+        return false;
+#else
     if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
         return false;
+    fcntl(sockets[0], F_SETFD, FD_CLOEXEC);
+    fcntl(sockets[1], F_SETFD, FD_CLOEXEC);
+#endif
+
+    // Fds the child receives, each on a fixed descriptor
+    inherited.insert(inherited.begin(), { sockets[1], childSocketFD });
 
     // Build argument list
-    std::string socketArg = "--socket-fd=" + std::to_string(sockets[1]);
+    std::string socketArg = socketFlag + std::to_string(childSocketFD);
 
     std::vector<char*> argv;
     argv.push_back(const_cast<char*>(executable.c_str()));
     argv.push_back(const_cast<char*>(socketArg.c_str()));
-    argv.push_back(const_cast<char*>(scaleArg.c_str()));
-    if (!machServiceArg.empty())
-        argv.push_back(const_cast<char*>(machServiceArg.c_str()));
+    for (const auto& arg : args)
+        argv.push_back(const_cast<char*>(arg.c_str()));
     argv.push_back(nullptr);
 
-    // Set up file actions to close parent's socket end in child
+    // dup2 clears close-on-exec on the child's copy only; the parent's fds keep it.
+    // A source already sitting on a target fd would be overwritten by another dup2,
+    // or keep close-on-exec when duplicated onto itself, so move it above the targets
     posix_spawn_file_actions_t fileActions;
     posix_spawn_file_actions_init(&fileActions);
-    posix_spawn_file_actions_addclose(&fileActions, sockets[0]);
+
+    int maxChildFD = 0;
+    for (const auto& entry : inherited)
+        maxChildFD = std::max(maxChildFD, entry.childFD);
+
+    std::vector<int> movedFDs;
+    bool mapped = true;
+    for (auto& entry : inherited)
+    {
+        bool onTarget = false;
+        for (const auto& other : inherited)
+            onTarget = onTarget || entry.fd == other.childFD;
+
+        if (onTarget)
+        {
+            int fd = fcntl(entry.fd, F_DUPFD_CLOEXEC, maxChildFD + 1);
+            if (fd < 0)
+            {
+                mapped = false;
+                break;
+            }
+            movedFDs.push_back(fd);
+            entry.fd = fd;
+        }
+
+        posix_spawn_file_actions_adddup2(&fileActions, entry.fd, entry.childFD);
+    }
 
     // Set working directory (macOS 10.15+, glibc 2.29+)
     if (!workingDir.empty())
         posix_spawn_file_actions_addchdir_np(&fileActions, workingDir.c_str());
 
+    // Map the class data sharing archive recorded by the build (<executable>.jsa),
+    // so the JVM skips parsing and verifying most classes. A stale archive is ignored
+    std::string toolOptions;
+    std::vector<char*> envp;
+    std::string archive = executable + ".jsa";
+    if (stat(archive.c_str(), &st) == 0)
+    {
+        toolOptions = "JAVA_TOOL_OPTIONS=\"-XX:SharedArchiveFile=" + archive + "\" -Xshare:auto";
+        for (char** var = environ; *var != nullptr; ++var)
+        {
+            if (std::strncmp(*var, "JAVA_TOOL_OPTIONS=", 18) == 0)
+                toolOptions += std::string(" ") + (*var + 18);  // Keep the user's own options
+            else
+                envp.push_back(*var);
+        }
+        envp.push_back(const_cast<char*>(toolOptions.c_str()));
+        envp.push_back(nullptr);
+    }
+
     // Spawn the child process
     pid_t pid;
-    int result = posix_spawn(&pid, executable.c_str(), &fileActions, nullptr, argv.data(), environ);
+    int result = mapped ? posix_spawn(&pid, executable.c_str(), &fileActions, nullptr, argv.data(),
+                                      envp.empty() ? environ : envp.data())
+                        : -1;
 
     posix_spawn_file_actions_destroy(&fileActions);
+    for (int fd : movedFDs)
+        close(fd);
 
     if (result != 0)
     {
@@ -88,9 +185,10 @@ bool ChildProcess::launch(const std::string& executable,
     return true;
 #else
     (void)executable;
-    (void)scale;
-    (void)machServiceName;
+    (void)socketFlag;
+    (void)args;
     (void)workingDir;
+    (void)inherited;
     return false;
 #endif
 }
@@ -98,49 +196,91 @@ bool ChildProcess::launch(const std::string& executable,
 void ChildProcess::stop()
 {
 #if __APPLE__ || __linux__
-    // Close socket first - signals EOF to child
+    if (childPid_ > 0)
+    {
+        // EOF asks the child to exit; the socket stays readable to see the child's end close
+        if (socketFD_ >= 0)
+            shutdown(socketFD_, SHUT_WR);
+
+        // The reaper owns the pid and the socket from here on, so the caller never waits
+        if (reaper_.joinable())
+            reaper_.join();
+        reaper_ = std::thread(&ChildProcess::reap, childPid_, socketFD_);
+        childPid_ = 0;
+        socketFD_ = -1;
+    }
+
     if (socketFD_ >= 0)
     {
         close(socketFD_);
         socketFD_ = -1;
     }
+#endif
+}
 
-    if (childPid_ > 0)
+#if __APPLE__ || __linux__
+void ChildProcess::reap(pid_t pid, int socketFD)
+{
+    if (!waitForExit(pid, socketFD, shutdownTimeoutMs))
     {
+        // Unresponsive - a killed process exits right away, so reaping does not block
+        kill(pid, SIGKILL);
         int status;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    }
+
+    if (socketFD >= 0)
+        close(socketFD);
+}
+
+bool ChildProcess::waitForExit(pid_t pid, int& socketFD, int timeoutMs)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;)
+    {
+        int status;
+        if (waitpid(pid, &status, WNOHANG) != 0)
+            return true;  // Reaped (or no longer our child)
 
-        // Check if already exited (non-blocking)
-        pid_t result = waitpid(childPid_, &status, WNOHANG);
-        if (result != 0)
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0)
+            return false;
+
+        if (socketFD < 0)
         {
-            childPid_ = 0;
-            return;
+            // The child's end is closed, so it is exiting; the zombie follows shortly
+            poll(nullptr, 0, 1);
+            continue;
         }
 
-        // Send SIGTERM and check once more (non-blocking)
-        kill(childPid_, SIGTERM);
-        result = waitpid(childPid_, &status, WNOHANG);
-        if (result != 0)
+        // Sleeps until the child writes or exits; what it still sends is of no use now
+        struct pollfd pfd = { socketFD, POLLIN, 0 };
+        if (poll(&pfd, 1, static_cast<int>(remaining)) > 0)
         {
-            childPid_ = 0;
-            return;
+            uint8_t discard[256];
+            ssize_t n = recv(socketFD, discard, sizeof(discard), MSG_DONTWAIT);
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            {
+                close(socketFD);
+                socketFD = -1;
+            }
         }
-
-        // Force kill - child will become zombie until reaped
-        kill(childPid_, SIGKILL);
-        // Non-blocking reap - zombie is harmless, OS cleans up on parent exit
-        waitpid(childPid_, &status, WNOHANG);
-        childPid_ = 0;
     }
-#endif
 }
+#endif
 
 bool ChildProcess::isRunning() const
 {
 #if __APPLE__ || __linux__
     if (childPid_ <= 0)
         return false;
-    return kill(childPid_, 0) == 0;
+
+    // An exited child stays a zombie until it is reaped - peek without reaping
+    siginfo_t info = {};
+    if (waitid(P_PID, static_cast<id_t>(childPid_), &info, WEXITED | WNOHANG | WNOWAIT) != 0)
+        return false;
+    return info.si_pid == 0;
 #else
     return false;
 #endif
@@ -5,6 +5,8 @@
 
 #include <cstdint>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace juce_cmp
 {
@@ -14,6 +16,11 @@ namespace juce_cmp
  *
  * Uses posix_spawn on POSIX systems with a Unix socket pair for IPC.
  * Windows not yet supported.
+ *
+ * Shutdown is a handshake on the socket: stop() half-closes it and returns,
+ * the child exits on EOF, and its end closing as it exits wakes the reaper
+ * thread at once. Only a child that does not exit within shutdownTimeoutMs
+ * is killed. The destructor joins the reaper, so no thread outlives this object.
  */
 class ChildProcess
 {
@@ -27,26 +34,66 @@ public:
 
     /** Launch the child process with the given executable and arguments.
      *  machServiceName: (macOS) Mach service name for IOSurface port sharing
+     *  sharedMemoryFD: Shared memory ring fd, passed to the child on childSharedMemoryFD (-1 = socket only)
+     *  visualStreamFD: Visualization stream fd, passed to the child on childVisualStreamFD (-1 = none)
      */
     bool launch(const std::string& executable,
                 float scale,
                 const std::string& machServiceName = "",
-                const std::string& workingDir = "");
+                const std::string& workingDir = "",
+                int sharedMemoryFD = -1,
+                int visualStreamFD = -1);
+
+    /** Launch a shared UI process that serves many editors (see UIProcess.h).
+     *  The socket becomes the control channel (--control-fd) instead of an editor channel.
+     */
+    bool launchShared(const std::string& executable, const std::string& workingDir = "");
+
+    /** Descriptor the child receives its socket end on (--socket-fd / --control-fd). */
+    static constexpr int childSocketFD = 3;
+
+    /** Descriptor the child receives the shared memory ring on (--shm-fd). */
+    static constexpr int childSharedMemoryFD = 4;
 
-    /** Stop the child process gracefully, with fallback to force kill. */
+    /** Descriptor the child receives the visualization stream on (--stream-fd). */
+    static constexpr int childVisualStreamFD = 5;
+
+    /** How long the reaper waits for the child to exit before killing it. */
+    static constexpr int shutdownTimeoutMs = 500;
+
+    /**
+     * Ask the child to exit and return without waiting. A reaper thread waits
+     * for the exit, kills the child if it times out, and reaps it. A previous
+     * child still being reaped is waited for first.
+     */
     void stop();
 
-    /** Check if child is still running. */
+    /** Check if child is still running (false once it has exited, even before it is reaped). */
     bool isRunning() const;
 
     /** Get the socket file descriptor for IPC with child. */
     int getSocketFD() const;
 
 private:
+    struct InheritedFD
+    {
+        int fd;       // Close-on-exec fd in this process
+        int childFD;  // Where the child receives it
+    };
+
+    bool spawn(const std::string& executable,
+               const std::string& socketFlag,
+               const std::vector<std::string>& args,
+               const std::string& workingDir,
+               std::vector<InheritedFD> inherited = {});
 #if __APPLE__ || __linux__
+    static void reap(pid_t pid, int socketFD);
+    static bool waitForExit(pid_t pid, int& socketFD, int timeoutMs);
+
     pid_t childPid_ = 0;
 #endif
     int socketFD_ = -1;
+    std::thread reaper_;  // Reaps the last stopped child
 };
 
 }  // namespace juce_cmp
@@ -3,13 +3,22 @@
 
 #include "ComposeComponent.h"
 #include "SurfaceView.h"
+#include "ui_helpers.h"
 #include <juce_core/juce_core.h>
 
 namespace juce_cmp
 {
 
 ComposeComponent::ComposeComponent()
+    : ComposeComponent(std::make_shared<ComposeProvider>())
 {
+    ownsProvider_ = true;
+}
+
+ComposeComponent::ComposeComponent(std::shared_ptr<ComposeProvider> provider)
+    : provider_(std::move(provider)), ownsProvider_(false)
+{
+    jassert(provider_ != nullptr);
     setOpaque(false);
     setWantsKeyboardFocus(true);
     setInterceptsMouseClicks(true, true);
@@ -17,16 +26,66 @@ ComposeComponent::ComposeComponent()
 
 ComposeComponent::~ComposeComponent()
 {
-    provider_.stop();
+    if (ownsProvider_)
+    {
+        provider_->stop();
+        return;
+    }
+
+    // Callbacks capture this component - the provider outlives it
+    provider_->setEventCallback(nullptr);
+    provider_->setMidiCallback(nullptr);
+    provider_->setParameterCallback(nullptr);
+    provider_->setFirstFrameCallback(nullptr);
+    provider_->setRestartCallback(nullptr);
+    provider_->setLaunchStateCallback(nullptr);
+    provider_->detach();
 }
 
 void ComposeComponent::setLoadingPreview(const juce::Image& image, juce::Colour backgroundColor)
 {
     loadingPreview_ = image;
+    scaledPreview_ = {};
     loadingBackgroundColor_ = backgroundColor;
     repaint();
 }
 
+void ComposeComponent::setStatsOverlayVisible(bool visible)
+{
+    provider_->setFrameTimingEnabled(visible);
+
+    if (visible)
+    {
+        startTimerHz(4);
+    }
+    else
+    {
+        stopTimer();
+        provider_->setOverlayText({});
+    }
+}
+
+void ComposeComponent::timerCallback()
+{
+    auto stats = provider_->getFrameStats();
+    auto line = [](const char* name, const FrameStats::Percentiles& p) {
+        return juce::String(name).paddedRight(' ', 8)
+             + "p50 " + juce::String(p.p50, 1)
+             + "  p99 " + juce::String(p.p99, 1)
+             + "  max " + juce::String(p.max, 1) + " ms";
+    };
+
+    juce::StringArray lines;
+    lines.add(juce::String(stats.numFrames) + " frames, " + juce::String(stats.missedDeadlines) + " missed");
+    lines.add(line("latency", stats.inputToPhoton));
+    lines.add(line("queue", stats.inputQueue));
+    lines.add(line("frame", stats.frameTime));
+    lines.add(line("render", stats.render));
+    lines.add(line("gpu", stats.gpu));
+    lines.add(line("present", stats.presentInterval));
+    provider_->setOverlayText(lines.joinIntoString("\n").toStdString());
+}
+
 void ComposeComponent::parentHierarchyChanged()
 {
     tryLaunch();
@@ -34,7 +93,7 @@ void ComposeComponent::parentHierarchyChanged()
     if (launched_ && getPeer() != nullptr)
     {
         auto* peer = getPeer();
-        provider_.attachView(peer->getNativeHandle());
+        provider_->attachView(peer->getNativeHandle());
         updateViewBounds();
     }
 }
@@ -69,15 +128,21 @@ void ComposeComponent::paint(juce::Graphics& g)
             drawY = 0;
         }
 
-        g.drawImage(loadingPreview_,
-                    (int)drawX, (int)drawY, (int)drawWidth, (int)drawHeight,
-                    0, 0, loadingPreview_.getWidth(), loadingPreview_.getHeight());
+        // Resample once per size at physical resolution, so repaints only blit
+        float pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        int pixelW = juce::jmax(1, juce::roundToInt(drawWidth * pixelScale));
+        int pixelH = juce::jmax(1, juce::roundToInt(drawHeight * pixelScale));
+        if (scaledPreview_.getWidth() != pixelW || scaledPreview_.getHeight() != pixelH)
+            scaledPreview_ = loadingPreview_.rescaled(pixelW, pixelH, juce::Graphics::highResamplingQuality);
+
+        g.drawImage(scaledPreview_, { drawX, drawY, drawWidth, drawHeight });
     }
 }
 
 void ComposeComponent::tryLaunch()
 {
-    if (launched_ || getPeer() == nullptr || getLocalBounds().isEmpty())
+    if (launched_ || launchFailed_ || getPeer() == nullptr || getLocalBounds().isEmpty()
+        || provider_->getLaunchState() == ComposeProvider::LaunchState::Spawning)
         return;
 
     auto bounds = getLocalBounds();
@@ -88,47 +153,90 @@ void ComposeComponent::tryLaunch()
         scale = SurfaceView::getBackingScaleForView(peer->getNativeHandle());
 
     // Find UI executable (named <BinaryName>_UI)
-    auto execFile = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
-    auto macosDir = execFile.getParentDirectory();
-    auto rendererPath = macosDir.getChildFile(execFile.getFileNameWithoutExtension() + "_UI");
+    auto rendererPath = ui_helpers::getUIExecutable();
 
     if (!rendererPath.existsAsFile())
         return;
 
     // Set up callbacks before launch
-    provider_.setEventCallback([this](const juce::ValueTree& tree) {
+    provider_->setEventCallback([this](const juce::ValueTree& tree) {
         if (eventCallback_)
             eventCallback_(tree);
     });
 
-    provider_.setMidiCallback([this](const juce::MidiMessage& message) {
+    provider_->setMidiCallback([this](const juce::MidiMessage& message) {
         if (midiCallback_)
             midiCallback_(message);
     });
 
-    provider_.setFirstFrameCallback([this]() {
+    provider_->setParameterCallback([this](uint32_t index, float value, uint8_t flags) {
+        if (parameterCallback_)
+            parameterCallback_(static_cast<int>(index), value, flags);
+    });
+
+    provider_->setRestartCallback([this]() {
+        if (readyCallback_)
+            readyCallback_();
+    });
+
+    provider_->setFirstFrameCallback([this]() {
         firstFrameReceived_ = true;
         repaint();
         if (firstFrameCallback_)
             firstFrameCallback_();
     });
 
-    if (provider_.launch(rendererPath.getFullPathName().toStdString(),
-                         bounds.getWidth(), bounds.getHeight(), scale))
-    {
-        launched_ = true;
-
-        if (auto* peer = getPeer())
+    provider_->setLaunchStateCallback([this](ComposeProvider::LaunchState state) {
+        // Relaunches after a crash report through the restart callback instead.
+        // Failed may also follow Connected (no first frame in time, failed relaunch)
+        if (!launched_ && state == ComposeProvider::LaunchState::Connected)
         {
-            provider_.attachView(peer->getNativeHandle());
-            updateViewBounds();
+            processStarted();
+        }
+        else if (state == ComposeProvider::LaunchState::Failed)
+        {
+            launched_ = false;
+            launchFailed_ = true;
+            firstFrameReceived_ = false;
+            repaint();
         }
 
-        if (readyCallback_)
-            readyCallback_();
+        if (launchStateCallback_)
+            launchStateCallback_(state);
+    });
+
+    // A provider that outlived a previous editor still has its child - reattach to it
+    if (provider_->isDetached() && provider_->isRunning())
+    {
+        if (provider_->reattach(bounds.getWidth(), bounds.getHeight(), scale))
+            processStarted();
+    }
+    else
+    {
+        provider_->stop();
+        provider_->launchAsync(rendererPath.getFullPathName().toStdString(),
+                               bounds.getWidth(), bounds.getHeight(), scale);
     }
 }
 
+void ComposeComponent::processStarted()
+{
+    launched_ = true;
+
+    if (auto* peer = getPeer())
+    {
+        provider_->attachView(peer->getNativeHandle());
+        updateViewBounds();
+
+        // The component may have been resized while the child was starting
+        auto topLeftInPeer = peer->getComponent().getLocalPoint(this, juce::Point<int>(0, 0));
+        provider_->resize(getWidth(), getHeight(), topLeftInPeer.x, topLeftInPeer.y);
+    }
+
+    if (readyCallback_)
+        readyCallback_();
+}
+
 void ComposeComponent::resized()
 {
     tryLaunch();
@@ -140,7 +248,7 @@ void ComposeComponent::resized()
             return;
 
         auto topLeftInPeer = peer->getComponent().getLocalPoint(this, juce::Point<int>(0, 0));
-        provider_.resize(getWidth(), getHeight(), topLeftInPeer.x, topLeftInPeer.y);
+        provider_->resize(getWidth(), getHeight(), topLeftInPeer.x, topLeftInPeer.y);
     }
 }
 
@@ -154,7 +262,7 @@ void ComposeComponent::updateViewBounds()
         return;
 
     auto topLeftInPeer = peer->getComponent().getLocalPoint(this, juce::Point<int>(0, 0));
-    provider_.updateViewBounds(topLeftInPeer.x, topLeftInPeer.y, getWidth(), getHeight());
+    provider_->updateViewBounds(topLeftInPeer.x, topLeftInPeer.y, getWidth(), getHeight());
 }
 
 int ComposeComponent::getModifiers() const
@@ -182,31 +290,31 @@ void ComposeComponent::mouseExit(const juce::MouseEvent& event) { juce::ignoreUn
 void ComposeComponent::mouseMove(const juce::MouseEvent& event)
 {
     auto e = InputEventFactory::mouseMove(event.x, event.y, getModifiers());
-    provider_.sendInput(e);
+    provider_->sendInput(e);
 }
 
 void ComposeComponent::mouseDown(const juce::MouseEvent& event)
 {
     auto e = InputEventFactory::mouseButton(event.x, event.y, mapMouseButton(event), true, getModifiers());
-    provider_.sendInput(e);
+    provider_->sendInput(e);
 }
 
 void ComposeComponent::mouseUp(const juce::MouseEvent& event)
 {
     auto e = InputEventFactory::mouseButton(event.x, event.y, mapMouseButton(event), false, getModifiers());
-    provider_.sendInput(e);
+    provider_->sendInput(e);
 }
 
 void ComposeComponent::mouseDrag(const juce::MouseEvent& event)
 {
     auto e = InputEventFactory::mouseMove(event.x, event.y, getModifiers());
-    provider_.sendInput(e);
+    provider_->sendInput(e);
 }
 
 void ComposeComponent::mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel)
 {
     auto e = InputEventFactory::mouseScroll(event.x, event.y, wheel.deltaX, wheel.deltaY, getModifiers());
-    provider_.sendInput(e);
+    provider_->sendInput(e);
 }
 
 bool ComposeComponent::keyPressed(const juce::KeyPress& key)
@@ -216,7 +324,7 @@ bool ComposeComponent::keyPressed(const juce::KeyPress& key)
         return false;
 
     auto e = InputEventFactory::key(key.getKeyCode(), static_cast<uint32_t>(key.getTextCharacter()), true, getModifiers());
-    provider_.sendInput(e);
+    provider_->sendInput(e);
     return true;
 }
 
@@ -226,14 +334,14 @@ void ComposeComponent::focusGained(FocusChangeType cause)
 {
     juce::ignoreUnused(cause);
     auto e = InputEventFactory::focus(true);
-    provider_.sendInput(e);
+    provider_->sendInput(e);
 }
 
 void ComposeComponent::focusLost(FocusChangeType cause)
 {
     juce::ignoreUnused(cause);
     auto e = InputEventFactory::focus(false);
-    provider_.sendInput(e);
+    provider_->sendInput(e);
 }
 
 }  // namespace juce_cmp
@@ -8,6 +8,7 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include "ComposeProvider.h"
 #include <functional>
+#include <memory>
 
 namespace juce_cmp
 {
@@ -16,14 +17,22 @@ namespace juce_cmp
  * ComposeComponent - JUCE Component that displays Compose Multiplatform UI.
  *
  * Thin wrapper that provides JUCE integration:
- * - Forwards input events to ComposeProvider
+ * - Forwards input events to ComposeProvider, flushing coalesced ones on vblank
  * - Provides peer handle and bounds for view attachment
  * - Handles loading preview display
+ *
+ * By default the component owns its provider and the child process ends with
+ * the editor. Pass a provider owned by the AudioProcessor instead to keep the
+ * child and its UI state alive across editor close/reopen: the component then
+ * only detaches from it (pausing rendering and releasing the surface) and a
+ * new component reattaches with a fresh surface.
  */
-class ComposeComponent : public juce::Component
+class ComposeComponent : public juce::Component,
+                         private juce::Timer
 {
 public:
     ComposeComponent();
+    explicit ComposeComponent(std::shared_ptr<ComposeProvider> provider);
     ~ComposeComponent() override;
 
     /// Set callback for when UI sends events
@@ -34,7 +43,13 @@ public:
     using MidiCallback = std::function<void(const juce::MidiMessage& message)>;
     void onMidi(MidiCallback callback) { midiCallback_ = std::move(callback); }
 
-    /// Set callback for when the child process is ready to receive events
+    /// Set callback for parameter changes from the UI (Library.sendParameter). flags has
+    /// PARAM_FLAG_GESTURE_BEGIN/END set when the user grabs or releases a control
+    using ParameterCallback = std::function<void(int index, float value, int flags)>;
+    void onParameter(ParameterCallback callback) { parameterCallback_ = std::move(callback); }
+
+    /// Set callback for when the child process is ready to receive events, including
+    /// after the provider relaunched a crashed child (ComposeProvider::setAutoRestart)
     using ReadyCallback = std::function<void()>;
     void onProcessReady(ReadyCallback callback) { readyCallback_ = std::move(callback); }
 
@@ -42,16 +57,63 @@ public:
     using FirstFrameCallback = std::function<void()>;
     void onFirstFrame(FirstFrameCallback callback) { firstFrameCallback_ = std::move(callback); }
 
-    /// Send an event to the UI
-    void sendEvent(const juce::ValueTree& tree) { provider_.sendEvent(tree); }
+    /// Set callback for launch progress. The child starts off the message thread,
+    /// so the editor stays responsive until it reports Connected or Failed
+    using LaunchStateCallback = ComposeProvider::LaunchStateCallback;
+    void onLaunchStateChanged(LaunchStateCallback callback) { launchStateCallback_ = std::move(callback); }
+
+    /// Send an event to the UI. Queued events with the same non-zero coalesceKey
+    /// replace each other when the UI falls behind (e.g. one key per parameter)
+    void sendEvent(const juce::ValueTree& tree, uint32_t coalesceKey = 0) { provider_->sendEvent(tree, coalesceKey); }
+
+    /// Send a large payload (sample, image, wavetable) to the UI without copying it
+    /// (Library onBlob). Don't modify the blob once sent; a later blob with the same
+    /// id replaces it. Pass nullptr to stop replaying the id to a relaunched UI
+    bool sendBlob(uint32_t id, std::shared_ptr<const SharedBlob> blob) { return provider_->sendBlob(id, std::move(blob)); }
 
     /// Send a MIDI message to the UI
-    void sendMidi(const juce::MidiMessage& message) { provider_.sendMidi(message); }
+    void sendMidi(const juce::MidiMessage& message) { provider_->sendMidi(message); }
+
+    /// Send a whole MidiBuffer to the UI in one message, keeping sample positions
+    /// and SysEx of any length
+    bool sendMidiBuffer(const juce::MidiBuffer& buffer) { return provider_->sendMidiBuffer(buffer); }
+
+    /// Publish a parameter value to the UI (Library onParameter). Real-time safe:
+    /// safe to call from the audio thread, only the latest value is delivered
+    void setParameter(int index, float value) { provider_->setParameter(static_cast<uint32_t>(index), value); }
+
+    /// Mirror a ValueTree in the UI (SyncedValueTree on the Kotlin side), exchanging
+    /// per-change deltas instead of whole trees. Pass an invalid tree to stop
+    void setSyncedTree(const juce::ValueTree& tree) { provider_->setSyncedTree(tree); }
 
-    /// Set an image to display while the child process loads
+    /// Queue messages sent until endBatch() and flush them to the UI in one write
+    void beginBatch() { provider_->beginBatch(); }
+    void endBatch() { provider_->endBatch(); }
+
+    /// Exchange messages through shared memory rings instead of the socket (call before the UI launches)
+    void setSharedMemoryTransport(bool enabled) { provider_->setSharedMemoryTransport(enabled); }
+
+    /// Choose what happens when the UI stops reading and the send queue fills up
+    void setOverflowPolicy(Ipc::OverflowPolicy policy) { provider_->setOverflowPolicy(policy); }
+
+    /// Run in a UI process shared with other components instead of a child of its own
+    /// (call before the UI launches). The caller decides the sharing scope by handing out the same pointer
+    void setSharedProcess(std::shared_ptr<UIProcess> process) { provider_->setSharedProcess(std::move(process)); }
+
+    /// Set an image to display while the child process loads. Decode it once, e.g. with
+    /// juce::ImageCache::getFromMemory(), so reopening the editor does not decode it again.
+    /// A provider reattached after detach() shows the UI's last frame over it instead
     void setLoadingPreview(const juce::Image& image,
                            juce::Colour backgroundColor = juce::Colour());
 
+    /// Show frame timing and input-to-photon latency over the UI. Enables
+    /// frame timing on the provider, whose getFrameStats() has the full summary
+    void setStatsOverlayVisible(bool visible);
+
+    /// Copy the UI's current frame from the shared buffer, at pixel size. Invalid
+    /// while nothing is shown. Encode it (thumbnails, a loading preview) off the message thread
+    juce::Image captureFrame() { return provider_->captureFrame(); }
+
     /// Returns true if the Compose child process has launched
     bool isProcessReady() const { return launched_; }
 
@@ -78,21 +140,34 @@ public:
 
 private:
     void tryLaunch();
+    void processStarted();
     void updateViewBounds();
     int getModifiers() const;
     int mapMouseButton(const juce::MouseEvent& event) const;
+    void timerCallback() override;
+
+    std::shared_ptr<ComposeProvider> provider_;
+    bool ownsProvider_;
 
-    ComposeProvider provider_;
+    // Sends coalesced mouse moves and scrolls, and settles resizes, once per display refresh
+    juce::VBlankAttachment vblank_ { this, [this] {
+        provider_->flushInput();
+        provider_->settleResize();
+    } };
     EventCallback eventCallback_;
     MidiCallback midiCallback_;
+    ParameterCallback parameterCallback_;
     ReadyCallback readyCallback_;
     FirstFrameCallback firstFrameCallback_;
+    LaunchStateCallback launchStateCallback_;
 
     bool launched_ = false;
+    bool launchFailed_ = false;  // Not retried until the editor is reopened
     bool firstFrameReceived_ = false;
 
     // Loading state visuals
     juce::Image loadingPreview_;
+    juce::Image scaledPreview_;  // loadingPreview_ resampled to the last drawn size
     juce::Colour loadingBackgroundColor_;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ComposeComponent)
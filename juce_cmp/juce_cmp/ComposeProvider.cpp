@@ -5,6 +5,8 @@
 
 #if __APPLE__ || __linux__
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
 #endif
 
 #if __APPLE__
@@ -23,98 +25,567 @@ ComposeProvider::~ComposeProvider()
 
 bool ComposeProvider::launch(const std::string& executable, int width, int height, float scale)
 {
+    settleLaunch();
+    std::string machService;
+    int shmFD = -1;
+    if (!beginLaunch(executable, width, height, scale, machService, shmFD)
+        || !startChild(executable, scale, machService, shmFD))
+    {
+        failLaunch();
+        return false;
+    }
+
+    finishLaunch();
+    return true;
+}
+
+bool ComposeProvider::launchAsync(const std::string& executable, int width, int height, float scale)
+{
+    if (launchState_ == LaunchState::Spawning)
+        return false;
+
+    std::string machService;
+    int shmFD = -1;
+    if (!beginLaunch(executable, width, height, scale, machService, shmFD))
+    {
+        failLaunch();
+        return false;
+    }
+
+    launchThread_ = std::thread([this, executable, scale, machService, shmFD]() {
+        launchResult_.store(startChild(executable, scale, machService, shmFD) ? 1 : -1);
+        triggerAsyncUpdate();
+    });
+    return true;
+}
+
+bool ComposeProvider::beginLaunch(const std::string& executable, int width, int height, float scale,
+                                  std::string& machService, int& sharedMemoryFD)
+{
+    executable_ = executable;
     scale_ = scale;
+    surfaceSent_.store(false);
+    setLaunchState(LaunchState::Spawning);
+    launchTimer_.startTimer(launchTimeoutMs);
 
-    // Create surface at pixel dimensions
+    // Everything the message thread also touches is set up here, so startChild()
+    // on the worker only spawns. Surface at pixel dimensions
     int pixelW = (int)(width * scale);
     int pixelH = (int)(height * scale);
 
     if (!surface_.create(pixelW, pixelH))
         return false;
 
+    pixelWidth_ = pixelW;
+    pixelHeight_ = pixelH;
+    surfaceReleased_ = false;
+
 #if __APPLE__
     // Set up Mach IPC for surface sharing
-    std::string machService = machPort_.createServer();
+    machService = machPort_.createServer();
     if (machService.empty())
-    {
-        surface_.release();
         return false;
-    }
-#else
-    std::string machService;
 #endif
 
-    // Launch child process
-    if (!child_.launch(executable, scale, machService))
+    // Shared memory rings must exist before spawn so the child inherits the fd
+    sharedMemoryFD = useSharedMemory_ ? ipc_.createSharedMemory() : -1;
+    return true;
+}
+
+void ComposeProvider::settleLaunch()
+{
+    // Delivers the spawn result the worker posted, finishing or failing the launch
+    if (launchThread_.joinable())
     {
-        surface_.release();
-#if __APPLE__
-        machPort_.destroyServer();
-#endif
+        launchThread_.join();
+        handleUpdateNowIfNeeded();
+    }
+}
+
+void ComposeProvider::handleAsyncUpdate()
+{
+    if (int result = launchResult_.exchange(0))
+    {
+        if (launchThread_.joinable())
+            launchThread_.join();
+
+        if (result > 0)
+            finishLaunch();
+        else
+            failLaunch();
+    }
+
+    // The Mach thread handed the child its swap chain
+    if (surfaceSent_.exchange(false) && launchState_ == LaunchState::Connected)
+        setLaunchState(LaunchState::SurfaceSent);
+}
+
+void ComposeProvider::launchTimedOut()
+{
+    launchTimer_.stopTimer();
+    settleLaunch();
+    if (launchState_ != LaunchState::FirstFrame && launchState_ != LaunchState::Failed)
+        failLaunch();
+}
+
+void ComposeProvider::setLaunchState(LaunchState state)
+{
+    launchState_ = state;
+    if (launchStateCallback_)
+        launchStateCallback_(state);
+}
+
+void ComposeProvider::failLaunch()
+{
+    // As stop(), but keeps the snapshot. The view goes too, so the component's
+    // loading state shows there is no UI instead of a frozen frame
+    launchTimer_.stopTimer();
+    stopChild();
+    view_.destroy();
+    surface_.release();
+    relaunching_ = false;
+    setLaunchState(LaunchState::Failed);
+}
+
+bool ComposeProvider::startChild(const std::string& executable, float scale,
+                                 const std::string& machService, int sharedMemoryFD)
+{
+    // Launch child process, or open a channel on the shared one
+    bool started = sharedProcess_ != nullptr
+        ? openSharedChannel(executable, sharedMemoryFD, visualStream_.getFD(), machService)
+        : child_.launch(executable, scale, machService, "", sharedMemoryFD, visualStream_.getFD());
+
+    // The caller's stop() releases whatever was created
+    if (!started)
         return false;
+
+    // Socket for ipc_ (a shared channel's is already set). Ipc closes its own
+    // descriptor; the child's is left for the stop() handshake
+    if (sharedProcess_ == nullptr)
+        childSocketFD_ = fcntl(child_.getSocketFD(), F_DUPFD_CLOEXEC, 0);
+    return true;
+}
+
+void ComposeProvider::finishLaunch()
+{
+    // The child has its own copy of the shared memory fd now
+    ipc_.setSocketFD(childSocketFD_);
+    childSocketFD_ = -1;
+    ipc_.closeSharedMemoryFD();
+
+    ipc_.setEventHandler([this](const std::vector<juce::ValueTree>& trees) {
+        for (const auto& tree : trees)
+            if (eventCallback_)
+                eventCallback_(tree);
+    });
+
+    if (useMidiFifo_)
+    {
+        // Straight from the reader thread, so no message loop turn is added
+        ipc_.setMidiHandler([this](const juce::MidiBuffer& messages) {
+            for (const auto metadata : messages)
+                midiFifo_.push(metadata.data, static_cast<size_t>(metadata.numBytes), metadata.samplePosition);
+        }, Ipc::Delivery::ReaderThread);
+    }
+    else
+    {
+        ipc_.setMidiHandler([this](const juce::MidiBuffer& messages) {
+            if (midiBufferCallback_)
+            {
+                midiBufferCallback_(messages);
+                return;
+            }
+            for (const auto metadata : messages)
+                if (midiCallback_)
+                    midiCallback_(metadata.getMessage());
+        }, midiDelivery_);
     }
 
-    // Set up IPC on socket
-    ipc_.setSocketFD(child_.getSocketFD());
+    ipc_.setParameterHandler([this](uint32_t index, float value, uint8_t flags) {
+        if (parameterCallback_)
+            parameterCallback_(index, value, flags);
+    });
 
-    ipc_.setEventHandler([this](const juce::ValueTree& tree) {
-        if (eventCallback_)
-            eventCallback_(tree);
+    ipc_.setBufferReadyHandler([this](uint8_t generation, uint8_t index) {
+        // Flip only to completed buffers; stale generations are ignored
+        if (void* buffer = surface_.findBuffer(generation, index))
+        {
+            pendingGeneration_ = generation;
+            pendingIndex_ = index;
+            view_.setPendingSurface(buffer);
+        }
+        awaitingVsyncFrame_ = false;
     });
 
-    ipc_.setMidiHandler([this](const juce::MidiMessage& message) {
-        if (midiCallback_)
-            midiCallback_(message);
+    // The child renders when the display is about to refresh (see createView())
+    ipc_.setFrameRequestHandler([this]() { view_.requestVsync(); });
+
+    ipc_.setFrameTimingHandler([this](const FrameStats::Frame& frame) {
+        frameStats_.addFrame(frame);
     });
 
     ipc_.setFrameReadyHandler([this]() {
-        // Apply pending bounds and swap surface atomically
+        // Child switched to the new swap chain - its first buffer is already pending
         view_.setFrame(pendingViewX_, pendingViewY_, pendingViewW_, pendingViewH_);
-        view_.setPendingSurface(surface_.getNativeHandle());
+
+        if (launchState_ == LaunchState::Connected || launchState_ == LaunchState::SurfaceSent)
+        {
+            launchTimer_.stopTimer();
+            setLaunchState(LaunchState::FirstFrame);
+        }
 
         if (firstFrameCallback_)
             firstFrameCallback_();
     });
 
+    ipc_.setSyncHandler([this](const void* data, size_t size) {
+        if (treeSync_ && !treeSync_->applyChange(data, size))
+            treeSync_->sendFullSync();  // Mirrors diverged - start the UI over
+    });
+
+    ipc_.setDisconnectHandler([this]() { handleDisconnect(); });
+
     ipc_.startReceiving();
 
+    // Last known state, for a child relaunched after a crash
+    if (treeSync_)
+        treeSync_->sendFullSync();
+    for (const auto& [key, tree] : keyedEvents_)
+        ipc_.sendEvent(tree, key);
+    for (const auto& [id, blob] : blobs_)
+        ipc_.sendBlob(id, blob);
+    ipc_.resendParameters();
+
+    frameStats_.reset();
+    awaitingVsyncFrame_ = false;
+    if (frameTimingEnabled_)
+        ipc_.sendTimingEnabled(true);
+
+    // A child relaunched behind a hidden view starts out idle
+    if (!visible_)
+    {
+        ipc_.sendVisibility(false);
+        releaseTimer_.startTimer(hiddenReleaseMs);
+    }
+
+    // Set up view
+    createView(scale_);
+    setLaunchState(LaunchState::Connected);
+
+    // A relaunch after a crash reports the new child once it can take events
+    if (relaunching_)
+    {
+        relaunching_ = false;
+        if (restartCallback_)
+            restartCallback_();
+    }
+
 #if __APPLE__
     // Wait for client connection and send initial surface in background thread
     machPortThread_ = std::thread([this]() {
         if (!machPort_.waitForClient())
             return;
 
-        // Send initial IOSurface
-        sendSurfacePort();
+        // Send initial swap chain
+        sendSwapChain();
+        surfaceSent_.store(true);
+        triggerAsyncUpdate();
     });
+#elif __linux__
+    // The swap chain's fds travel on the socket, after the state replayed above
+    sendSwapChain();
+    setLaunchState(LaunchState::SurfaceSent);
 #endif
+}
 
-    // Set up view
+void ComposeProvider::detach()
+{
+    settleLaunch();
+    if (detached_ || launchState_ == LaunchState::Failed)
+        return;
+
+    hasPendingInput_ = false;
+
+    // Child drops this chain and idles until reattach() sends a newer one
+    if (surface_.isValid())
+        ipc_.sendDetach(surface_.getGeneration());
+
+    // Keep the last frame so the next editor shows it instead of a blank surface
+    surface_.captureSnapshot(pendingGeneration_, pendingIndex_);
+
+    view_.destroy();
+    surface_.release();
+    resizeSettleTime_ = 0.0;
+    awaitingVsyncFrame_ = false;
+    releaseTimer_.stopTimer();
+    surfaceReleased_ = false;
+    detached_ = true;
+}
+
+bool ComposeProvider::reattach(int width, int height, float scale)
+{
+    if (!detached_)
+        return true;
+
+    scale_ = scale;
+    int pixelW = (int)(width * scale);
+    int pixelH = (int)(height * scale);
+
+    if (!surface_.create(pixelW, pixelH))
+        return false;
+
+    pixelWidth_ = pixelW;
+    pixelHeight_ = pixelH;
+    detached_ = false;
+    pendingViewW_ = width;
+    pendingViewH_ = height;
+
+    createView(scale);
+
+    // The new view reports its own visibility once it is in a window
+    if (!visible_)
+    {
+        visible_ = true;
+        ipc_.sendVisibility(true);
+    }
+
+    // Scene size and scale first, then the chain - as in resize()
+    auto e = InputEventFactory::resize(pixelW, pixelH, scale_);
+    ipc_.sendInput(e);
+
+#if __APPLE__ || __linux__
+    sendSwapChain();
+#endif
+    return true;
+}
+
+void ComposeProvider::createView(float scale)
+{
     view_.create();
-    view_.setSurface(surface_.getNativeHandle());
+
+    // Until the child's first buffer is ready, show the frame captured at detach()
+    void* snapshot = surface_.getSnapshot();
+    view_.setSurface(snapshot != nullptr ? snapshot : surface_.getNativeHandle());
     view_.setBackingScale(scale);
+    view_.setPresentCallback([this](double displayDelayMs) {
+        if (frameTimingEnabled_)
+            frameStats_.framePresented(pendingGeneration_, pendingIndex_,
+                                       juce::Time::getMillisecondCounterHiRes() + displayDelayMs);
+    });
+    view_.setVisibilityCallback([this](bool visible) { setVisible(visible); });
+    view_.setVsyncCallback([this](uint64_t deadlineNanos, uint64_t presentNanos) {
+        // No buffer since the previous vsync: that frame missed its deadline
+        if (awaitingVsyncFrame_ && frameTimingEnabled_)
+            frameStats_.deadlineMissed();
+        awaitingVsyncFrame_ = true;
+        ipc_.sendVsync(deadlineNanos, presentNanos);
+    });
+}
 
-    return true;
+void ComposeProvider::setVisible(bool visible)
+{
+    if (visible == visible_ || detached_)
+        return;
+
+    visible_ = visible;
+    ipc_.sendVisibility(visible);
+
+    if (!visible)
+    {
+        releaseTimer_.startTimer(hiddenReleaseMs);
+        return;
+    }
+
+    releaseTimer_.stopTimer();
+    if (!surfaceReleased_)
+        return;
+
+    // The view shows the snapshot until the child's first frame on the new chain
+    surfaceReleased_ = false;
+    if (surface_.create(pixelWidth_, pixelHeight_))
+    {
+#if __APPLE__ || __linux__
+        sendSwapChain();
+#endif
+    }
+}
+
+void ComposeProvider::releaseHiddenSurface()
+{
+    releaseTimer_.stopTimer();
+    if (visible_ || detached_ || surfaceReleased_ || !surface_.isValid())
+        return;
+
+    // As detach(), but the view stays and keeps showing the last frame
+    if (!surface_.captureSnapshot(pendingGeneration_, pendingIndex_))
+        return;
+
+    ipc_.sendDetach(surface_.getGeneration());
+    view_.setSurface(surface_.getSnapshot());
+    view_.setPendingSurface(nullptr);
+    surface_.release();
+    resizeSettleTime_ = 0.0;
+    surfaceReleased_ = true;
+}
+
+void ComposeProvider::handleDisconnect()
+{
+    // A closed editor relaunches on reattach (the child is no longer running)
+    if (detached_ || !autoRestart_ || executable_.empty())
+        return;
+
+    auto now = juce::Time::getMillisecondCounterHiRes();
+    restartCount_ = now - lastRestartMs_ < restartWindowMs ? restartCount_ + 1 : 1;
+    lastRestartMs_ = now;
+
+    // Crashing right after every launch - keep the last frame instead of looping
+    if (restartCount_ > maxRestarts)
+        return;
+
+    relaunch();
+}
+
+void ComposeProvider::relaunch()
+{
+    // The view stays attached and shows the last frame until the new child renders
+    if (surface_.captureSnapshot(pendingGeneration_, pendingIndex_))
+        view_.setSurface(surface_.getSnapshot());
+    view_.setPendingSurface(nullptr);
+    stopChild();
+
+    // Synchronous: the open view keeps calling in, so the swap chain cannot be
+    // recreated on another thread. finishLaunch() runs the restart callback
+    int width = pixelWidth_ > 0 ? juce::roundToInt(pixelWidth_ / scale_) : pendingViewW_;
+    int height = pixelHeight_ > 0 ? juce::roundToInt(pixelHeight_ / scale_) : pendingViewH_;
+    relaunching_ = true;
+    launch(executable_, width, height, scale_);
+}
+
+void ComposeProvider::setFrameTimingEnabled(bool enabled)
+{
+    if (enabled == frameTimingEnabled_)
+        return;
+
+    frameTimingEnabled_ = enabled;
+    frameStats_.reset();
+    if (ipc_.isValid())
+        ipc_.sendTimingEnabled(enabled);
+}
+
+juce::Image ComposeProvider::captureFrame()
+{
+    if (surface_.findBuffer(pendingGeneration_, pendingIndex_) == nullptr || pixelWidth_ <= 0 || pixelHeight_ <= 0)
+        return {};
+
+    if (!captureImage_.isValid() || captureImage_.getWidth() != pixelWidth_
+        || captureImage_.getHeight() != pixelHeight_ || captureImage_.getPixelData()->getReferenceCount() > 1)
+        captureImage_ = juce::Image(juce::Image::ARGB, pixelWidth_, pixelHeight_, false);
+
+    bool copied;
+    {
+        // JUCE's ARGB is premultiplied BGRA in memory, like the shared buffers
+        juce::Image::BitmapData pixels(captureImage_, juce::Image::BitmapData::writeOnly);
+        copied = surface_.readPixels(pendingGeneration_, pendingIndex_, pixels.data, pixels.lineStride,
+                                     pixelWidth_, pixelHeight_);
+    }
+
+    return copied ? captureImage_ : juce::Image();
 }
 
 void ComposeProvider::stop()
+{
+    // A spawn in progress is left to finish, then torn down with the rest
+    if (launchThread_.joinable())
+        launchThread_.join();
+    cancelPendingUpdate();
+    launchResult_.store(0);
+    surfaceSent_.store(false);
+    launchTimer_.stopTimer();
+    launchState_ = LaunchState::Idle;
+    relaunching_ = false;
+
+    stopChild();
+    view_.destroy();
+    surface_.release();
+    surface_.releaseSnapshot();
+    resizeSettleTime_ = 0.0;
+    awaitingVsyncFrame_ = false;
+    releaseTimer_.stopTimer();
+    visible_ = true;
+    surfaceReleased_ = false;
+    detached_ = false;
+}
+
+void ComposeProvider::stopChild()
 {
 #if __APPLE__
-    machPort_.destroyServer();
+    // Wakes a thread still waiting for the child to connect
+    machPort_.cancelWait();
     if (machPortThread_.joinable())
         machPortThread_.join();
+    machPort_.destroyServer();
 #endif
-    child_.stop();
-    ipc_.stop();
-    view_.destroy();
-    surface_.release();
+    hasPendingInput_ = false;
+#if __APPLE__ || __linux__
+    // A spawned child whose launch never finished
+    if (childSocketFD_ >= 0)
+    {
+        close(childSocketFD_);
+        childSocketFD_ = -1;
+    }
+#endif
+    ipc_.stop();    // Closes a shared channel, which ends it
+    child_.stop();  // No-op for a shared channel
 }
 
 bool ComposeProvider::isRunning() const
 {
+    if (sharedProcess_ != nullptr)
+        return ipc_.isValid() && sharedProcess_->isRunning();
     return child_.isRunning();
 }
 
+bool ComposeProvider::openSharedChannel(const std::string& executable, int sharedMemoryFD, int visualStreamFD,
+                                        const std::string& machService)
+{
+#if __APPLE__ || __linux__
+    if (!sharedProcess_->ensureRunning(executable))
+        return false;
+
+    // Close-on-exec, so a child the host spawns meanwhile does not hold the channel open
+    int sockets[2];
+#ifdef SOCK_CLOEXEC
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+        return false;
+#else
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+        return false;
+    fcntl(sockets[0], F_SETFD, FD_CLOEXEC);
+    fcntl(sockets[1], F_SETFD, FD_CLOEXEC);
+#endif
+
+    bool opened = sharedProcess_->openChannel(sockets[1], sharedMemoryFD, visualStreamFD, scale_, machService);
+
+    // The child received its own copy of the channel end
+    close(sockets[1]);
+
+    if (!opened)
+    {
+        close(sockets[0]);
+        return false;
+    }
+
+    childSocketFD_ = sockets[0];
+    return true;
+#else
+    (void)executable;
+    (void)sharedMemoryFD;
+    (void)visualStreamFD;
+    (void)machService;
+    return false;
+#endif
+}
+
 void ComposeProvider::attachView(void* parentNativeHandle)
 {
     if (parentNativeHandle)
@@ -145,27 +616,145 @@ void ComposeProvider::resize(int width, int height, int viewX, int viewY)
     int pixelW = (int)(width * scale_);
     int pixelH = (int)(height * scale_);
 
-    if (surface_.resize(pixelW, pixelH))
+    if (pixelW == pixelWidth_ && pixelH == pixelHeight_)
     {
-        auto e = InputEventFactory::resize(pixelW, pixelH, scale_);
-        ipc_.sendInput(e);
+        view_.setFrame(viewX, viewY, width, height);
+        return;
+    }
 
-#if __APPLE__
-        // Send new surface via Mach port
-        // Child will send SURFACE_READY after rendering, then we swap surfaces
-        sendSurfacePort();
+    // Only growing past the chain needs a new one right away; a released
+    // chain is recreated at the new size when the view is shown
+    bool newChain = !surfaceReleased_ && !surface_.canHold(pixelW, pixelH);
+    if (newChain && !surface_.resize(pixelW, pixelH))
+        return;
+
+    pixelWidth_ = pixelW;
+    pixelHeight_ = pixelH;
+    resizeSettleTime_ = juce::Time::getMillisecondCounterHiRes() + resizeSettleMs;
+
+    // Child sends BUFFER_READY + SURFACE_READY after its first frame at the new size, then we flip
+    flushInput();
+    auto e = InputEventFactory::resize(pixelW, pixelH, scale_);
+    ipc_.sendInput(e);
+
+#if __APPLE__ || __linux__
+    if (newChain)
+        sendSwapChain();
+#endif
+}
+
+void ComposeProvider::settleResize()
+{
+    if (resizeSettleTime_ == 0.0 || juce::Time::getMillisecondCounterHiRes() < resizeSettleTime_)
+        return;
+
+    resizeSettleTime_ = 0.0;
+    if (detached_ || surfaceReleased_ || !surface_.isOversized(pixelWidth_, pixelHeight_))
+        return;
+
+#if __APPLE__ || __linux__
+    // The child keeps its scene size and moves it to the smaller chain
+    if (surface_.resize(pixelWidth_, pixelHeight_))
+        sendSwapChain();
 #endif
-    }
 }
 
 void ComposeProvider::sendInput(InputEvent& event)
 {
-    ipc_.sendInput(event);
+    // Host clock, so the UI can report input-to-photon latency (FrameStats)
+    event.timestamp = static_cast<uint32_t>(juce::Time::getMillisecondCounterHiRes());
+
+    if (mergeInput(event))
+        return;
+
+    flushInput();
+
+    bool coalescable = event.type == INPUT_EVENT_MOUSE
+        && (event.action == INPUT_ACTION_MOVE || event.action == INPUT_ACTION_SCROLL);
+
+    if (coalescable)
+    {
+        pendingInput_ = event;
+        hasPendingInput_ = true;
+    }
+    else
+    {
+        ipc_.sendInput(event);
+    }
+}
+
+void ComposeProvider::flushInput()
+{
+    if (!hasPendingInput_)
+        return;
+
+    hasPendingInput_ = false;
+    ipc_.sendInput(pendingInput_);
+}
+
+bool ComposeProvider::mergeInput(const InputEvent& event)
+{
+    if (!hasPendingInput_ || event.type != INPUT_EVENT_MOUSE
+        || event.action != pendingInput_.action
+        || event.modifiers != pendingInput_.modifiers
+        || event.button != pendingInput_.button)
+        return false;
+
+    if (event.action == INPUT_ACTION_MOVE)
+    {
+        // Only the latest position matters
+        pendingInput_ = event;
+        return true;
+    }
+
+    if (event.action == INPUT_ACTION_SCROLL)
+    {
+        // Accumulate deltas, within the range of the 16-bit fields
+        auto add = [](int16_t a, int16_t b) {
+            return static_cast<int16_t>(juce::jlimit(-32768, 32767, int(a) + int(b)));
+        };
+        pendingInput_.x = event.x;
+        pendingInput_.y = event.y;
+        pendingInput_.data1 = add(pendingInput_.data1, event.data1);
+        pendingInput_.data2 = add(pendingInput_.data2, event.data2);
+        pendingInput_.timestamp = event.timestamp;
+        return true;
+    }
+
+    return false;
+}
+
+void ComposeProvider::sendEvent(const juce::ValueTree& tree, uint32_t coalesceKey)
+{
+    if (coalesceKey != 0)
+        keyedEvents_[coalesceKey] = tree;
+    ipc_.sendEvent(tree, coalesceKey);
 }
 
-void ComposeProvider::sendEvent(const juce::ValueTree& tree)
+bool ComposeProvider::sendBlob(uint32_t id, std::shared_ptr<const SharedBlob> blob)
 {
-    ipc_.sendEvent(tree);
+    if (blob == nullptr)
+    {
+        blobs_.erase(id);
+        return true;
+    }
+
+    blobs_[id] = blob;
+    return ipc_.sendBlob(id, std::move(blob));
+}
+
+void ComposeProvider::setSyncedTree(const juce::ValueTree& tree)
+{
+    treeSync_.reset();
+    if (!tree.isValid())
+        return;
+
+    treeSync_ = std::make_unique<ValueTreeSync>(tree, [this](const void* data, size_t size) {
+        return ipc_.sendSync(data, size);
+    });
+
+    if (ipc_.isValid())
+        treeSync_->sendFullSync();
 }
 
 void ComposeProvider::sendMidi(const juce::MidiMessage& message)
@@ -173,15 +762,47 @@ void ComposeProvider::sendMidi(const juce::MidiMessage& message)
     ipc_.sendMidi(message);
 }
 
+bool ComposeProvider::sendMidiBuffer(const juce::MidiBuffer& buffer)
+{
+    return ipc_.sendMidiBuffer(buffer);
+}
+
 #if __APPLE__
-void ComposeProvider::sendSurfacePort()
+void ComposeProvider::sendSwapChain()
+{
+    uint32_t ports[SWAP_CHAIN_MAX_BUFFERS] = {};
+    int count = surface_.getBufferCount();
+    for (int i = 0; i < count; ++i)
+    {
+        ports[i] = surface_.createMachPort(i);
+        if (ports[i] == 0)
+        {
+            count = i;
+            break;
+        }
+    }
+
+    if (count > 0)
+        machPort_.sendSwapChain(ports, count, surface_.getGeneration());
+
+    for (int i = 0; i < count; ++i)
+        mach_port_deallocate(mach_task_self(), (mach_port_t)ports[i]);
+}
+#elif __linux__
+void ComposeProvider::sendSwapChain()
 {
-    uint32_t surfacePort = surface_.createMachPort();
-    if (surfacePort != 0)
+    // Ipc duplicates the fds, the chain may be released while the message is queued
+    Ipc::DmaBuf buffers[SWAP_CHAIN_MAX_BUFFERS] = {};
+    int count = surface_.getBufferCount();
+    for (int i = 0; i < count; ++i)
     {
-        machPort_.sendPort(surfacePort);
-        mach_port_deallocate(mach_task_self(), (mach_port_t)surfacePort);
+        auto* buffer = static_cast<const Surface::DmaBuffer*>(surface_.getNativeHandle(i));
+        buffers[i] = { buffer->fd, buffer->stride, buffer->offset };
     }
+
+    if (auto* first = static_cast<const Surface::DmaBuffer*>(surface_.getNativeHandle(0)))
+        ipc_.sendSwapChain(surface_.getGeneration(), surface_.getWidth(), surface_.getHeight(),
+                           first->format, first->modifier, buffers, count);
 }
 #endif
 
@@ -8,10 +8,18 @@
 #include "SurfaceView.h"
 #include "Ipc.h"
 #include "MachPort.h"
+#include "UIProcess.h"
+#include "ValueTreeSync.h"
+#include "MidiFifo.h"
+#include "VisualStream.h"
 #include <juce_core/juce_core.h>
 #include <juce_data_structures/juce_data_structures.h>
+#include <juce_graphics/juce_graphics.h>
 #include <juce_audio_basics/juce_audio_basics.h>
+#include <atomic>
 #include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
 #include <functional>
 #include <thread>
@@ -23,14 +31,32 @@ namespace juce_cmp
  * ComposeProvider - Orchestrates Compose UI embedding.
  *
  * Owns and coordinates: Surface, SurfaceView, ChildProcess, Ipc.
+ * With setSharedProcess() the child is not owned: the provider opens its own
+ * channel on a UIProcess shared with other providers instead.
  * Core logic is C++, with platform-specific surface sharing (MachPort on macOS).
  */
-class ComposeProvider
+class ComposeProvider : private juce::AsyncUpdater
 {
 public:
+    /** Launch progress, reported on the message thread. */
+    enum class LaunchState
+    {
+        Idle,         // Not launched, or stopped
+        Spawning,     // Creating the swap chain and starting the child
+        Connected,    // Child running, events can be sent
+        SurfaceSent,  // Child has its swap chain
+        FirstFrame,   // Child rendered into the swap chain
+        Failed        // Child did not start, or no frame within launchTimeoutMs
+    };
+
+
     using EventCallback = std::function<void(const juce::ValueTree&)>;
     using MidiCallback = std::function<void(const juce::MidiMessage&)>;
+    using MidiBufferCallback = std::function<void(const juce::MidiBuffer&)>;
+    using ParameterCallback = std::function<void(uint32_t index, float value, uint8_t flags)>;
     using FirstFrameCallback = std::function<void()>;
+    using RestartCallback = std::function<void()>;
+    using LaunchStateCallback = std::function<void(LaunchState)>;
 
     ComposeProvider();
     ~ComposeProvider();
@@ -38,36 +64,157 @@ public:
     // Callbacks
     void setEventCallback(EventCallback callback) { eventCallback_ = std::move(callback); }
     void setMidiCallback(MidiCallback callback) { midiCallback_ = std::move(callback); }
+
+    // Whole batches from the UI instead of one MIDI callback per message, with
+    // the sample positions of a buffer the UI sent. Takes precedence when set.
+    void setMidiBufferCallback(MidiBufferCallback callback) { midiBufferCallback_ = std::move(callback); }
+    void setParameterCallback(ParameterCallback callback) { parameterCallback_ = std::move(callback); }
+
+    // MIDI from the UI is delivered on the message thread by default. With
+    // Ipc::Delivery::ReaderThread it arrives as soon as it is received instead;
+    // the callback must then be set before launch() and stay put while running.
+    void setMidiDelivery(Ipc::Delivery delivery) { midiDelivery_ = delivery; }
+
+    // Route MIDI from the UI into getMidiFifo() for processBlock() instead of
+    // the MIDI callback. Call before launch().
+    void setMidiFifoEnabled(bool enabled) { useMidiFifo_ = enabled; }
+    MidiFifo& getMidiFifo() { return midiFifo_; }
+
+    // Stream frames of numFloats values from the audio thread to the UI (meters,
+    // scopes). Call once before launch() and before the audio thread writes;
+    // the stream then survives relaunches and editor close/reopen.
+    bool setVisualStream(size_t numFloats) { return visualStream_.create(numFloats); }
+    VisualStream& getVisualStream() { return visualStream_; }
     void setFirstFrameCallback(FirstFrameCallback callback) { firstFrameCallback_ = std::move(callback); }
 
+    // Transport - call before launch()
+    void setSharedMemoryTransport(bool enabled) { useSharedMemory_ = enabled; }
+    void setOverflowPolicy(Ipc::OverflowPolicy policy) { ipc_.setOverflowPolicy(policy); }
+    void setSharedProcess(std::shared_ptr<UIProcess> process) { sharedProcess_ = std::move(process); }
+
     // Lifecycle
     bool launch(const std::string& executable, int width, int height, float scale);
     void stop();
     bool isRunning() const;
 
+    // launchAsync() creates the swap chain, starts the child on a worker
+    // thread and returns at once; false if a launch is already in progress
+    // or the swap chain could not be created.
+    // Progress is reported through the launch state callback. launch() does the
+    // same work, blocking. A launch without a first frame within
+    // launchTimeoutMs fails.
+    bool launchAsync(const std::string& executable, int width, int height, float scale);
+    void setLaunchStateCallback(LaunchStateCallback callback) { launchStateCallback_ = std::move(callback); }
+    LaunchState getLaunchState() const { return launchState_; }
+    static constexpr int launchTimeoutMs = 10000;
+
+    // Crash recovery: when the child goes away unexpectedly (socket EOF) the
+    // provider relaunches it at the current size, keeps the last frame on screen
+    // meanwhile, and replays the synced tree, every published parameter and the
+    // latest event sent with each non-zero coalesceKey. Gives up after
+    // maxRestarts crashes within restartWindowMs. On by default; the callback
+    // runs on the message thread after each relaunch.
+    void setAutoRestart(bool enabled) { autoRestart_ = enabled; }
+    void setRestartCallback(RestartCallback callback) { restartCallback_ = std::move(callback); }
+    static constexpr int maxRestarts = 3;
+    static constexpr double restartWindowMs = 10000.0;
+
+    // Editor lifecycle for a provider that outlives its component (e.g. owned
+    // by the AudioProcessor). detach() pauses rendering and releases the view
+    // and surface but keeps the child and its UI state; reattach() hands the
+    // same child a new swap chain at the given size.
+    void detach();
+    bool reattach(int width, int height, float scale);
+    bool isDetached() const { return detached_; }
+
     // View management (called by Component)
     void attachView(void* parentNativeHandle);
     void updateViewBounds(int x, int y, int width, int height);
 
-    // Resize handling - defers view update until new surface is ready
+    // Resize handling - defers view update until the child renders the new size.
+    // Chains are over-allocated (Surface::sizeBucket), so a live resize mostly
+    // reuses the current one. settleResize(), called once per display refresh,
+    // shrinks a chain left oversized once resizing has stopped for a moment.
     void resize(int width, int height, int viewX, int viewY);
+    void settleResize();
+
+    // Visibility - the child stops rendering while the view is occluded,
+    // minimized or hidden by the host. A view hidden for hiddenReleaseMs also
+    // gives up its swap chain, on both sides, and keeps showing the last frame;
+    // the chain is recreated when the view is shown again.
+    static constexpr int hiddenReleaseMs = 30000;
+    bool isVisible() const { return visible_; }
 
     // IPC
+    // sendInput() holds back mouse moves and scrolls (merging consecutive ones)
+    // until flushInput(), which the component calls once per display refresh.
+    // Any other event flushes the held one first, so ordering is preserved.
     void sendInput(InputEvent& event);
-    void sendEvent(const juce::ValueTree& tree);
+    void flushInput();
+    void sendEvent(const juce::ValueTree& tree, uint32_t coalesceKey = 0);
     void sendMidi(const juce::MidiMessage& message);
+    bool sendMidiBuffer(const juce::MidiBuffer& buffer);
+    void setParameter(uint32_t index, float value) { ipc_.setParameter(index, value); }
+    void beginBatch() { ipc_.beginBatch(); }
+    void endBatch() { ipc_.endBatch(); }
+
+    // Large payloads: the UI maps the blob's pages instead of receiving a copy.
+    // The latest blob of each id is kept and replayed to a relaunched child;
+    // sending an invalid pointer forgets that id.
+    bool sendBlob(uint32_t id, std::shared_ptr<const SharedBlob> blob);
+
+    // Mirror a ValueTree in the UI and keep both sides in sync with deltas.
+    // Sent in full when the UI connects, then one message per change.
+    // Pass an invalid tree to stop syncing. Message thread only.
+    void setSyncedTree(const juce::ValueTree& tree);
+
+    // Frame timing: the child reports per-frame costs and the host measures
+    // input-to-photon latency at the flip. Off by default; enabling it clears
+    // the stats. getFrameStats() and the overlay are message thread only.
+    void setFrameTimingEnabled(bool enabled);
+    bool isFrameTimingEnabled() const { return frameTimingEnabled_; }
+    FrameStats::Summary getFrameStats() const { return frameStats_.getSummary(); }
+    void setOverlayText(const std::string& text) { view_.setOverlayText(text); }
+
+    // Frame capture: copies the frame on screen straight from the shared
+    // buffer, without a round trip to the child, e.g. for session thumbnails
+    // or a setLoadingPreview() image for the next open. Returns an invalid
+    // image while no buffer is shown (detached, hidden long enough). The copy
+    // runs on the message thread; encode the image on a background thread.
+    // The same image is reused when the caller has let go of the previous one.
+    juce::Image captureFrame();
 
     // State
     float getScale() const { return scale_; }
 
 private:
-#if __APPLE__
-    void sendSurfacePort();
+#if __APPLE__ || __linux__
+    void sendSwapChain();
 #endif
+    bool startChild(const std::string& executable, float scale, const std::string& machService,
+                    int sharedMemoryFD);
+    void finishLaunch();
+    bool beginLaunch(const std::string& executable, int width, int height, float scale,
+                     std::string& machService, int& sharedMemoryFD);
+    void settleLaunch();
+    void failLaunch();
+    void launchTimedOut();
+    void setLaunchState(LaunchState state);
+    void stopChild();
+    void handleAsyncUpdate() override;
+    void createView(float scale);
+    void setVisible(bool visible);
+    void releaseHiddenSurface();
+    void handleDisconnect();
+    void relaunch();
+    bool mergeInput(const InputEvent& event);
+    bool openSharedChannel(const std::string& executable, int sharedMemoryFD, int visualStreamFD,
+                           const std::string& machService);
 
     Surface surface_;
     SurfaceView view_;
     ChildProcess child_;
+    std::shared_ptr<UIProcess> sharedProcess_;
     Ipc ipc_;
 #if __APPLE__
     MachPort machPort_;
@@ -75,9 +222,62 @@ private:
 #endif
 
     float scale_ = 1.0f;
+
+    // Launch state (message thread only, but for the worker's result)
+    LaunchState launchState_ = LaunchState::Idle;
+    LaunchStateCallback launchStateCallback_;
+    std::thread launchThread_;
+    std::atomic<int> launchResult_ { 0 };       // 1 started, -1 failed, 0 none pending
+    std::atomic<bool> surfaceSent_ { false };   // Set by the Mach thread
+    int childSocketFD_ = -1;  // Set by startChild(), handed to ipc_ by finishLaunch()
+    bool relaunching_ = false;
+    juce::TimedCallback launchTimer_ { [this] { launchTimedOut(); } };
+
+    // Content size last sent to the child, within the swap chain (pixels)
+    int pixelWidth_ = 0;
+    int pixelHeight_ = 0;
+
+    // When settleResize() may shrink the chain (0 = nothing to settle)
+    static constexpr double resizeSettleMs = 250.0;
+    double resizeSettleTime_ = 0.0;
+    bool useSharedMemory_ = false;
+    bool detached_ = false;
+
+    // Visibility state (message thread only); the surface is released while hidden long enough
+    bool visible_ = true;
+    bool surfaceReleased_ = false;
+    juce::TimedCallback releaseTimer_ { [this] { releaseHiddenSurface(); } };
     EventCallback eventCallback_;
     MidiCallback midiCallback_;
+    MidiBufferCallback midiBufferCallback_;
+    ParameterCallback parameterCallback_;
+    Ipc::Delivery midiDelivery_ = Ipc::Delivery::MessageThread;
+    bool useMidiFifo_ = false;
+    MidiFifo midiFifo_;
+    VisualStream visualStream_;
     FirstFrameCallback firstFrameCallback_;
+    RestartCallback restartCallback_;
+    std::unique_ptr<ValueTreeSync> treeSync_;
+
+    // Crash recovery state (message thread only)
+    std::string executable_;
+    bool autoRestart_ = true;
+    int restartCount_ = 0;
+    double lastRestartMs_ = 0.0;
+    std::map<uint32_t, juce::ValueTree> keyedEvents_;  // Latest event per coalesceKey, replayed on launch
+    std::map<uint32_t, std::shared_ptr<const SharedBlob>> blobs_;  // Latest blob per id, replayed on launch
+    FrameStats frameStats_;
+    bool frameTimingEnabled_ = false;
+    juce::Image captureImage_;  // Reused by captureFrame() while nobody else holds it
+
+    // Latest completed buffer, presented on the next display refresh
+    uint8_t pendingGeneration_ = 0;
+    uint8_t pendingIndex_ = 0;
+    bool awaitingVsyncFrame_ = false;  // VSYNC sent, no BUFFER_READY since
+
+    // Coalesced mouse move or scroll not sent yet (message thread only)
+    InputEvent pendingInput_ = {};
+    bool hasPendingInput_ = false;
 
     // Pending view bounds (applied when new surface is ready)
     int pendingViewX_ = 0;
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "FrameStats.h"
+
+#include <algorithm>
+
+namespace juce_cmp
+{
+
+namespace
+{
+    // A flip this long after the previous one means the UI was idle, not janky
+    constexpr double idleGapMs = 250.0;
+
+    // Input timestamps are the low 32 bits of the same millisecond clock
+    double elapsedSince(uint32_t timestamp, double nowMs)
+    {
+        auto whole = static_cast<uint64_t>(nowMs);
+        uint32_t elapsed = static_cast<uint32_t>(whole) - timestamp;
+        return elapsed + (nowMs - static_cast<double>(whole));
+    }
+
+    // Sorts values; negative entries (no sample) were left out by the caller
+    FrameStats::Percentiles percentiles(std::vector<float>& values)
+    {
+        FrameStats::Percentiles result;
+        if (values.empty())
+            return result;
+
+        std::sort(values.begin(), values.end());
+        auto at = [&values](double fraction) {
+            return static_cast<double>(values[static_cast<size_t>(fraction * (values.size() - 1))]);
+        };
+        result.p50 = at(0.5);
+        result.p99 = at(0.99);
+        result.max = values.back();
+        return result;
+    }
+}
+
+FrameStats::FrameStats()
+    : history_(historySize)
+{
+}
+
+void FrameStats::addFrame(const Frame& frame)
+{
+    if (frame.index >= SWAP_CHAIN_MAX_BUFFERS)
+        return;
+
+    pending_[frame.index] = frame;
+    hasPending_[frame.index] = true;
+}
+
+void FrameStats::framePresented(uint8_t generation, uint8_t index, double presentMs)
+{
+    if (index >= SWAP_CHAIN_MAX_BUFFERS || !hasPending_[index] || pending_[index].generation != generation)
+        return;
+
+    const Frame& frame = pending_[index];
+    hasPending_[index] = false;
+
+    Sample sample;
+    if (frame.inputTimestamp != 0)
+    {
+        sample.inputToPhoton = static_cast<float>(elapsedSince(frame.inputTimestamp, presentMs));
+        sample.inputQueue = frame.queueMicros / 1000.0f;
+    }
+    sample.frameTime = (frame.dispatchMicros + frame.renderMicros + frame.flushMicros + frame.gpuMicros) / 1000.0f;
+    sample.render = frame.renderMicros / 1000.0f;
+    sample.gpu = frame.gpuMicros / 1000.0f;
+
+    double interval = presentMs - lastPresentMs_;
+    if (lastPresentMs_ > 0.0 && interval < idleGapMs)
+        sample.presentInterval = static_cast<float>(interval);
+    lastPresentMs_ = presentMs;
+
+    history_[next_] = sample;
+    next_ = (next_ + 1) % historySize;
+    count_ = std::min(count_ + 1, historySize);
+}
+
+FrameStats::Summary FrameStats::getSummary() const
+{
+    Summary summary;
+    summary.numFrames = count_;
+    summary.missedDeadlines = missedDeadlines_;
+
+    std::vector<float> values;
+    values.reserve(count_);
+
+    auto field = [&](float Sample::*member) {
+        values.clear();
+        for (size_t i = 0; i < count_; ++i)
+            if (history_[i].*member >= 0.0f)
+                values.push_back(history_[i].*member);
+        return percentiles(values);
+    };
+
+    summary.inputToPhoton = field(&Sample::inputToPhoton);
+    summary.inputQueue = field(&Sample::inputQueue);
+    summary.frameTime = field(&Sample::frameTime);
+    summary.render = field(&Sample::render);
+    summary.gpu = field(&Sample::gpu);
+    summary.presentInterval = field(&Sample::presentInterval);
+
+    for (size_t i = 0; i < count_; ++i)
+    {
+        auto bucket = static_cast<size_t>(history_[i].frameTime);
+        ++summary.frameTimeHistogram[std::min(bucket, histogramBuckets - 1)];
+    }
+
+    return summary;
+}
+
+void FrameStats::reset()
+{
+    hasPending_.fill(false);
+    next_ = 0;
+    count_ = 0;
+    lastPresentMs_ = 0.0;
+    missedDeadlines_ = 0;
+}
+
+}  // namespace juce_cmp
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "ipc_protocol.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace juce_cmp
+{
+
+/**
+ * FrameStats - Frame timing and input-to-photon latency (host side).
+ *
+ * While timing is enabled the child reports each frame's costs
+ * (CMP_EVENT_FRAME_TIMING): how long its oldest input waited in the child,
+ * input dispatch, scene render, flush and GPU time. The host adds the
+ * moment the frame was flipped on screen, so a janky frame can be traced to
+ * the stage that took the time. Input timestamps come from the host clock
+ * (ComposeProvider::sendInput() stamps every InputEvent), so latency needs no clock sync.
+ *
+ * Keeps the last historySize presented frames. Message thread only.
+ */
+class FrameStats
+{
+public:
+    /** Presented frames summarized, about ten seconds at 60 Hz. */
+    static constexpr size_t historySize = 600;
+
+    /** Frame time histogram: 1 ms buckets, the last one collects the rest. */
+    static constexpr size_t histogramBuckets = 33;
+
+    /** One frame as reported by the child. */
+    struct Frame
+    {
+        uint8_t generation = 0;
+        uint8_t index = 0;
+        uint32_t inputTimestamp = 0;  // Host milliseconds of the oldest input, 0 = none
+        uint32_t queueMicros = 0;     // Oldest input waiting in the child
+        uint32_t dispatchMicros = 0;
+        uint32_t renderMicros = 0;
+        uint32_t flushMicros = 0;
+        uint32_t gpuMicros = 0;
+    };
+
+    /** Milliseconds. */
+    struct Percentiles
+    {
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    struct Summary
+    {
+        size_t numFrames = 0;
+        Percentiles inputToPhoton;    // Frames that carried input
+        Percentiles inputQueue;       // Frames that carried input
+        Percentiles frameTime;        // Dispatch + render + flush + GPU
+        Percentiles render;
+        Percentiles gpu;
+        Percentiles presentInterval;  // Between consecutive flips on the host
+        uint32_t missedDeadlines = 0; // Vsyncs whose frame was not ready by the next one
+        std::array<uint32_t, histogramBuckets> frameTimeHistogram {};
+    };
+
+    FrameStats();
+
+    /** Store a report until its buffer is presented. */
+    void addFrame(const Frame& frame);
+
+    /** The given buffer reached the screen at presentMs (Time::getMillisecondCounterHiRes). */
+    void framePresented(uint8_t generation, uint8_t index, double presentMs);
+
+    /** The child's frame for the last vsync (CMP_EVENT_VSYNC) missed its deadline. */
+    void deadlineMissed() { ++missedDeadlines_; }
+
+    Summary getSummary() const;
+
+    /** Forget all frames, e.g. when the child restarts. */
+    void reset();
+
+private:
+    struct Sample
+    {
+        float inputToPhoton = -1.0f;  // < 0: frame carried no input
+        float inputQueue = -1.0f;
+        float frameTime = 0.0f;
+        float render = 0.0f;
+        float gpu = 0.0f;
+        float presentInterval = -1.0f;  // < 0: first frame after a gap
+    };
+
+    std::array<Frame, SWAP_CHAIN_MAX_BUFFERS> pending_ {};
+    std::array<bool, SWAP_CHAIN_MAX_BUFFERS> hasPending_ {};
+    std::vector<Sample> history_;
+    size_t next_ = 0;
+    size_t count_ = 0;
+    double lastPresentMs_ = 0.0;
+    uint32_t missedDeadlines_ = 0;
+};
+
+}  // namespace juce_cmp
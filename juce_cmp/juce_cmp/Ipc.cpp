@@ -8,12 +8,50 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <poll.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
 #endif
 
 namespace juce_cmp
 {
 
-Ipc::Ipc() = default;
+static_assert(ParameterSlots::maxParameters <= PARAM_MAX_RECORDS,
+              "Every parameter must fit in one PARAM batch");
+
+namespace
+{
+    // Unsigned LEB128, as used by EVENT_TYPE_MIDI_BUFFER
+    void writeVarint(juce::MemoryOutputStream& stream, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            stream.writeByte(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        stream.writeByte(static_cast<char>(value));
+    }
+
+    bool readVarint(const uint8_t*& data, const uint8_t* end, uint32_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 32 && data < end; shift += 7)
+        {
+            uint8_t byte = *data++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+}
+
+Ipc::Ipc()
+    : paramFrame(3 + ParameterSlots::maxParameters * PARAM_RECORD_SIZE),
+      rxQueue(static_cast<size_t>(rxQueueSize)),
+      rxParams(PARAM_MAX_RECORDS * PARAM_RECORD_SIZE),
+      rxBuffer(rxBufferSize)
+{
+}
 
 Ipc::~Ipc()
 {
@@ -34,22 +72,94 @@ void Ipc::setSocketFD(int fd)
 #endif
 }
 
+void Ipc::setEventHandler(EventHandler handler, Delivery delivery)
+{
+    onEvent = std::move(handler);
+    eventDelivery = delivery;
+}
+
+void Ipc::setMidiHandler(MidiHandler handler, Delivery delivery)
+{
+    onMidi = std::move(handler);
+    midiDelivery = delivery;
+}
+
+int Ipc::createSharedMemory()
+{
+    if (!ring.create())
+        return -1;
+    return ring.getFD();
+}
+
 void Ipc::startReceiving()
 {
     if (running.load()) return;
     if (socketFD < 0) return;
 
+#if JUCE_MAC || JUCE_LINUX
+    if (pipe(stopPipe) != 0)
+        return;
+    for (int fd : stopPipe)
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+
+    rxBegin = 0;
+    rxEnd = 0;
     running.store(true);
-    readerThread = std::thread([this]() { readerLoop(); });
+    readerThread = std::thread([this]() {
+        if (ring.isValid())
+            ringReaderLoop();
+        else
+            readerLoop();
+    });
+    writerThread = std::thread([this]() { writerLoop(); });
 }
 
 void Ipc::stop()
 {
-    running.store(false);
+    {
+        std::lock_guard<std::mutex> lock(txLock);
+        running.store(false);
+        txPending.notify_all();
+        txSpace.notify_all();
+    }
+    {
+        std::lock_guard<std::mutex> lock(rxSpaceLock);
+        rxSpace.notify_all();
+    }
+
+#if JUCE_MAC || JUCE_LINUX
+    // The reader sleeps in poll() without a timeout; wake it so the join is immediate
+    if (stopPipe[1] >= 0)
+    {
+        uint8_t wake = 0;
+        ssize_t n = ::write(stopPipe[1], &wake, 1);
+        juce::ignoreUnused(n);
+    }
+#endif
 
+    if (writerThread.joinable())
+        writerThread.join();
     if (readerThread.joinable())
         readerThread.join();
 
+#if JUCE_MAC || JUCE_LINUX
+    for (int& fd : stopPipe)
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+#endif
+
+    txQueue.clear();
+    txQueuedBytes = 0;
+    txHeadOffset = 0;
+
+    // Messages not yet delivered belong to the channel that just ended
+    cancelPendingUpdate();
+    rxFifo.reset();
+
 #if JUCE_MAC || JUCE_LINUX
     if (socketFD >= 0)
     {
@@ -57,6 +167,8 @@ void Ipc::stop()
         socketFD = -1;
     }
 #endif
+
+    ring.release();
 }
 
 // =============================================================================
@@ -67,48 +179,658 @@ void Ipc::sendInput(InputEvent& event)
 {
     if (socketFD < 0) return;
 
-#if JUCE_MAC || JUCE_LINUX
     uint8_t prefix = EVENT_TYPE_INPUT;
-    if (!writeNonBlocking(&prefix, 1))
-        return;
-    writeNonBlocking(&event, sizeof(InputEvent));
-#endif
+    SharedRing::Chunk chunks[] = {
+        { &prefix, 1 },
+        { &event, sizeof(InputEvent) }
+    };
+
+    // Only the latest pointer position matters while moves are queued
+    bool isMove = event.type == INPUT_EVENT_MOUSE && event.action == INPUT_ACTION_MOVE;
+    sendFrame(chunks, 2, isMove ? (uint64_t(EVENT_TYPE_INPUT) << 32) | INPUT_ACTION_MOVE : 0);
+}
+
+void Ipc::sendDetach(uint8_t generation)
+{
+    if (socketFD < 0) return;
+
+    uint8_t message[] = { EVENT_TYPE_CMP, CMP_EVENT_DETACH, generation };
+    SharedRing::Chunk chunk = { message, sizeof(message) };
+    sendFrame(&chunk, 1);
+}
+
+void Ipc::sendTimingEnabled(bool enabled)
+{
+    if (socketFD < 0) return;
+
+    uint8_t message[] = { EVENT_TYPE_CMP, CMP_EVENT_TIMING_ENABLE, static_cast<uint8_t>(enabled ? 1 : 0) };
+    SharedRing::Chunk chunk = { message, sizeof(message) };
+    sendFrame(&chunk, 1);
+}
+
+void Ipc::sendVisibility(bool visible)
+{
+    if (socketFD < 0) return;
+
+    // Only the latest state matters to a UI that fell behind
+    uint8_t message[] = { EVENT_TYPE_CMP, CMP_EVENT_VISIBILITY, static_cast<uint8_t>(visible ? 1 : 0) };
+    SharedRing::Chunk chunk = { message, sizeof(message) };
+    sendFrame(&chunk, 1, (uint64_t(EVENT_TYPE_CMP) << 32) | CMP_EVENT_VISIBILITY);
+}
+
+void Ipc::sendVsync(uint64_t deadlineNanos, uint64_t presentNanos)
+{
+    if (socketFD < 0) return;
+
+    // A stale tick is useless, the UI only needs the latest one
+    uint8_t message[2 + CMP_VSYNC_SIZE] = { EVENT_TYPE_CMP, CMP_EVENT_VSYNC };
+    memcpy(message + 2, &deadlineNanos, sizeof(deadlineNanos));
+    memcpy(message + 10, &presentNanos, sizeof(presentNanos));
+    SharedRing::Chunk chunk = { message, sizeof(message) };
+    sendFrame(&chunk, 1, (uint64_t(EVENT_TYPE_CMP) << 32) | CMP_EVENT_VSYNC);
+}
+
+void Ipc::setOverflowPolicy(OverflowPolicy policy)
+{
+    std::lock_guard<std::mutex> lock(txLock);
+    overflowPolicy = policy;
 }
 
-void Ipc::sendEvent(const juce::ValueTree& tree)
+void Ipc::sendEvent(const juce::ValueTree& tree, uint32_t coalesceKey)
 {
     if (socketFD < 0) return;
 
     juce::MemoryOutputStream stream;
     tree.writeToStream(stream);
 
+    if (stream.getDataSize() > VALUETREE_MAX_SIZE)
+        return;
+
     const void* data = stream.getData();
     uint32_t dataSize = static_cast<uint32_t>(stream.getDataSize());
 
-#if JUCE_MAC || JUCE_LINUX
     uint8_t prefix = EVENT_TYPE_JUCE;
-    if (!writeNonBlocking(&prefix, 1))
+    SharedRing::Chunk chunks[] = {
+        { &prefix, 1 },
+        { &dataSize, 4 },
+        { data, dataSize }
+    };
+    sendFrame(chunks, 3, coalesceKey != 0 ? (uint64_t(EVENT_TYPE_JUCE) << 32) | coalesceKey : 0);
+}
+
+void Ipc::sendMidi(const juce::MidiMessage& message)
+{
+    if (socketFD < 0) return;
+
+    // Too long for a 1-byte size (SysEx): send it as a buffer of one
+    int rawSize = message.getRawDataSize();
+    if (rawSize > 255)
+    {
+        juce::MidiBuffer buffer;
+        buffer.addEvent(message, 0);
+        sendMidiBuffer(buffer);
+        return;
+    }
+
+    auto size = static_cast<uint8_t>(rawSize);
+    if (size == 0) return;
+
+    uint8_t prefix = EVENT_TYPE_MIDI;
+    SharedRing::Chunk chunks[] = {
+        { &prefix, 1 },
+        { &size, 1 },
+        { message.getRawData(), size }
+    };
+    sendFrame(chunks, 3);
+}
+
+bool Ipc::sendMidiBuffer(const juce::MidiBuffer& buffer)
+{
+    if (socketFD < 0 || buffer.isEmpty()) return false;
+
+    juce::MemoryOutputStream stream;
+    for (const auto metadata : buffer)
+    {
+        writeVarint(stream, static_cast<uint32_t>(juce::jmax(0, metadata.samplePosition)));
+        writeVarint(stream, static_cast<uint32_t>(metadata.numBytes));
+        stream.write(metadata.data, static_cast<size_t>(metadata.numBytes));
+    }
+
+    if (stream.getDataSize() > MIDI_BUFFER_MAX_SIZE)
+        return false;
+
+    uint8_t prefix = EVENT_TYPE_MIDI_BUFFER;
+    uint32_t dataSize = static_cast<uint32_t>(stream.getDataSize());
+    SharedRing::Chunk chunks[] = {
+        { &prefix, 1 },
+        { &dataSize, 4 },
+        { stream.getData(), dataSize }
+    };
+    return sendFrame(chunks, 3);
+}
+
+bool Ipc::sendSync(const void* data, size_t size)
+{
+    if (socketFD < 0 || size == 0 || size > VALUETREE_MAX_SIZE) return false;
+
+    uint8_t prefix = EVENT_TYPE_SYNC;
+    uint32_t dataSize = static_cast<uint32_t>(size);
+    SharedRing::Chunk chunks[] = {
+        { &prefix, 1 },
+        { &dataSize, 4 },
+        { data, size }
+    };
+    bool sent = sendFrame(chunks, 3);
+
+    // An earlier change dropped on overflow leaves the child's mirror stale
+    return !syncDropped.exchange(false) && sent;
+}
+
+bool Ipc::sendBlob(uint32_t id, std::shared_ptr<const SharedBlob> blob)
+{
+    if (socketFD < 0 || blob == nullptr || !blob->isValid()) return false;
+
+    uint8_t prefix = EVENT_TYPE_BLOB;
+    uint32_t size = static_cast<uint32_t>(blob->getSize());
+    SharedRing::Chunk chunks[] = {
+        { &prefix, 1 },
+        { &id, 4 },
+        { &size, 4 }
+    };
+    int fd = blob->getFD();
+    return sendFrame(chunks, 3, (uint64_t(EVENT_TYPE_BLOB) << 32) | id, &fd, 1);
+}
+
+bool Ipc::sendSwapChain(uint8_t generation, int width, int height, uint32_t format, uint64_t modifier,
+                        const DmaBuf* buffers, int count)
+{
+    if (socketFD < 0 || count < 1 || count > SWAP_CHAIN_MAX_BUFFERS) return false;
+
+    uint8_t message[2 + CMP_SWAP_CHAIN_HEADER_SIZE + SWAP_CHAIN_MAX_BUFFERS * CMP_SWAP_CHAIN_BUFFER_SIZE];
+    message[0] = EVENT_TYPE_CMP;
+    message[1] = CMP_EVENT_SWAP_CHAIN;
+    message[2] = generation;
+    message[3] = static_cast<uint8_t>(count);
+
+    uint32_t fields[3] = { static_cast<uint32_t>(width), static_cast<uint32_t>(height), format };
+    memcpy(message + 4, fields, sizeof(fields));
+    memcpy(message + 16, &modifier, sizeof(modifier));
+
+    int fds[SWAP_CHAIN_MAX_BUFFERS];
+    uint8_t* record = message + 2 + CMP_SWAP_CHAIN_HEADER_SIZE;
+    for (int i = 0; i < count; ++i, record += CMP_SWAP_CHAIN_BUFFER_SIZE)
+    {
+        memcpy(record, &buffers[i].stride, 4);
+        memcpy(record + 4, &buffers[i].offset, 4);
+        fds[i] = buffers[i].fd;
+    }
+
+    SharedRing::Chunk chunk = { message, static_cast<size_t>(record - message) };
+    return sendFrame(&chunk, 1, (uint64_t(EVENT_TYPE_CMP) << 32) | CMP_EVENT_SWAP_CHAIN, fds, count);
+}
+
+void Ipc::beginBatch()
+{
+    std::lock_guard<std::mutex> lock(txLock);
+    ++batchDepth;
+}
+
+void Ipc::endBatch()
+{
+    std::lock_guard<std::mutex> lock(txLock);
+    if (batchDepth == 0 || --batchDepth > 0)
         return;
-    if (!writeNonBlocking(&dataSize, 4))
+
+    if (!drainTxQueue())
         return;
-    writeNonBlocking(data, dataSize);
+
+    if (ring.isValid() && ring.takeReaderWaiting())
+        wakePeer();
+
+    if (!txQueue.empty())
+        txPending.notify_one();
+}
+
+Ipc::AttachedFDs& Ipc::AttachedFDs::operator=(AttachedFDs&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        memcpy(fds, other.fds, sizeof(fds));
+        count = other.count;
+        other.count = 0;
+    }
+    return *this;
+}
+
+bool Ipc::AttachedFDs::assign(const int* source, int num)
+{
+    reset();
+#if JUCE_MAC || JUCE_LINUX
+    if (num > SWAP_CHAIN_MAX_BUFFERS)
+        return false;
+
+    for (int i = 0; i < num; ++i)
+    {
+        int fd = fcntl(source[i], F_DUPFD_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            reset();
+            return false;
+        }
+        fds[count++] = fd;
+    }
+    return true;
+#else
+    juce::ignoreUnused(source, num);
+    return false;
 #endif
 }
 
-void Ipc::sendMidi(const juce::MidiMessage& message)
+void Ipc::AttachedFDs::reset()
 {
-    if (socketFD < 0) return;
+#if JUCE_MAC || JUCE_LINUX
+    for (int i = 0; i < count; ++i)
+        ::close(fds[i]);
+#endif
+    count = 0;
+}
+
+bool Ipc::sendFrame(const SharedRing::Chunk* chunks, size_t numChunks, uint64_t coalesceKey,
+                    const int* fds, int numFDs)
+{
+    std::unique_lock<std::mutex> lock(txLock);
+    if (socketFD < 0)
+        return false;
+
+    // Fast path: nothing queued ahead of us, write straight into the ring
+    if (ring.isValid() && numFDs == 0 && txQueue.empty() && ring.write(chunks, numChunks))
+    {
+        if (batchDepth == 0 && ring.takeReaderWaiting())
+            wakePeer();
+        return true;
+    }
+
+    size_t frameSize = 0;
+    for (size_t i = 0; i < numChunks; ++i)
+        frameSize += chunks[i].size;
+
+    if (frameSize > maxPendingBytes)
+        return false;
+
+    // A ring record that can never fit would stay at the head of the queue for good
+    if (ring.isValid() && numFDs == 0 && frameSize > ring.getMaxMessageSize())
+        return false;
+
+    // Our own copies, so the caller may close its fds while the message is queued
+    AttachedFDs attached;
+    if (numFDs > 0 && !attached.assign(fds, numFDs))
+        return false;
+
+    if (overflowPolicy == OverflowPolicy::Coalesce && coalesceKey != 0
+        && coalesce(chunks, numChunks, frameSize, coalesceKey, attached))
+        return true;
+
+    if (!makeRoom(lock, frameSize))
+        return false;
+
+    TxFrame frame;
+    frame.coalesceKey = coalesceKey;
+    frame.fds = std::move(attached);
+    frame.bytes.reserve(frameSize);
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        auto* data = static_cast<const uint8_t*>(chunks[i].data);
+        frame.bytes.insert(frame.bytes.end(), data, data + chunks[i].size);
+    }
+    txQueue.push_back(std::move(frame));
+    txQueuedBytes += frameSize;
+
+    if (batchDepth > 0)
+        return true;
+
+    // Write what the peer accepts now; the writer thread finishes the rest
+    if (!drainTxQueue())
+        return false;
+
+    if (!txQueue.empty())
+        txPending.notify_one();
+    return true;
+}
+
+bool Ipc::coalesce(const SharedRing::Chunk* chunks, size_t numChunks, size_t frameSize, uint64_t coalesceKey,
+                   AttachedFDs& fds)
+{
+    // Only the newest frame: replacing an older one would move it ahead of the
+    // messages queued after it (a drag's moves before its press and release).
+    // The head may be partially written already; it must go out unchanged
+    if (txQueue.empty() || (txQueue.size() == 1 && txHeadOffset > 0))
+        return false;
+
+    auto& frame = txQueue.back();
+    if (frame.coalesceKey != coalesceKey)
+        return false;
+
+    txQueuedBytes -= frame.bytes.size();
+    frame.bytes.clear();
+    for (size_t c = 0; c < numChunks; ++c)
+    {
+        auto* data = static_cast<const uint8_t*>(chunks[c].data);
+        frame.bytes.insert(frame.bytes.end(), data, data + chunks[c].size);
+    }
+    txQueuedBytes += frameSize;
+    frame.fds = std::move(fds);
+    return true;
+}
+
+bool Ipc::makeRoom(std::unique_lock<std::mutex>& lock, size_t frameSize)
+{
+    if (txQueuedBytes + frameSize <= maxPendingBytes)
+        return true;
+
+    // The writer thread itself (parameter flush) must never wait for room
+    if (overflowPolicy == OverflowPolicy::Block && std::this_thread::get_id() != writerThreadId)
+    {
+        txPending.notify_one();
+        txSpace.wait(lock, [this, frameSize]() {
+            return !running.load() || socketFD < 0 || txQueuedBytes + frameSize <= maxPendingBytes;
+        });
+        return running.load() && socketFD >= 0;
+    }
 
-    auto size = static_cast<uint8_t>(message.getRawDataSize());
-    if (size == 0 || size > 255) return;
+    // DropOldest (and Coalesce when nothing matched): discard whole messages,
+    // except a partially written head
+    size_t index = txHeadOffset > 0 ? 1 : 0;
+    while (txQueuedBytes + frameSize > maxPendingBytes && index < txQueue.size())
+    {
+        // The reader waits for a message its ring record announced. PARAM
+        // records are the only copy of values already drained from their slots
+        if (txQueue[index].marked || txQueue[index].bytes[0] == EVENT_TYPE_PARAM)
+        {
+            ++index;
+            continue;
+        }
+
+        if (txQueue[index].bytes[0] == EVENT_TYPE_SYNC)
+            syncDropped = true;
+        txQueuedBytes -= txQueue[index].bytes.size();
+        txQueue.erase(txQueue.begin() + static_cast<std::ptrdiff_t>(index));
+    }
+
+    return txQueuedBytes + frameSize <= maxPendingBytes;
+}
+
+void Ipc::popFront()
+{
+    txQueuedBytes -= txQueue.front().bytes.size();
+    txQueue.pop_front();
+    txHeadOffset = 0;
+}
+
+bool Ipc::drainTxQueue()
+{
+    if (txQueue.empty())
+        return true;
+
+    size_t before = txQueuedBytes;
+    bool ok = ring.isValid() ? drainToRing() : drainToSocket();
+
+    if (!ok)
+    {
+        // Real error - the connection is gone
+        txQueue.clear();
+        txQueuedBytes = 0;
+        txHeadOffset = 0;
+        socketFD = -1;
+    }
+
+    if (txQueuedBytes < before || !ok)
+        txSpace.notify_all();
+    return ok;
+}
 
+bool Ipc::drainToSocket(size_t maxFrames)
+{
 #if JUCE_MAC || JUCE_LINUX
-    uint8_t prefix = EVENT_TYPE_MIDI;
-    if (!writeNonBlocking(&prefix, 1))
+    size_t sent = 0;
+    while (!txQueue.empty() && sent < maxFrames)
+    {
+        ssize_t n;
+        if (txQueue.front().fds.count > 0 && txHeadOffset == 0)
+        {
+            n = sendWithFDs(txQueue.front());
+        }
+        else
+        {
+            // Gather queued frames into one writev, up to the next one carrying fds
+            constexpr size_t maxIov = 64;
+            struct iovec iov[maxIov];
+            size_t count = 0;
+            for (size_t i = 0; i < txQueue.size() && i < maxFrames - sent && count < maxIov; ++i, ++count)
+            {
+                if (i > 0 && txQueue[i].fds.count > 0)
+                    break;
+                size_t offset = (i == 0) ? txHeadOffset : 0;
+                iov[count].iov_base = txQueue[i].bytes.data() + offset;
+                iov[count].iov_len = txQueue[i].bytes.size() - offset;
+            }
+
+            n = ::writev(socketFD, iov, static_cast<int>(count));
+        }
+
+        if (n < 0)
+        {
+            // Socket buffer full - leave the rest to the writer thread
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return true;
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        // Consume written bytes, popping complete frames
+        auto remaining = static_cast<size_t>(n);
+        while (remaining > 0 && !txQueue.empty())
+        {
+            size_t left = txQueue.front().bytes.size() - txHeadOffset;
+            if (remaining < left)
+            {
+                txHeadOffset += remaining;
+                break;
+            }
+            remaining -= left;
+            popFront();
+            ++sent;
+        }
+
+        if (txHeadOffset > 0)
+            return true;  // Short write - socket is full
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+ssize_t Ipc::sendWithFDs(const TxFrame& frame)
+{
+#if JUCE_MAC || JUCE_LINUX
+    struct iovec iov = { const_cast<uint8_t*>(frame.bytes.data()), frame.bytes.size() };
+
+    size_t fdBytes = sizeof(int) * static_cast<size_t>(frame.fds.count);
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * SWAP_CHAIN_MAX_BUFFERS)] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(fdBytes);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(fdBytes);
+    memcpy(CMSG_DATA(cmsg), frame.fds.fds, fdBytes);
+
+    // The fd is attached to the first byte; a short write sends the rest with writev
+    return ::sendmsg(socketFD, &msg, 0);
+#else
+    juce::ignoreUnused(frame);
+    return -1;
+#endif
+}
+
+bool Ipc::drainToRing()
+{
+    bool wrote = false;
+    while (!txQueue.empty())
+    {
+        auto& frame = txQueue.front();
+        if (frame.fds.count > 0)
+        {
+            // Descriptors can only travel on the socket; a ring record keeps its place
+            if (!frame.marked)
+            {
+                uint8_t marker = EVENT_TYPE_SOCKET;
+                SharedRing::Chunk chunk = { &marker, 1 };
+                if (!ring.write(&chunk, 1))
+                    break;  // Ring full - retry once the child catches up
+                frame.marked = true;
+
+                // A sleeping reader must see the wakeup before the message itself.
+                // It covers the records written before the marker too
+                if (ring.takeReaderWaiting())
+                    wakePeer();
+                wrote = false;
+            }
+
+            size_t queued = txQueue.size();
+            if (!drainToSocket(1))
+                return false;
+            if (txQueue.size() == queued)
+                break;  // Socket full - retry from the writer thread
+            continue;
+        }
+
+        SharedRing::Chunk chunk = { frame.bytes.data(), frame.bytes.size() };
+        if (!ring.write(&chunk, 1))
+            break;  // Ring full - retry once the child catches up
+        popFront();
+        wrote = true;
+    }
+
+    if (wrote && batchDepth == 0 && ring.takeReaderWaiting())
+        wakePeer();
+    return true;
+}
+
+void Ipc::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(txLock);
+    writerThreadId = std::this_thread::get_id();
+    auto lastParameterFlush = std::chrono::steady_clock::now();
+
+    while (running.load())
+    {
+        // Timed wait - the audio thread never notifies, parameter slots are polled
+        txPending.wait_for(lock, parameterFlushInterval, [this]() {
+            return !running.load() || (!txQueue.empty() && batchDepth == 0);
+        });
+
+        if (!running.load())
+            break;
+
+        auto now = std::chrono::steady_clock::now();
+        // Backed up: values stay in their slots, where newer ones replace them
+        if (params.hasPending() && txQueue.empty() && now - lastParameterFlush >= parameterFlushInterval)
+        {
+            lastParameterFlush = now;
+            lock.unlock();
+            flushParameters();
+            lock.lock();
+        }
+
+        if (txQueue.empty() || batchDepth > 0)
+            continue;
+
+        if (!drainTxQueue())
+            break;
+
+        if (txQueue.empty())
+            continue;
+
+        // Ring full (a marked frame waits for the socket instead): the child sends a
+        // RING wakeup once it has read. Announce the wait, then look again, since
+        // room freed before that comes without one. The timeout keeps parameters flowing
+        if (ring.isValid() && !txQueue.front().marked)
+        {
+            ringSpaceFreed = false;
+            ring.prepareWriterWait();
+            if (!drainTxQueue())
+                break;
+            if (!txQueue.empty())
+                txPending.wait_for(lock, parameterFlushInterval, [this]() {
+                    return !running.load() || ringSpaceFreed;
+                });
+            continue;
+        }
+
+        // Still backed up: wait for the peer without holding the lock
+        int fd = socketFD;
+        lock.unlock();
+
+#if JUCE_MAC || JUCE_LINUX
+        struct pollfd pfd = { fd, POLLOUT, 0 };
+        poll(&pfd, 1, static_cast<int>(parameterFlushInterval.count()));
+#else
+        juce::ignoreUnused(fd);
+#endif
+
+        lock.lock();
+    }
+}
+
+void Ipc::flushParameters()
+{
+    // EVENT_TYPE_PARAM + count + records, into a buffer that never grows
+    size_t size = 3;
+    params.drain([this, &size](uint32_t index, float value) {
+        uint8_t* record = paramFrame.data() + size;
+        memcpy(record, &index, 4);
+        memcpy(record + 4, &value, 4);
+        record[8] = 0;
+        size += PARAM_RECORD_SIZE;
+    });
+
+    auto count = static_cast<uint16_t>((size - 3) / PARAM_RECORD_SIZE);
+    if (count == 0)
+        return;
+
+    paramFrame[0] = EVENT_TYPE_PARAM;
+    memcpy(paramFrame.data() + 1, &count, sizeof(count));
+    SharedRing::Chunk chunk = { paramFrame.data(), size };
+    if (sendFrame(&chunk, 1))
         return;
-    if (!writeNonBlocking(&size, 1))
+
+    // Not queued - the next flush sends the slots' latest values instead
+    for (size_t offset = 3; offset < size; offset += PARAM_RECORD_SIZE)
+    {
+        uint32_t index;
+        memcpy(&index, paramFrame.data() + offset, 4);
+        params.markDirty(index);
+    }
+}
+
+void Ipc::wakePeer()
+{
+#if JUCE_MAC || JUCE_LINUX
+    // A message with fds is partially written: its remaining bytes wake the reader instead
+    if (txHeadOffset > 0)
         return;
-    writeNonBlocking(message.getRawData(), size);
+
+    // A full socket buffer already holds pending wakeups, so EAGAIN is harmless
+    uint8_t wake = EVENT_TYPE_RING;
+    ssize_t n = ::write(socketFD, &wake, 1);
+    juce::ignoreUnused(n);
 #endif
 }
 
@@ -124,20 +846,77 @@ void Ipc::readerLoop()
         if (readFully(&eventType, 1) != 1)
             break;
 
-        switch (eventType)
+        handleSocketEvent(eventType);
+    }
+
+    if (running.load())
+        postMessage(rxDisconnected, 0, nullptr, 0);
+}
+
+void Ipc::ringReaderLoop()
+{
+    while (running.load())
+    {
+        // Drain everything the child has published
+        while (ring.read(ringFrame))
         {
-            case EVENT_TYPE_CMP:
-                handleCmpEvent();
-                break;
-            case EVENT_TYPE_JUCE:
-                handleJuceEvent();
-                break;
-            case EVENT_TYPE_MIDI:
-                handleMidiEvent();
-                break;
-            default:
-                break;
+            dispatchFrame(ringFrame.data(), ringFrame.size());
+
+            // A child waiting for room in a full ring can go on
+            if (ring.takeWriterWaiting())
+            {
+                std::lock_guard<std::mutex> lock(txLock);
+                wakePeer();
+            }
+        }
+
+        // Data arrived while announcing the wait - go around again
+        if (!ring.prepareWait())
+            continue;
+
+        // Sleep on the socket until a wakeup (or a regular socket message)
+        uint8_t eventType = 0;
+        if (readFully(&eventType, 1) != 1)
+            break;
+
+        if (eventType != EVENT_TYPE_RING)
+        {
+            handleSocketEvent(eventType);
+            continue;
+        }
+
+        // Also sent after the child read from a full TX ring
+        {
+            std::lock_guard<std::mutex> lock(txLock);
+            ringSpaceFreed = true;
         }
+        txPending.notify_one();
+    }
+
+    if (running.load())
+        postMessage(rxDisconnected, 0, nullptr, 0);
+}
+
+void Ipc::handleSocketEvent(uint8_t eventType)
+{
+    switch (eventType)
+    {
+        case EVENT_TYPE_CMP:
+            handleCmpEvent();
+            break;
+        case EVENT_TYPE_JUCE:
+        case EVENT_TYPE_SYNC:
+        case EVENT_TYPE_MIDI_BUFFER:
+            handleSizedEvent(eventType);
+            break;
+        case EVENT_TYPE_MIDI:
+            handleMidiEvent();
+            break;
+        case EVENT_TYPE_PARAM:
+            handleParamEvent();
+            break;
+        default:
+            break;
     }
 }
 
@@ -147,36 +926,44 @@ void Ipc::handleCmpEvent()
     if (readFully(&subtype, 1) != 1)
         return;
 
-    if (subtype == CMP_EVENT_SURFACE_READY && onFrameReady)
-    {
-        juce::MessageManager::callAsync([this]() {
-            if (onFrameReady)
-                onFrameReady();
-        });
-    }
+    // BUFFER_READY carries generation + index, FRAME_TIMING a fixed record
+    uint8_t data[CMP_FRAME_TIMING_SIZE] = {};
+    size_t size = subtype == CMP_EVENT_BUFFER_READY ? 2
+                : subtype == CMP_EVENT_FRAME_TIMING ? CMP_FRAME_TIMING_SIZE
+                : 0;
+    if (size > 0 && readFully(data, size) != static_cast<ssize_t>(size))
+        return;
+
+    deliverCmpEvent(subtype, data, size);
 }
 
-void Ipc::handleJuceEvent()
+void Ipc::handleSizedEvent(uint8_t eventType)
 {
     uint32_t size = 0;
     if (readFully(&size, sizeof(size)) != sizeof(size))
         return;
 
-    if (size == 0 || size > 1024 * 1024)
+    uint32_t maxSize = eventType == EVENT_TYPE_MIDI_BUFFER ? MIDI_BUFFER_MAX_SIZE : VALUETREE_MAX_SIZE;
+    if (size == 0)
         return;
 
+    if (size > maxSize)
+    {
+        // Not worth allocating: drop the payload and go on with the next message
+        skipFully(size);
+        return;
+    }
+
     juce::MemoryBlock data(size);
     if (readFully(data.getData(), size) != static_cast<ssize_t>(size))
         return;
 
-    auto tree = juce::ValueTree::readFromData(data.getData(), size);
-    if (tree.isValid() && onEvent)
-    {
-        juce::MessageManager::callAsync([this, tree]() {
-            if (onEvent)
-                onEvent(tree);
-        });
-    }
+    if (eventType == EVENT_TYPE_SYNC)
+        deliverSyncEvent(data.getData(), size);
+    else if (eventType == EVENT_TYPE_MIDI_BUFFER)
+        deliverMidiBuffer(static_cast<const uint8_t*>(data.getData()), size);
+    else
+        deliverJuceEvent(data.getData(), size);
 }
 
 void Ipc::handleMidiEvent()
@@ -192,83 +979,400 @@ void Ipc::handleMidiEvent()
     if (readFully(data, size) != static_cast<ssize_t>(size))
         return;
 
-    auto message = juce::MidiMessage(data, static_cast<int>(size));
-    if (onMidi)
+    deliverMidiEvent(data, size);
+}
+
+void Ipc::handleParamEvent()
+{
+    uint16_t count = 0;
+    if (readFully(&count, sizeof(count)) != sizeof(count))
+        return;
+
+    if (count == 0 || count > PARAM_MAX_RECORDS)
+        return;
+
+    size_t size = count * PARAM_RECORD_SIZE;
+    if (readFully(rxParams.data(), size) != static_cast<ssize_t>(size))
+        return;
+
+    deliverParamEvent(rxParams.data(), size);
+}
+
+void Ipc::dispatchFrame(const uint8_t* frame, size_t size)
+{
+    // Same framing as the socket: 1-byte type + payload
+    if (size < 2)
+        return;
+
+    const uint8_t* payload = frame + 1;
+    size_t payloadSize = size - 1;
+
+    switch (frame[0])
     {
-        juce::MessageManager::callAsync([this, message]() {
-            if (onMidi)
-                onMidi(message);
-        });
+        case EVENT_TYPE_CMP:
+            deliverCmpEvent(payload[0], payload + 1, payloadSize - 1);
+            break;
+        case EVENT_TYPE_JUCE:
+        case EVENT_TYPE_SYNC:
+        case EVENT_TYPE_MIDI_BUFFER:
+        {
+            uint32_t dataSize = 0;
+            if (payloadSize < sizeof(dataSize))
+                return;
+            memcpy(&dataSize, payload, sizeof(dataSize));
+            if (dataSize == 0 || dataSize > payloadSize - sizeof(dataSize))
+                return;
+            if (frame[0] == EVENT_TYPE_SYNC)
+                deliverSyncEvent(payload + sizeof(dataSize), dataSize);
+            else if (frame[0] == EVENT_TYPE_MIDI_BUFFER)
+                deliverMidiBuffer(payload + sizeof(dataSize), dataSize);
+            else
+                deliverJuceEvent(payload + sizeof(dataSize), dataSize);
+            break;
+        }
+        case EVENT_TYPE_MIDI:
+        {
+            size_t dataSize = payload[0];
+            if (dataSize == 0 || dataSize > payloadSize - 1)
+                return;
+            deliverMidiEvent(payload + 1, dataSize);
+            break;
+        }
+        case EVENT_TYPE_PARAM:
+        {
+            uint16_t count = 0;
+            if (payloadSize < sizeof(count))
+                return;
+            memcpy(&count, payload, sizeof(count));
+            size_t dataSize = count * PARAM_RECORD_SIZE;
+            if (count == 0 || count > PARAM_MAX_RECORDS || dataSize > payloadSize - sizeof(count))
+                return;
+            deliverParamEvent(payload + sizeof(count), dataSize);
+            break;
+        }
+        default:
+            break;
     }
 }
 
-ssize_t Ipc::readFully(void* buffer, size_t size)
+void Ipc::deliverCmpEvent(uint8_t subtype, const uint8_t* data, size_t size)
 {
-    size_t totalRead = 0;
-    auto* ptr = static_cast<uint8_t*>(buffer);
+    if (subtype == CMP_EVENT_SURFACE_READY && onFrameReady)
+        postMessage(EVENT_TYPE_CMP, subtype, nullptr, 0);
+    else if (subtype == CMP_EVENT_BUFFER_READY && size >= 2 && onBufferReady)
+        postMessage(EVENT_TYPE_CMP, subtype, data, 2);
+    else if (subtype == CMP_EVENT_FRAME_REQUEST && onFrameRequest)
+        postMessage(EVENT_TYPE_CMP, subtype, nullptr, 0);
+    else if (subtype == CMP_EVENT_FRAME_TIMING && size >= CMP_FRAME_TIMING_SIZE && onFrameTiming)
+        postMessage(EVENT_TYPE_CMP, subtype, data, CMP_FRAME_TIMING_SIZE);
+}
 
-#if JUCE_MAC || JUCE_LINUX
-    while (totalRead < size && running.load())
+void Ipc::deliverJuceEvent(const void* data, size_t size)
+{
+    if (!onEvent)
+        return;
+
+    if (eventDelivery == Delivery::MessageThread)
     {
-        // Wait for data with timeout (allows checking running flag)
-        struct pollfd pfd = { socketFD, POLLIN, 0 };
-        int ready = poll(&pfd, 1, 100);  // 100ms timeout
+        postMessage(EVENT_TYPE_JUCE, 0, static_cast<const uint8_t*>(data), size);
+        return;
+    }
 
-        if (ready < 0)
-            return -1;  // Error
-        if (ready == 0)
-            continue;   // Timeout, check running flag
+    auto tree = juce::ValueTree::readFromData(data, size);
+    if (!tree.isValid())
+        return;
 
-        ssize_t n = ::read(socketFD, ptr + totalRead, size - totalRead);
-        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
-            continue;
-        if (n <= 0)
-            return totalRead > 0 ? static_cast<ssize_t>(totalRead) : n;
-        totalRead += static_cast<size_t>(n);
+    rxEvents.assign(1, tree);
+    onEvent(rxEvents);
+    rxEvents.clear();
+}
+
+void Ipc::deliverSyncEvent(const void* data, size_t size)
+{
+    if (onSync)
+        postMessage(EVENT_TYPE_SYNC, 0, static_cast<const uint8_t*>(data), size);
+}
+
+void Ipc::deliverMidiEvent(const uint8_t* data, size_t size)
+{
+    if (!onMidi)
+        return;
+
+    if (midiDelivery == Delivery::MessageThread)
+    {
+        postMessage(EVENT_TYPE_MIDI, 0, data, size);
+        return;
     }
-#endif
-    return static_cast<ssize_t>(totalRead);
+
+    rxMidi.clear();
+    rxMidi.addEvent(data, static_cast<int>(size), 0);
+    onMidi(rxMidi);
 }
 
-bool Ipc::writeNonBlocking(const void* data, size_t size)
+void Ipc::deliverMidiBuffer(const uint8_t* data, size_t size)
 {
-#if JUCE_MAC || JUCE_LINUX
-    size_t totalWritten = 0;
-    auto* ptr = static_cast<const uint8_t*>(data);
+    if (!onMidi)
+        return;
 
-    // Try a few times with small delays for EAGAIN
-    for (int attempts = 0; attempts < 3 && totalWritten < size; ++attempts)
+    if (midiDelivery == Delivery::MessageThread)
     {
-        ssize_t n = ::write(socketFD, ptr + totalWritten, size - totalWritten);
-        if (n > 0)
+        postMessage(EVENT_TYPE_MIDI_BUFFER, 0, data, size);
+        return;
+    }
+
+    rxMidi.clear();
+    if (decodeMidiBuffer(data, size, rxMidi))
+        onMidi(rxMidi);
+    rxMidi.clear();
+}
+
+void Ipc::deliverParamEvent(const uint8_t* records, size_t size)
+{
+    if (onParameter)
+        postMessage(EVENT_TYPE_PARAM, 0, records, size);
+}
+
+// =============================================================================
+// RX queue: reader thread → message thread
+// =============================================================================
+
+void Ipc::postMessage(uint8_t type, uint8_t subtype, const uint8_t* data, size_t size)
+{
+    // Full: stall the reader until the message thread drains, so the child's
+    // sends back up instead of being lost
+    if (rxFifo.getFreeSpace() == 0)
+    {
+        std::unique_lock<std::mutex> lock(rxSpaceLock);
+        rxSpace.wait(lock, [this]() { return !running.load() || rxFifo.getFreeSpace() > 0; });
+        if (!running.load())
+            return;
+    }
+
+    int start1, size1, start2, size2;
+    rxFifo.prepareToWrite(1, start1, size1, start2, size2);
+
+    auto& message = rxQueue[static_cast<size_t>(start1)];
+    message.type = type;
+    message.payload.clear();
+    if (type == EVENT_TYPE_CMP)
+        message.payload.push_back(subtype);
+    if (size > 0)
+        message.payload.insert(message.payload.end(), data, data + size);
+
+    rxFifo.finishedWrite(1);
+
+    // Coalesced: posts nothing if a drain is already pending
+    triggerAsyncUpdate();
+}
+
+void Ipc::handleAsyncUpdate()
+{
+    // Only what is queued now, so a chatty child cannot starve the message loop
+    int count = rxFifo.getNumReady();
+    for (int i = 0; i < count; ++i)
+    {
+        int start1, size1, start2, size2;
+        rxFifo.prepareToRead(1, start1, size1, start2, size2);
+        if (size1 == 0)
+            break;
+
+        const auto& message = rxQueue[static_cast<size_t>(start1)];
+
+        // Always the last message; the handler may stop() and reset the queue
+        if (message.type == rxDisconnected)
         {
-            totalWritten += static_cast<size_t>(n);
-            attempts = 0;  // Reset on progress
+            rxFifo.finishedRead(1);
+            flushEventBatch();
+            flushMidiBatch();
+            if (onDisconnect)
+                onDisconnect();
+            return;
         }
-        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+
+        // Consecutive messages of one kind form a batch; order across kinds is kept
+        if (message.type != EVENT_TYPE_JUCE)
+            flushEventBatch();
+        if (message.type != EVENT_TYPE_MIDI)
+            flushMidiBatch();
+
+        dispatchMessage(message);
+        rxFifo.finishedRead(1);
+    }
+
+    flushEventBatch();
+    flushMidiBatch();
+
+    // A reader stalled on a full queue can go on
+    if (count > 0)
+    {
+        std::lock_guard<std::mutex> lock(rxSpaceLock);
+        rxSpace.notify_one();
+    }
+}
+
+void Ipc::dispatchMessage(const RxMessage& message)
+{
+    const uint8_t* data = message.payload.data();
+    size_t size = message.payload.size();
+
+    switch (message.type)
+    {
+        case EVENT_TYPE_CMP:
+            if (data[0] == CMP_EVENT_SURFACE_READY && onFrameReady)
+                onFrameReady();
+            else if (data[0] == CMP_EVENT_BUFFER_READY && size >= 3 && onBufferReady)
+                onBufferReady(data[1], data[2]);
+            else if (data[0] == CMP_EVENT_FRAME_REQUEST && onFrameRequest)
+                onFrameRequest();
+            else if (data[0] == CMP_EVENT_FRAME_TIMING && size >= 1 + CMP_FRAME_TIMING_SIZE && onFrameTiming)
+                onFrameTiming(decodeFrameTiming(data + 1));
+            break;
+        case EVENT_TYPE_JUCE:
         {
-            // Socket buffer full - yield briefly and retry
-            continue;
+            auto tree = juce::ValueTree::readFromData(data, size);
+            if (tree.isValid())
+                rxEvents.push_back(tree);
+            break;
         }
-        else
-        {
-            // Real error
-            socketFD = -1;
+        case EVENT_TYPE_SYNC:
+            if (onSync)
+                onSync(data, size);
+            break;
+        case EVENT_TYPE_MIDI:
+            rxMidi.addEvent(data, static_cast<int>(size), 0);
+            break;
+        case EVENT_TYPE_MIDI_BUFFER:
+            // A batch of its own: single messages after it must not sort in between
+            if (!decodeMidiBuffer(data, size, rxMidi))
+                rxMidi.clear();
+            flushMidiBatch();
+            break;
+        case EVENT_TYPE_PARAM:
+            for (size_t offset = 0; onParameter && offset + PARAM_RECORD_SIZE <= size; offset += PARAM_RECORD_SIZE)
+            {
+                uint32_t index = 0;
+                float value = 0.0f;
+                memcpy(&index, data + offset, 4);
+                memcpy(&value, data + offset + 4, 4);
+                onParameter(index, value, data[offset + 8]);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+FrameStats::Frame Ipc::decodeFrameTiming(const uint8_t* data)
+{
+    uint32_t fields[6];
+    memcpy(fields, data + 2, sizeof(fields));
+
+    FrameStats::Frame frame;
+    frame.generation = data[0];
+    frame.index = data[1];
+    frame.inputTimestamp = fields[0];
+    frame.queueMicros = fields[1];
+    frame.dispatchMicros = fields[2];
+    frame.renderMicros = fields[3];
+    frame.flushMicros = fields[4];
+    frame.gpuMicros = fields[5];
+    return frame;
+}
+
+bool Ipc::decodeMidiBuffer(const uint8_t* data, size_t size, juce::MidiBuffer& buffer)
+{
+    const uint8_t* end = data + size;
+    while (data < end)
+    {
+        uint32_t samplePosition = 0, length = 0;
+        if (!readVarint(data, end, samplePosition) || !readVarint(data, end, length))
             return false;
-        }
+        if (length == 0 || length > static_cast<size_t>(end - data) || samplePosition > INT32_MAX)
+            return false;
+
+        buffer.addEvent(data, static_cast<int>(length), static_cast<int>(samplePosition));
+        data += length;
+    }
+    return true;
+}
+
+void Ipc::flushEventBatch()
+{
+    if (rxEvents.empty())
+        return;
+
+    if (onEvent)
+        onEvent(rxEvents);
+    rxEvents.clear();
+}
+
+void Ipc::flushMidiBatch()
+{
+    if (rxMidi.isEmpty())
+        return;
+
+    if (onMidi)
+        onMidi(rxMidi);
+    rxMidi.clear();
+}
+
+ssize_t Ipc::readFully(void* buffer, size_t size)
+{
+    size_t totalRead = 0;
+    auto* ptr = static_cast<uint8_t*>(buffer);
+
+    while (totalRead < size)
+    {
+        if (rxBegin == rxEnd && !fillRxBuffer())
+            return totalRead > 0 ? static_cast<ssize_t>(totalRead) : -1;
+
+        size_t n = std::min(size - totalRead, rxEnd - rxBegin);
+        memcpy(ptr + totalRead, rxBuffer.data() + rxBegin, n);
+        rxBegin += n;
+        totalRead += n;
     }
+    return static_cast<ssize_t>(totalRead);
+}
 
-    if (totalWritten != size)
+bool Ipc::skipFully(size_t size)
+{
+    uint8_t discard[4096];
+    while (size > 0)
     {
-        socketFD = -1;
-        return false;
+        size_t n = std::min(size, sizeof(discard));
+        if (readFully(discard, n) != static_cast<ssize_t>(n))
+            return false;
+        size -= n;
     }
     return true;
-#else
-    (void)data;
-    (void)size;
-    return false;
+}
+
+bool Ipc::fillRxBuffer()
+{
+    rxBegin = 0;
+    rxEnd = 0;
+
+#if JUCE_MAC || JUCE_LINUX
+    while (running.load())
+    {
+        // Take everything available in one read; sleep only when there is nothing
+        ssize_t n = ::read(socketFD, rxBuffer.data(), rxBuffer.size());
+        if (n > 0)
+        {
+            rxEnd = static_cast<size_t>(n);
+            return true;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            return false;  // EOF or error
+
+        struct pollfd fds[] = { { socketFD, POLLIN, 0 }, { stopPipe[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) < 0 && errno != EINTR)
+            return false;
+        if (fds[1].revents != 0)
+            return false;  // stop()
+    }
 #endif
+    return false;
 }
 
 }  // namespace juce_cmp
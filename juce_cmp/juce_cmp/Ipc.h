@@ -9,8 +9,18 @@
 #include <functional>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "ipc_protocol.h"
 #include "input_event.h"
+#include "SharedRing.h"
+#include "SharedBlob.h"
+#include "ParameterSlots.h"
+#include "FrameStats.h"
 
 namespace juce_cmp
 {
@@ -18,64 +28,324 @@ namespace juce_cmp
 /**
  * Ipc - Bidirectional IPC channel between host and UI process.
  *
- * Uses a Unix socket for bidirectional communication.
+ * Uses a Unix socket for bidirectional communication. Optionally, messages
+ * travel through a pair of shared memory rings instead (see SharedRing.h)
+ * and the socket only carries wakeups and detects when the peer goes away.
  *
  * Handles both directions:
  * - TX (host → UI): Input events, resize, focus, ValueTree messages
  * - RX (UI → host): Frame ready notification, ValueTree messages
  *
+ * Parameters travel in both directions as packed EVENT_TYPE_PARAM records
+ * rather than ValueTrees, encoded and decoded without allocating.
+ *
+ * The reader thread pushes received messages into a lock-free queue that is
+ * drained by one coalesced callback per message loop turn, so a chatty UI
+ * costs one posted message per turn instead of one per message. Runs of
+ * ValueTree or MIDI messages reach their handler as a single batch, and a
+ * MIDI buffer as a batch of its own with its sample positions. Those two
+ * handlers may opt into Delivery::ReaderThread to skip the queue entirely.
+ *
  * Note: IOSurface sharing uses separate Mach port IPC (see MachPort.h).
  *
  * Protocol: 1-byte event type followed by type-specific payload.
  * See ipc_protocol.h for details.
  */
-class Ipc
+class Ipc : private juce::AsyncUpdater
 {
 public:
-    using EventHandler = std::function<void(const juce::ValueTree& tree)>;
-    using MidiHandler = std::function<void(const juce::MidiMessage& message)>;
+    /**
+     * What to do when the TX queue is full because the child stopped reading.
+     *
+     * - Block: the sender waits until the writer thread makes room
+     * - DropOldest: discard the oldest queued messages to make room
+     * - Coalesce: replace the newest queued message when it has the same
+     *   coalescing key (mouse moves, keyed events), so messages never change
+     *   order; then fall back to DropOldest
+     */
+    enum class OverflowPolicy
+    {
+        Block,
+        DropOldest,
+        Coalesce
+    };
+
+    /** Thread on which a handler is invoked. */
+    enum class Delivery
+    {
+        MessageThread,  // Batched, once per message loop turn
+        ReaderThread    // As soon as received; must not block
+    };
+
+    using EventHandler = std::function<void(const std::vector<juce::ValueTree>& trees)>;
+    using MidiHandler = std::function<void(const juce::MidiBuffer& messages)>;
     using FrameReadyHandler = std::function<void()>;
+    using FrameRequestHandler = std::function<void()>;
+    using BufferReadyHandler = std::function<void(uint8_t generation, uint8_t index)>;
+    using SyncHandler = std::function<void(const void* data, size_t size)>;
+    using FrameTimingHandler = std::function<void(const FrameStats::Frame& frame)>;
+    using ParameterHandler = std::function<void(uint32_t index, float value, uint8_t flags)>;
+    using DisconnectHandler = std::function<void()>;
 
     Ipc();
-    ~Ipc();
+    ~Ipc() override;
 
     // Configuration
     void setSocketFD(int fd);
-    void setEventHandler(EventHandler handler) { onEvent = std::move(handler); }
-    void setMidiHandler(MidiHandler handler) { onMidi = std::move(handler); }
+
+    /**
+     * Enable the shared memory transport. Must be called before launching the
+     * child. Returns the fd the child must inherit (--shm-fd), or -1 on failure.
+     */
+    int createSharedMemory();
+
+    /** Close our copy of the shared memory fd once the child has been spawned. */
+    void closeSharedMemoryFD() { ring.closeFD(); }
+
+    bool isUsingSharedMemory() const { return ring.isValid(); }
+    void setEventHandler(EventHandler handler, Delivery delivery = Delivery::MessageThread);
+    void setMidiHandler(MidiHandler handler, Delivery delivery = Delivery::MessageThread);
     void setFrameReadyHandler(FrameReadyHandler handler) { onFrameReady = std::move(handler); }
+    void setBufferReadyHandler(BufferReadyHandler handler) { onBufferReady = std::move(handler); }
+    void setFrameRequestHandler(FrameRequestHandler handler) { onFrameRequest = std::move(handler); }
+    void setSyncHandler(SyncHandler handler) { onSync = std::move(handler); }
+    void setFrameTimingHandler(FrameTimingHandler handler) { onFrameTiming = std::move(handler); }
+
+    /** Parameter records from the UI, one call per record on the message thread. flags: PARAM_FLAG_*. */
+    void setParameterHandler(ParameterHandler handler) { onParameter = std::move(handler); }
 
-    // Lifecycle
+    /**
+     * Called on the message thread after every message received before the
+     * child closed its end (EOF or read error), but not after stop().
+     * The handler may stop() or restart the channel.
+     */
+    void setDisconnectHandler(DisconnectHandler handler) { onDisconnect = std::move(handler); }
+    void setOverflowPolicy(OverflowPolicy policy);
+
+    // Lifecycle (startReceiving also starts the TX writer thread)
     void startReceiving();
     void stop();
     bool isValid() const { return socketFD >= 0; }
 
     // TX: Host → UI
     void sendInput(InputEvent& event);
-    void sendEvent(const juce::ValueTree& tree);
+    void sendDetach(uint8_t generation);
+    void sendTimingEnabled(bool enabled);
+    void sendVisibility(bool visible);
+    void sendVsync(uint64_t deadlineNanos, uint64_t presentNanos);
+
+    /**
+     * Send a ValueTree. A message with a non-zero coalesceKey replaces the
+     * newest queued one when it has the same key (OverflowPolicy::Coalesce),
+     * so a run of updates reaches the UI as its latest value. A tree that
+     * encodes to more than VALUETREE_MAX_SIZE is not sent.
+     */
+    void sendEvent(const juce::ValueTree& tree, uint32_t coalesceKey = 0);
     void sendMidi(const juce::MidiMessage& message);
 
+    /**
+     * Send every event of a MidiBuffer in one message, with its sample
+     * position and of any length (SysEx). Returns false if the buffer is
+     * empty, encodes to more than MIDI_BUFFER_MAX_SIZE or could not be queued.
+     */
+    bool sendMidiBuffer(const juce::MidiBuffer& buffer);
+
+    /**
+     * Send one synchronized ValueTree change (see ValueTreeSync.h).
+     * Returns false if this or an earlier change was dropped on overflow,
+     * in which case the caller must resend the full tree.
+     */
+    bool sendSync(const void* data, size_t size);
+
+    /**
+     * Send a shared memory blob without copying its contents. The queued
+     * message holds its own reference to the region, so the blob may be
+     * released right away. A newer blob with the same id may replace the
+     * newest queued message (OverflowPolicy::Coalesce).
+     */
+    bool sendBlob(uint32_t id, std::shared_ptr<const SharedBlob> blob);
+
+    /** One exported buffer of a DMA-BUF swap chain. */
+    struct DmaBuf
+    {
+        int fd;
+        uint32_t stride;
+        uint32_t offset;
+    };
+
+    /**
+     * Send a DMA-BUF swap chain (CMP_EVENT_SWAP_CHAIN, Linux). The fds are
+     * duplicated, so the chain may be released while the message is queued.
+     * A newer chain replaces one that is the newest queued message (OverflowPolicy::Coalesce).
+     */
+    bool sendSwapChain(uint8_t generation, int width, int height, uint32_t format, uint64_t modifier,
+                       const DmaBuf* buffers, int count);
+
+    /**
+     * Publish a parameter value. Real-time safe: only stores into a slot, the
+     * writer thread sends the latest value of each changed parameter every
+     * parameterFlushInterval as one EVENT_TYPE_PARAM batch. While the child
+     * is not keeping up the values wait in their slots, so only the latest
+     * one is sent.
+     */
+    void setParameter(uint32_t index, float value) { params.set(index, value); }
+
+    /** Send every parameter published so far again, e.g. to a relaunched child. */
+    void resendParameters() { params.markAllDirty(); }
+
+    /** How often the writer thread flushes changed parameters. */
+    static constexpr std::chrono::milliseconds parameterFlushInterval { 16 };
+
+    /**
+     * Batching - messages sent between beginBatch() and endBatch() are queued
+     * and flushed with a single write (or a single ring wakeup).
+     * Calls may be nested; the outermost endBatch() flushes.
+     */
+    void beginBatch();
+    void endBatch();
+
+    /**
+     * Upper bound for queued bytes before the overflow policy applies. With
+     * shared memory, a message must also fit the ring (SharedRing::defaultCapacity).
+     */
+    static constexpr size_t maxPendingBytes = 4 * 1024 * 1024;
+
+    /** Received messages the message thread may fall behind by before the reader waits. */
+    static constexpr int rxQueueSize = 1024;
+
+    /** Socket bytes the reader takes in one read; messages are parsed from this buffer. */
+    static constexpr size_t rxBufferSize = 64 * 1024;
+
 private:
 
     // RX thread methods
     void readerLoop();
+    void ringReaderLoop();
+    void handleSocketEvent(uint8_t eventType);
     void handleCmpEvent();
-    void handleJuceEvent();
+    void handleSizedEvent(uint8_t eventType);
     void handleMidiEvent();
+    void handleParamEvent();
+    void dispatchFrame(const uint8_t* frame, size_t size);
+    void deliverCmpEvent(uint8_t subtype, const uint8_t* data, size_t size);
+    void deliverJuceEvent(const void* data, size_t size);
+    void deliverSyncEvent(const void* data, size_t size);
+    void deliverMidiEvent(const uint8_t* data, size_t size);
+    void deliverMidiBuffer(const uint8_t* data, size_t size);
+    void deliverParamEvent(const uint8_t* records, size_t size);
     ssize_t readFully(void* buffer, size_t size);
+    bool skipFully(size_t size);
+    bool fillRxBuffer();
+
+    // A received message waiting for the message thread. Slots are reused,
+    // so the payload buffer stops allocating once it has grown.
+    struct RxMessage
+    {
+        uint8_t type = 0;
+        std::vector<uint8_t> payload;  // CMP: subtype + data, others: message data
+    };
+
+    // Queued after the last message when the reader hits EOF (not a protocol type)
+    static constexpr uint8_t rxDisconnected = 0xFF;
 
-    // TX helper (non-blocking with retry)
-    bool writeNonBlocking(const void* data, size_t size);
+    // RX queue (postMessage on the reader thread, the rest on the message thread)
+    void postMessage(uint8_t type, uint8_t subtype, const uint8_t* data, size_t size);
+    void handleAsyncUpdate() override;
+    void dispatchMessage(const RxMessage& message);
+    static FrameStats::Frame decodeFrameTiming(const uint8_t* data);
+    static bool decodeMidiBuffer(const uint8_t* data, size_t size, juce::MidiBuffer& buffer);
+    void flushEventBatch();
+    void flushMidiBatch();
+
+    // Descriptors passed with a queued message (SCM_RIGHTS), owned until it is written
+    struct AttachedFDs
+    {
+        AttachedFDs() = default;
+        AttachedFDs(AttachedFDs&& other) noexcept { *this = std::move(other); }
+        AttachedFDs& operator=(AttachedFDs&& other) noexcept;
+        ~AttachedFDs() { reset(); }
+
+        bool assign(const int* source, int num);  // Duplicates each fd
+        void reset();
+
+        int fds[SWAP_CHAIN_MAX_BUFFERS] = {};
+        int count = 0;
+    };
+
+    // A queued message, kept whole so the stream never desyncs
+    struct TxFrame
+    {
+        std::vector<uint8_t> bytes;
+        uint64_t coalesceKey = 0;
+        AttachedFDs fds;  // Ride on the first byte
+        bool marked = false;  // Its EVENT_TYPE_SOCKET record is in the ring, so it must be sent
+    };
+
+    // TX helpers (all but sendFrame and writerLoop require txLock)
+    bool sendFrame(const SharedRing::Chunk* chunks, size_t numChunks, uint64_t coalesceKey = 0,
+                   const int* fds = nullptr, int numFDs = 0);
+    bool coalesce(const SharedRing::Chunk* chunks, size_t numChunks, size_t frameSize, uint64_t coalesceKey,
+                  AttachedFDs& fds);
+    bool makeRoom(std::unique_lock<std::mutex>& lock, size_t frameSize);
+    void popFront();
+    bool drainTxQueue();
+    bool drainToSocket(size_t maxFrames = SIZE_MAX);
+    ssize_t sendWithFDs(const TxFrame& frame);
+    bool drainToRing();
+    void writerLoop();
+    void flushParameters();
+    void wakePeer();
 
     // Socket file descriptor (bidirectional)
-    int socketFD = -1;
+    std::atomic<int> socketFD { -1 };
+
+    // TX state - the writer thread drains the queue when the peer applies backpressure
+    std::mutex txLock;
+    std::condition_variable txPending;     // Wakes the writer thread
+    std::condition_variable txSpace;       // Wakes senders blocked by OverflowPolicy::Block
+    bool ringSpaceFreed = false;           // The child read from a full TX ring (RING wakeup)
+    std::deque<TxFrame> txQueue;
+    size_t txQueuedBytes = 0;
+    size_t txHeadOffset = 0;               // Bytes of txQueue.front() already written
+    int batchDepth = 0;
+    std::atomic<bool> syncDropped { false };
+    OverflowPolicy overflowPolicy = OverflowPolicy::Coalesce;
+    std::thread writerThread;
+    std::thread::id writerThreadId;
+
+    // Parameter values from the audio thread, polled by the writer thread
+    ParameterSlots params;
+    std::vector<uint8_t> paramFrame;  // PARAM batch, sized for every parameter (writer thread)
+
+    // Shared memory transport (optional)
+    SharedRing ring;
+    std::vector<uint8_t> ringFrame;
 
     // RX state
     std::atomic<bool> running { false };
     std::thread readerThread;
+    juce::AbstractFifo rxFifo { rxQueueSize };
+    std::vector<RxMessage> rxQueue;
+    std::mutex rxSpaceLock;
+    std::condition_variable rxSpace;  // Wakes a reader stalled on a full rxFifo
+    std::vector<juce::ValueTree> rxEvents;  // Batch being assembled by the thread that delivers it
+    juce::MidiBuffer rxMidi;
+    std::vector<uint8_t> rxParams;  // PARAM records read from the socket (reader thread)
+    std::vector<uint8_t> rxBuffer;  // Socket bytes read but not parsed yet (reader thread)
+    size_t rxBegin = 0;
+    size_t rxEnd = 0;
+    int stopPipe[2] = { -1, -1 };   // stop() writes to it to wake the reader out of poll()
     EventHandler onEvent;
     MidiHandler onMidi;
+    Delivery eventDelivery = Delivery::MessageThread;
+    Delivery midiDelivery = Delivery::MessageThread;
     FrameReadyHandler onFrameReady;
+    BufferReadyHandler onBufferReady;
+    FrameRequestHandler onFrameRequest;
+    SyncHandler onSync;
+    FrameTimingHandler onFrameTiming;
+    ParameterHandler onParameter;
+    DisconnectHandler onDisconnect;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Ipc)
 };
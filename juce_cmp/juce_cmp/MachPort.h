@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include "ipc_protocol.h"
 
 namespace juce_cmp
 {
@@ -19,8 +21,11 @@ namespace juce_cmp
  * 1. Parent: createServer() - registers with bootstrap
  * 2. Child: connects via bootstrap_look_up, sends its receive port
  * 3. Parent: waitForClient() - receives child's port, establishes channel
- * 4. Parent: sendPort() - pushes IOSurface ports (initial, resize, etc.)
+ * 4. Parent: sendSwapChain() - pushes IOSurface ports (initial, resize, etc.)
  * 5. Child: receives ports via its receive port
+ *
+ * Swap chain message: SWAP_CHAIN_MAX_BUFFERS port descriptors (unused ones
+ * are MACH_PORT_NULL) followed by inline uint32 count and uint32 generation.
  */
 class MachPort
 {
@@ -40,20 +45,27 @@ public:
 
     /**
      * Server side: Wait for client to connect and establish channel.
-     * Must be called before sendPort(). Blocks until client connects.
+     * Must be called before sendSwapChain(). Blocks until client connects.
      * Returns true on success.
      */
     bool waitForClient();
 
     /**
-     * Server side: Send a Mach port to the client.
+     * Server side: Send the surface ports of a swap chain to the client in one message.
      * Can be called multiple times after waitForClient().
      * Returns true on success.
      */
-    bool sendPort(uint32_t machPort);
+    bool sendSwapChain(const uint32_t* machPorts, int count, uint8_t generation);
+
+    /**
+     * Server side: Make a waitForClient() blocked on another thread return
+     * false right away. The server cannot accept a client afterwards.
+     */
+    void cancelWait();
 
     /**
-     * Cleanup server resources.
+     * Cleanup server resources. A thread in waitForClient() must have been
+     * woken with cancelWait() and joined first.
      */
     void destroyServer();
 
@@ -64,7 +76,7 @@ public:
 
 private:
 #if __APPLE__
-    uint32_t serverPort_ = 0;   // Bootstrap receive port
+    std::atomic<uint32_t> serverPort_ { 0 };  // Bootstrap receive port
     uint32_t clientPort_ = 0;   // Send right to client's receive port
 #endif
     std::string serviceName_;
@@ -49,7 +49,8 @@ std::string MachPort::createServer()
 bool MachPort::waitForClient()
 {
 #if __APPLE__
-    if (serverPort_ == 0)
+    mach_port_t serverPort = (mach_port_t)serverPort_.load();
+    if (serverPort == 0)
         return false;
 
     // Wait for client to connect and send us its receive port
@@ -66,7 +67,7 @@ bool MachPort::waitForClient()
         MACH_RCV_MSG,
         0,
         sizeof(connectMsg),
-        (mach_port_t)serverPort_,
+        serverPort,
         MACH_MSG_TIMEOUT_NONE,
         MACH_PORT_NULL
     );
@@ -82,30 +83,38 @@ bool MachPort::waitForClient()
 #endif
 }
 
-bool MachPort::sendPort(uint32_t machPort)
+bool MachPort::sendSwapChain(const uint32_t* machPorts, int count, uint8_t generation)
 {
 #if __APPLE__
-    if (clientPort_ == 0)
+    if (clientPort_ == 0 || count < 1 || count > SWAP_CHAIN_MAX_BUFFERS)
         return false;
 
-    // Send IOSurface port to client via the established channel
+    // Send all IOSurface ports of the chain to client via the established channel
     struct {
         mach_msg_header_t header;
         mach_msg_body_t body;
-        mach_msg_port_descriptor_t portDescriptor;
+        mach_msg_port_descriptor_t portDescriptors[SWAP_CHAIN_MAX_BUFFERS];
+        uint32_t count;
+        uint32_t generation;
     } msg = {};
 
     msg.header.msgh_bits = MACH_MSGH_BITS_COMPLEX | MACH_MSGH_BITS(MACH_MSG_TYPE_COPY_SEND, 0);
     msg.header.msgh_size = sizeof(msg);
     msg.header.msgh_remote_port = (mach_port_t)clientPort_;
     msg.header.msgh_local_port = MACH_PORT_NULL;
-    msg.header.msgh_id = 1;  // Surface port message
+    msg.header.msgh_id = 2;  // Swap chain message
+
+    msg.body.msgh_descriptor_count = SWAP_CHAIN_MAX_BUFFERS;
 
-    msg.body.msgh_descriptor_count = 1;
+    for (int i = 0; i < SWAP_CHAIN_MAX_BUFFERS; ++i)
+    {
+        msg.portDescriptors[i].name = i < count ? (mach_port_t)machPorts[i] : MACH_PORT_NULL;
+        msg.portDescriptors[i].disposition = MACH_MSG_TYPE_COPY_SEND;
+        msg.portDescriptors[i].type = MACH_MSG_PORT_DESCRIPTOR;
+    }
 
-    msg.portDescriptor.name = (mach_port_t)machPort;
-    msg.portDescriptor.disposition = MACH_MSG_TYPE_COPY_SEND;
-    msg.portDescriptor.type = MACH_MSG_PORT_DESCRIPTOR;
+    msg.count = (uint32_t)count;
+    msg.generation = generation;
 
     kern_return_t kr = mach_msg(
         &msg.header,
@@ -122,11 +131,23 @@ bool MachPort::sendPort(uint32_t machPort)
 
     return true;
 #else
-    (void)machPort;
+    (void)machPorts;
+    (void)count;
+    (void)generation;
     return false;
 #endif
 }
 
+void MachPort::cancelWait()
+{
+#if __APPLE__
+    // Destroying the receive right ends a pending mach_msg() with MACH_RCV_PORT_DIED
+    // (deallocating the name would only drop send rights, which we do not hold)
+    if (uint32_t port = serverPort_.exchange(0))
+        mach_port_mod_refs(mach_task_self(), (mach_port_t)port, MACH_PORT_RIGHT_RECEIVE, -1);
+#endif
+}
+
 void MachPort::destroyServer()
 {
 #if __APPLE__
@@ -135,11 +156,7 @@ void MachPort::destroyServer()
         mach_port_deallocate(mach_task_self(), (mach_port_t)clientPort_);
         clientPort_ = 0;
     }
-    if (serverPort_ != 0)
-    {
-        mach_port_deallocate(mach_task_self(), (mach_port_t)serverPort_);
-        serverPort_ = 0;
-    }
+    cancelWait();
     serviceName_.clear();
 #endif
 }
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "MidiFifo.h"
+
+#include <cstring>
+
+namespace juce_cmp
+{
+
+MidiFifo::MidiFifo()
+    : entries_(static_cast<size_t>(capacity))
+{
+}
+
+bool MidiFifo::push(const uint8_t* data, size_t size, int samplePosition)
+{
+    if (size == 0 || size > maxMessageSize)
+        return false;
+
+    int start1, size1, start2, size2;
+    fifo_.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 == 0)
+        return false;
+
+    auto& entry = entries_[static_cast<size_t>(start1)];
+    entry.timeMs = juce::Time::getMillisecondCounterHiRes();
+    entry.samplePosition = juce::jmax(0, samplePosition);
+    entry.size = static_cast<uint8_t>(size);
+    memcpy(entry.data, data, size);
+
+    fifo_.finishedWrite(1);
+    return true;
+}
+
+void MidiFifo::readBlock(juce::MidiBuffer& buffer, int numSamples, double sampleRate)
+{
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return;
+
+    // This block plays what arrived during the previous block's duration
+    const double nowMs = juce::Time::getMillisecondCounterHiRes();
+    const double windowStartMs = nowMs - numSamples * 1000.0 / sampleRate;
+
+    int count = fifo_.getNumReady();
+    for (int i = 0; i < count; ++i)
+    {
+        int start1, size1, start2, size2;
+        fifo_.prepareToRead(1, start1, size1, start2, size2);
+        if (size1 == 0)
+            break;
+
+        const auto& entry = entries_[static_cast<size_t>(start1)];
+        const double dueMs = entry.timeMs + entry.samplePosition * 1000.0 / sampleRate;
+        if (dueMs > nowMs)
+            break;  // Pushed while draining, or later in its buffer - belongs to a next block
+
+        // Late messages (e.g. after a stalled block) go at the start
+        auto offset = static_cast<int>((dueMs - windowStartMs) * sampleRate / 1000.0);
+        buffer.addEvent(entry.data, entry.size, juce::jlimit(0, numSamples - 1, offset));
+
+        fifo_.finishedRead(1);
+    }
+}
+
+}  // namespace juce_cmp
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace juce_cmp
+{
+
+/**
+ * MidiFifo - MIDI from the UI, handed to the audio thread.
+ *
+ * The Ipc reader thread pushes each message with its arrival time on the
+ * host clock (Time::getMillisecondCounterHiRes) and its sample position in
+ * the MIDI buffer it came in. processBlock() calls readBlock(), which moves
+ * everything due by now into the block's MidiBuffer at the matching sample
+ * offsets. Messages are played one block late, so their spacing survives the
+ * trip instead of collapsing onto the start of the block.
+ *
+ * Single producer, single consumer. Both sides are lock-free and
+ * allocation-free, apart from the MidiBuffer growing if the host did not
+ * reserve room for it. Messages are dropped while the FIFO is full.
+ */
+class MidiFifo
+{
+public:
+    /** Messages buffered between two blocks before new ones are dropped. */
+    static constexpr int capacity = 1024;
+
+    /** Longest message kept; longer SysEx from a MIDI buffer is dropped. */
+    static constexpr size_t maxMessageSize = 255;
+
+    MidiFifo();
+
+    // Non-copyable
+    MidiFifo(const MidiFifo&) = delete;
+    MidiFifo& operator=(const MidiFifo&) = delete;
+
+    /**
+     * Queue a message stamped with the current time. samplePosition delays it
+     * by that many samples, so the events of one MIDI buffer keep their spacing.
+     * Returns false if dropped.
+     */
+    bool push(const uint8_t* data, size_t size, int samplePosition = 0);
+
+    /** Move the messages received before this call into buffer. Real-time safe. */
+    void readBlock(juce::MidiBuffer& buffer, int numSamples, double sampleRate);
+
+private:
+    struct Entry
+    {
+        double timeMs = 0.0;
+        int samplePosition = 0;
+        uint8_t size = 0;
+        uint8_t data[maxMessageSize] = {};
+    };
+
+    juce::AbstractFifo fifo_ { capacity };
+    std::vector<Entry> entries_;
+};
+
+}  // namespace juce_cmp
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "ParameterSlots.h"
+
+namespace juce_cmp
+{
+
+static_assert(std::atomic<float>::is_always_lock_free, "Parameter slots require lock-free float atomics");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Parameter slots require lock-free 64-bit atomics");
+
+void ParameterSlots::set(uint32_t index, float value)
+{
+    if (index >= maxParameters)
+        return;
+
+    // Value first, then the mark - drain() reads the value after clearing the mark
+    values_[index].store(value, std::memory_order_relaxed);
+    written_[index / 64].fetch_or(uint64_t(1) << (index % 64), std::memory_order_relaxed);
+    dirty_[index / 64].fetch_or(uint64_t(1) << (index % 64), std::memory_order_release);
+    pending_.store(true, std::memory_order_release);
+}
+
+bool ParameterSlots::hasPending() const
+{
+    return pending_.load(std::memory_order_acquire);
+}
+
+void ParameterSlots::drain(const DrainCallback& callback)
+{
+    // Cleared before scanning: a set() racing with the scan re-raises it
+    pending_.store(false, std::memory_order_seq_cst);
+
+    for (size_t word = 0; word < numWords; ++word)
+    {
+        uint64_t bits = dirty_[word].exchange(0, std::memory_order_seq_cst);
+        while (bits != 0)
+        {
+            int bit = __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            auto index = static_cast<uint32_t>(word * 64 + static_cast<size_t>(bit));
+            callback(index, values_[index].load(std::memory_order_relaxed));
+        }
+    }
+}
+
+void ParameterSlots::markAllDirty()
+{
+    for (size_t word = 0; word < numWords; ++word)
+        dirty_[word].fetch_or(written_[word].load(std::memory_order_relaxed), std::memory_order_release);
+    pending_.store(true, std::memory_order_release);
+}
+
+void ParameterSlots::markDirty(uint32_t index)
+{
+    if (index >= maxParameters)
+        return;
+
+    dirty_[index / 64].fetch_or(uint64_t(1) << (index % 64), std::memory_order_release);
+    pending_.store(true, std::memory_order_release);
+}
+
+}  // namespace juce_cmp
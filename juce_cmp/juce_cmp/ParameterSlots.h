@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace juce_cmp
+{
+
+/**
+ * ParameterSlots - Latest value per parameter, written from the audio thread.
+ *
+ * One float slot per parameter index plus a dirty bitmask. set() is wait-free
+ * and allocation-free, so it can be called from processBlock() or a host's
+ * parameter callback. A non-RT thread calls drain() to collect the values that
+ * changed since the last drain; intermediate values are skipped, the latest
+ * one always wins.
+ */
+class ParameterSlots
+{
+public:
+    /** Highest supported parameter count. Indices at or past this are ignored. */
+    static constexpr size_t maxParameters = 1024;
+
+    using DrainCallback = std::function<void(uint32_t index, float value)>;
+
+    ParameterSlots() = default;
+
+    // Non-copyable
+    ParameterSlots(const ParameterSlots&) = delete;
+    ParameterSlots& operator=(const ParameterSlots&) = delete;
+
+    /** Store a value and mark it dirty. Real-time safe. */
+    void set(uint32_t index, float value);
+
+    /** Check if any slot changed since the last drain. */
+    bool hasPending() const;
+
+    /** Call callback for every dirty slot with its latest value and clear the marks. */
+    void drain(const DrainCallback& callback);
+
+    /** Mark every slot that was ever set dirty again, so the next drain() resends it. */
+    void markAllDirty();
+
+    /** Mark one drained slot dirty again, e.g. when its value could not be sent. */
+    void markDirty(uint32_t index);
+
+private:
+    static constexpr size_t numWords = maxParameters / 64;
+
+    std::atomic<float> values_[maxParameters] = {};
+    std::atomic<uint64_t> dirty_[numWords] = {};
+    std::atomic<uint64_t> written_[numWords] = {};
+    std::atomic<bool> pending_ { false };
+};
+
+}  // namespace juce_cmp
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "SharedBlob.h"
+#include "ipc_protocol.h"
+
+#include <cstdio>
+#include <random>
+
+#if __APPLE__ || __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+namespace juce_cmp
+{
+
+SharedBlob::SharedBlob() = default;
+
+SharedBlob::~SharedBlob()
+{
+    release();
+}
+
+bool SharedBlob::create(size_t size)
+{
+#if __APPLE__ || __linux__
+    release();
+
+    if (size == 0 || size > BLOB_MAX_SIZE)
+        return false;
+
+    // Short name: macOS limits shm names to 31 characters
+    char name[32];
+    snprintf(name, sizeof(name), "/jcmb.%d.%u", getpid(), (unsigned)(std::random_device{}() & 0xFFFFFF));
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return false;
+
+    // Unlink right away - the child reaches the region through the passed fd
+    shm_unlink(name);
+
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    // Blobs travel over the socket, a relaunched child must not inherit them
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    base_ = base;
+    size_ = size;
+    fd_ = fd;
+    return true;
+#else
+    (void)size;
+    return false;
+#endif
+}
+
+void SharedBlob::release()
+{
+#if __APPLE__ || __linux__
+    if (fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+    }
+    if (base_ != nullptr)
+    {
+        munmap(base_, size_);
+        base_ = nullptr;
+    }
+#endif
+    size_ = 0;
+}
+
+}  // namespace juce_cmp
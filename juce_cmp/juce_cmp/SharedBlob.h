@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace juce_cmp
+{
+
+/**
+ * SharedBlob - Shared memory region for one large payload (host side).
+ *
+ * Samples, images or wavetables too large for a ValueTree message are written
+ * into a blob and then sent with Ipc::sendBlob(). Only an id, the size and the
+ * region's fd cross the socket (EVENT_TYPE_BLOB, fd via SCM_RIGHTS); the child
+ * maps the same pages, so the payload is never copied.
+ *
+ * The region is created with shm_open() and immediately unlinked. Each process
+ * holds its own mapping and the kernel frees the pages once the last one goes
+ * away, so the host may drop the blob as soon as it has been sent. Contents
+ * must not change after sending, the child reads them without synchronization.
+ */
+class SharedBlob
+{
+public:
+    SharedBlob();
+    ~SharedBlob();
+
+    // Non-copyable
+    SharedBlob(const SharedBlob&) = delete;
+    SharedBlob& operator=(const SharedBlob&) = delete;
+
+    /** Create and map a zero-filled region of size bytes (up to BLOB_MAX_SIZE). */
+    bool create(size_t size);
+
+    /** Unmap the region and close the fd. */
+    void release();
+
+    /** Check if the region is mapped. */
+    bool isValid() const { return base_ != nullptr; }
+
+    /** Writable contents, to be filled before sending. */
+    uint8_t* getData() const { return static_cast<uint8_t*>(base_); }
+    size_t getSize() const { return size_; }
+
+    /** File descriptor passed to the child on every send (-1 once released). */
+    int getFD() const { return fd_; }
+
+private:
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    int fd_ = -1;
+};
+
+}  // namespace juce_cmp
@@ -0,0 +1,271 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "SharedRing.h"
+#include "ipc_protocol.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <random>
+
+#if __APPLE__ || __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+namespace juce_cmp
+{
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Shared memory ring requires lock-free 32-bit atomics");
+
+SharedRing::SharedRing() = default;
+
+SharedRing::~SharedRing()
+{
+    release();
+}
+
+bool SharedRing::create(size_t capacity)
+{
+#if __APPLE__ || __linux__
+    release();
+
+    uint32_t cap = 1;
+    while (cap < capacity)
+        cap <<= 1;
+
+    // Short name: macOS limits shm names to 31 characters
+    char name[32];
+    snprintf(name, sizeof(name), "/jcmp.%d.%u", getpid(), (unsigned)(std::random_device{}() & 0xFFFFFF));
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return false;
+
+    // Unlink right away - the child reaches the region through the inherited fd
+    shm_unlink(name);
+
+    size_t size = SHM_RING_HEADER_SIZE + 2 * (SHM_RING_CONTROL_SIZE + (size_t)cap);
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    auto* bytes = static_cast<uint8_t*>(base);
+    memset(bytes, 0, SHM_RING_HEADER_SIZE + 2 * SHM_RING_CONTROL_SIZE + cap);
+
+    auto setupRing = [bytes](Ring& ring, size_t offset) {
+        uint8_t* control = bytes + offset;
+        ring.writePos = new (control + SHM_RING_WRITE_POS) std::atomic<uint32_t>(0);
+        ring.readPos = new (control + SHM_RING_READ_POS) std::atomic<uint32_t>(0);
+        ring.readerWaiting = new (control + SHM_RING_READER_WAITING) std::atomic<uint32_t>(0);
+        ring.writerWaiting = new (control + SHM_RING_WRITER_WAITING) std::atomic<uint32_t>(0);
+        ring.data = control + SHM_RING_CONTROL_SIZE;
+    };
+
+    setupRing(tx_, SHM_RING_HEADER_SIZE);
+    setupRing(rx_, SHM_RING_HEADER_SIZE + SHM_RING_CONTROL_SIZE + cap);
+
+    uint32_t header[3] = { SHM_RING_MAGIC, SHM_RING_VERSION, cap };
+    memcpy(bytes + SHM_RING_HEADER_MAGIC, &header[0], 4);
+    memcpy(bytes + SHM_RING_HEADER_VERSION, &header[1], 4);
+    memcpy(bytes + SHM_RING_HEADER_CAPACITY, &header[2], 4);
+
+    base_ = base;
+    size_ = size;
+    capacity_ = cap;
+    fd_ = fd;
+    return true;
+#else
+    (void)capacity;
+    return false;
+#endif
+}
+
+void SharedRing::release()
+{
+#if __APPLE__ || __linux__
+    closeFD();
+    if (base_ != nullptr)
+    {
+        munmap(base_, size_);
+        base_ = nullptr;
+    }
+#endif
+    size_ = 0;
+    capacity_ = 0;
+    tx_ = {};
+    rx_ = {};
+}
+
+void SharedRing::closeFD()
+{
+#if __APPLE__ || __linux__
+    if (fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+    }
+#endif
+}
+
+// =============================================================================
+// TX: Host → UI
+// =============================================================================
+
+bool SharedRing::write(const Chunk* chunks, size_t numChunks)
+{
+    if (base_ == nullptr)
+        return false;
+
+    size_t frameSize = 0;
+    for (size_t i = 0; i < numChunks; ++i)
+        frameSize += chunks[i].size;
+
+    size_t recordSize = SHM_RING_RECORD_HEADER_SIZE + frameSize;
+    if (frameSize == 0 || recordSize > capacity_)
+        return false;
+
+    uint32_t w = tx_.writePos->load(std::memory_order_relaxed);
+    uint32_t r = tx_.readPos->load(std::memory_order_acquire);
+    if (capacity_ - (w - r) < recordSize)
+        return false;  // Full - caller decides whether to drop
+
+    uint32_t length = static_cast<uint32_t>(frameSize);
+    copyIn(tx_, w, &length, sizeof(length));
+
+    uint32_t pos = w + SHM_RING_RECORD_HEADER_SIZE;
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        copyIn(tx_, pos, chunks[i].data, chunks[i].size);
+        pos += static_cast<uint32_t>(chunks[i].size);
+    }
+
+    // seq_cst pairs with the reader's waiting flag store in prepareWait()
+    tx_.writePos->store(w + static_cast<uint32_t>(recordSize), std::memory_order_seq_cst);
+    return true;
+}
+
+size_t SharedRing::getMaxMessageSize() const
+{
+    if (base_ == nullptr)
+        return 0;
+    return capacity_ - SHM_RING_RECORD_HEADER_SIZE;
+}
+
+void SharedRing::prepareWriterWait()
+{
+    if (base_ == nullptr)
+        return;
+
+    // Pairs with the child's fence between advancing the read position and checking the flag
+    tx_.writerWaiting->store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool SharedRing::takeReaderWaiting()
+{
+    if (base_ == nullptr)
+        return false;
+    return tx_.readerWaiting->exchange(0, std::memory_order_seq_cst) != 0;
+}
+
+// =============================================================================
+// RX: UI → Host
+// =============================================================================
+
+bool SharedRing::read(std::vector<uint8_t>& frame)
+{
+    if (base_ == nullptr)
+        return false;
+
+    uint32_t r = rx_.readPos->load(std::memory_order_relaxed);
+    uint32_t w = rx_.writePos->load(std::memory_order_acquire);
+    uint32_t available = w - r;
+    if (available < SHM_RING_RECORD_HEADER_SIZE)
+        return false;
+
+    uint32_t length = 0;
+    copyOut(rx_, r, &length, sizeof(length));
+    if (length == 0 || length > available - SHM_RING_RECORD_HEADER_SIZE)
+    {
+        // Corrupt record - discard everything written so far to resynchronize
+        rx_.readPos->store(w, std::memory_order_release);
+        return false;
+    }
+
+    frame.resize(length);
+    copyOut(rx_, r + SHM_RING_RECORD_HEADER_SIZE, frame.data(), length);
+
+    rx_.readPos->store(r + SHM_RING_RECORD_HEADER_SIZE + length, std::memory_order_release);
+    return true;
+}
+
+bool SharedRing::isReadable() const
+{
+    if (base_ == nullptr)
+        return false;
+    return rx_.writePos->load(std::memory_order_seq_cst) != rx_.readPos->load(std::memory_order_relaxed);
+}
+
+bool SharedRing::prepareWait()
+{
+    if (base_ == nullptr)
+        return true;
+
+    rx_.readerWaiting->store(1, std::memory_order_seq_cst);
+    if (isReadable())
+    {
+        rx_.readerWaiting->store(0, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool SharedRing::takeWriterWaiting()
+{
+    if (base_ == nullptr)
+        return false;
+
+    // Pairs with the writer setting the flag before it checks for room again
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (rx_.writerWaiting->load(std::memory_order_relaxed) == 0)
+        return false;
+    return rx_.writerWaiting->exchange(0, std::memory_order_seq_cst) != 0;
+}
+
+// =============================================================================
+// Wrap-around copies
+// =============================================================================
+
+void SharedRing::copyIn(Ring& ring, uint32_t pos, const void* src, size_t size)
+{
+    uint32_t offset = pos & (capacity_ - 1);
+    size_t first = std::min(size, (size_t)(capacity_ - offset));
+    memcpy(ring.data + offset, src, first);
+    if (first < size)
+        memcpy(ring.data, static_cast<const uint8_t*>(src) + first, size - first);
+}
+
+void SharedRing::copyOut(const Ring& ring, uint32_t pos, void* dst, size_t size) const
+{
+    uint32_t offset = pos & (capacity_ - 1);
+    size_t first = std::min(size, (size_t)(capacity_ - offset));
+    memcpy(dst, ring.data + offset, first);
+    if (first < size)
+        memcpy(static_cast<uint8_t*>(dst) + first, ring.data, size - first);
+}
+
+}  // namespace juce_cmp
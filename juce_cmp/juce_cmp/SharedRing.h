@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace juce_cmp
+{
+
+/**
+ * SharedRing - Pair of shared memory SPSC ring buffers (host side).
+ *
+ * Carries the same EVENT_TYPE_* messages as the socket without a syscall
+ * per message. The socket is kept for EVENT_TYPE_RING wakeups and for
+ * liveness (EOF when either side goes away).
+ *
+ * - TX ring (host → UI): written by the host, read by the child
+ * - RX ring (UI → host): written by the child, read by the host
+ *
+ * The region is created with shm_open() and immediately unlinked, so the
+ * only way to reach it is through the fd inherited by the child.
+ * See ipc_protocol.h for the memory layout.
+ */
+class SharedRing
+{
+public:
+    /** Default data bytes per ring direction. Fits the largest JUCE event. */
+    static constexpr size_t defaultCapacity = 2 * 1024 * 1024;
+
+    /** A piece of a message, so frames can be written without assembling them first. */
+    struct Chunk
+    {
+        const void* data;
+        size_t size;
+    };
+
+    SharedRing();
+    ~SharedRing();
+
+    // Non-copyable
+    SharedRing(const SharedRing&) = delete;
+    SharedRing& operator=(const SharedRing&) = delete;
+
+    /** Create and map the region. capacity is rounded up to a power of two. */
+    bool create(size_t capacity = defaultCapacity);
+
+    /** Unmap the region and close the fd if still open. */
+    void release();
+
+    /** Check if the region is mapped. */
+    bool isValid() const { return base_ != nullptr; }
+
+    /** File descriptor for the child to inherit (-1 once closed). */
+    int getFD() const { return fd_; }
+
+    /** Close the fd after the child has been spawned. The mapping stays valid. */
+    void closeFD();
+
+    // TX ring (host → UI)
+
+    /**
+     * Write one message made of the given chunks as a single record.
+     * All-or-nothing: returns false without writing if there is not enough room.
+     * Not thread-safe; callers must serialize writes.
+     */
+    bool write(const Chunk* chunks, size_t numChunks);
+
+    /**
+     * Announce that the writer is about to wait for room. The child sends a RING
+     * wakeup once it has read from the ring; try write() again before waiting.
+     */
+    void prepareWriterWait();
+
+    /** Returns true (and clears the flag) if the child is sleeping and needs a wakeup. */
+    bool takeReaderWaiting();
+
+    /** Largest message write() can ever accept, even into an empty ring (0 if not mapped). */
+    size_t getMaxMessageSize() const;
+
+    // RX ring (UI → host)
+
+    /** Pop one message into frame. Returns false if the ring is empty or corrupt. */
+    bool read(std::vector<uint8_t>& frame);
+
+    /** Check if the RX ring has unread data. */
+    bool isReadable() const;
+
+    /**
+     * Announce that the reader is about to sleep on the socket.
+     * Returns false if data arrived meanwhile, in which case the reader must not sleep.
+     */
+    bool prepareWait();
+
+    /** Returns true (and clears the flag) if the child waits for room in the RX ring and needs a wakeup. */
+    bool takeWriterWaiting();
+
+private:
+    struct Ring
+    {
+        std::atomic<uint32_t>* writePos = nullptr;
+        std::atomic<uint32_t>* readPos = nullptr;
+        std::atomic<uint32_t>* readerWaiting = nullptr;
+        std::atomic<uint32_t>* writerWaiting = nullptr;
+        uint8_t* data = nullptr;
+    };
+
+    void copyIn(Ring& ring, uint32_t pos, const void* src, size_t size);
+    void copyOut(const Ring& ring, uint32_t pos, void* dst, size_t size) const;
+
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    uint32_t capacity_ = 0;
+    int fd_ = -1;
+    Ring tx_;
+    Ring rx_;
+};
+
+}  // namespace juce_cmp
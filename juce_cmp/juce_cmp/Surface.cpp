@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "Surface.h"
+
+// Platform buffers are created in Surface.mm (IOSurface) and Surface_linux.cpp (DMA-BUF)
+
+namespace juce_cmp
+{
+
+Surface::Surface() = default;
+
+Surface::~Surface()
+{
+    release();
+    releaseSnapshot();
+#if __linux__
+    closeDevice();
+#endif
+}
+
+bool Surface::create(int width, int height, int numBuffers)
+{
+    release();
+
+    if (numBuffers < 1 || numBuffers > SWAP_CHAIN_MAX_BUFFERS)
+        return false;
+
+    numBuffers_ = numBuffers;
+    if (!createChain(current_, width, height))
+    {
+        numBuffers_ = 0;
+        return false;
+    }
+
+    width_ = width;
+    height_ = height;
+    return true;
+}
+
+bool Surface::resize(int width, int height)
+{
+    if (numBuffers_ == 0)
+        return false;
+
+    auto allocate = [](int size) { return (size + sizeBucket - 1) / sizeBucket * sizeBucket + sizeBucket; };
+    width = allocate(width);
+    height = allocate(height);
+
+    Chain chain;
+    if (!createChain(chain, width, height))
+        return false;
+
+    // Keep previous chain alive - view may still be displaying it
+    releaseChain(previous_);
+    previous_ = current_;
+    current_ = chain;
+
+    width_ = width;
+    height_ = height;
+    return true;
+}
+
+void Surface::release()
+{
+    releaseChain(previous_);
+    releaseChain(current_);
+    numBuffers_ = 0;
+    width_ = 0;
+    height_ = 0;
+}
+
+bool Surface::isValid() const
+{
+    return current_.buffers[0] != nullptr;
+}
+
+bool Surface::canHold(int width, int height) const
+{
+    return isValid() && width <= width_ && height <= height_;
+}
+
+bool Surface::isOversized(int width, int height) const
+{
+    return width_ - width > 2 * sizeBucket || height_ - height > 2 * sizeBucket;
+}
+
+void* Surface::getNativeHandle(int index) const
+{
+    if (index < 0 || index >= numBuffers_)
+        return nullptr;
+    return current_.buffers[index];
+}
+
+void* Surface::findBuffer(uint8_t generation, int index) const
+{
+    if (index < 0 || index >= numBuffers_)
+        return nullptr;
+    if (current_.buffers[0] != nullptr && generation == current_.generation)
+        return current_.buffers[index];
+    if (previous_.buffers[0] != nullptr && generation == previous_.generation)
+        return previous_.buffers[index];
+    return nullptr;
+}
+
+}  // namespace juce_cmp
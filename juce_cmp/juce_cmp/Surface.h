@@ -4,17 +4,29 @@
 #pragma once
 
 #include <cstdint>
+#include "ipc_protocol.h"
 
 namespace juce_cmp
 {
 
 /**
- * Surface - Manages shared GPU surfaces for cross-process rendering.
+ * Surface - Manages a swap chain of shared GPU surfaces for cross-process rendering.
+ *
+ * The child renders into one buffer while the host displays another, and
+ * reports each completed buffer (CMP_EVENT_BUFFER_READY). Every create() or
+ * resize() starts a new generation; the previous chain is kept alive until
+ * the next resize because the view may still be displaying it.
+ *
+ * resize() over-allocates in sizeBucket steps, so the content can be smaller
+ * than the buffers: the child renders into their top-left corner and the
+ * view clips the rest. Most live resizes then need no new chain at all.
  *
  * On macOS: Uses IOSurface for zero-copy GPU sharing.
  *           Surfaces are shared via Mach port IPC (see MachPort.h).
  * On Windows: Will use DXGI shared textures (TODO)
- * On Linux: Will use DMA-BUF file descriptors (TODO)
+ * On Linux: Uses GBM buffers on the first DRM render node, exported as DMA-BUF
+ *           file descriptors and passed over the socket (CMP_EVENT_SWAP_CHAIN).
+ *           Buffer handles point to a DmaBuffer.
  */
 class Surface
 {
@@ -26,38 +38,121 @@ public:
     Surface(const Surface&) = delete;
     Surface& operator=(const Surface&) = delete;
 
-    /** Create a shared surface with the given dimensions. Returns true on success. */
-    bool create(int width, int height);
+#if __linux__
+    /** A GBM buffer and its DMA-BUF export (Linux). */
+    struct DmaBuffer
+    {
+        void* bo = nullptr;  // gbm_bo
+        int fd = -1;
+        int width = 0;
+        int height = 0;
+        uint32_t stride = 0;
+        uint32_t offset = 0;
+        uint32_t format = DMABUF_FORMAT_ARGB8888;
+        uint64_t modifier = DMABUF_MODIFIER_INVALID;
+        uint64_t serial = 0;  // Unique per Surface, so views can cache imports
+    };
+#endif
+
+    /** Create a swap chain with the given dimensions. Returns true on success. */
+    bool create(int width, int height, int numBuffers = SWAP_CHAIN_BUFFER_COUNT);
 
-    /** Resize the surface. Returns true on success. */
+    /** Over-allocation step of resize(), in pixels. */
+    static constexpr int sizeBucket = 256;
+
+    /**
+     * Recreate the swap chain for content of at least width x height, rounded
+     * up to the next sizeBucket plus one bucket of headroom. Returns true on success.
+     */
     bool resize(int width, int height);
 
-    /** Release the surface. */
+    /** Check if the current chain holds content of width x height. */
+    bool canHold(int width, int height) const;
+
+    /** Check if the current chain is more than two buckets larger than width x height. */
+    bool isOversized(int width, int height) const;
+
+    /** Release all surfaces. */
     void release();
 
     /** Check if surface is valid. */
     bool isValid() const;
 
+    /** Number of buffers in the chain. */
+    int getBufferCount() const { return numBuffers_; }
+
+    /** Generation of the current chain (wraps at 256). */
+    uint8_t getGeneration() const { return generation_; }
+
+#if __APPLE__
     /**
-     * Create a Mach port for the surface (macOS only).
+     * Create a Mach port for a buffer of the current chain (macOS only).
      * Used for sharing IOSurface via Mach IPC without kIOSurfaceIsGlobal.
      * Caller must deallocate the port with mach_port_deallocate().
      * Returns 0 on failure.
      */
-    uint32_t createMachPort() const;
+    uint32_t createMachPort(int index) const;
+#endif
 
-    /** Get the native surface handle (IOSurfaceRef on macOS). */
-    void* getNativeHandle() const;
+    /** Get the native surface handle of a current buffer (IOSurfaceRef on macOS, DmaBuffer* on Linux). */
+    void* getNativeHandle(int index = 0) const;
 
-    /** Get current dimensions. */
+    /**
+     * Look up a buffer by generation, in the current or the previous chain.
+     * Returns nullptr for unknown generations or indices.
+     */
+    void* findBuffer(uint8_t generation, int index) const;
+
+    /**
+     * Copy a buffer (looked up as in findBuffer()) into a snapshot surface
+     * owned by this object. The snapshot survives release() and replaces the
+     * previous one, so a new view can show the last frame before the child
+     * renders again.
+     */
+    bool captureSnapshot(uint8_t generation, int index);
+
+    /** Get the snapshot surface (IOSurfaceRef on macOS, DmaBuffer* on Linux), or nullptr. */
+    void* getSnapshot() const { return snapshot_; }
+
+    /** Release the snapshot surface. */
+    void releaseSnapshot();
+
+    /**
+     * Copy the top-left width x height BGRA pixels of a buffer (looked up as
+     * in findBuffer()) to dst, clamped to the buffer size. Returns true on success.
+     */
+    bool readPixels(uint8_t generation, int index, void* dst, int dstStride, int width, int height) const;
+
+    /** Get the dimensions of the current buffers, which may exceed the content. */
     int getWidth() const { return width_; }
     int getHeight() const { return height_; }
 
 private:
-#if __APPLE__
-    void* surface_ = nullptr;          // IOSurfaceRef
-    void* previousSurface_ = nullptr;  // Keep alive during resize transition
+    struct Chain
+    {
+        void* buffers[SWAP_CHAIN_MAX_BUFFERS] = {};  // IOSurfaceRef or DmaBuffer*
+        uint8_t generation = 0;
+    };
+
+    bool createChain(Chain& chain, int width, int height);
+    void releaseChain(Chain& chain);
+
+#if __linux__
+    bool openDevice();
+    void closeDevice();
+    DmaBuffer* createBuffer(int width, int height, bool linear);
+    static void releaseBuffer(DmaBuffer* buffer);
+
+    void* device_ = nullptr;  // gbm_device, opened on first use
+    int deviceFD_ = -1;
+    uint64_t nextSerial_ = 0;
 #endif
+
+    Chain current_;
+    Chain previous_;  // Keep alive during resize transition
+    void* snapshot_ = nullptr;  // IOSurfaceRef or DmaBuffer*, not part of any chain
+    int numBuffers_ = 0;
+    uint8_t generation_ = 0;
     int width_ = 0;
     int height_ = 0;
 };
@@ -3,6 +3,9 @@
 
 #include "Surface.h"
 
+#include <algorithm>
+#include <cstring>
+
 #if __APPLE__
 #import <Foundation/Foundation.h>
 #import <IOSurface/IOSurface.h>
@@ -11,22 +14,26 @@
 namespace juce_cmp
 {
 
-Surface::Surface() = default;
-
-Surface::~Surface()
+#if __APPLE__
+uint32_t Surface::createMachPort(int index) const
 {
-    release();
+    void* surface = getNativeHandle(index);
+    if (surface == nullptr)
+        return 0;
+    mach_port_t port = IOSurfaceCreateMachPort((IOSurfaceRef)surface);
+    return (uint32_t)port;
 }
+#endif
 
-bool Surface::create(int width, int height)
+bool Surface::captureSnapshot(uint8_t generation, int index)
 {
 #if __APPLE__
-    release();
+    auto source = (IOSurfaceRef)findBuffer(generation, index);
+    if (source == nullptr)
+        return false;
 
-    width_ = width;
-    height_ = height;
-
-    // Initial surface: No kIOSurfaceIsGlobal needed - Mach port is passed via bootstrap IPC
+    size_t width = IOSurfaceGetWidth(source);
+    size_t height = IOSurfaceGetHeight(source);
     NSDictionary* props = @{
         (id)kIOSurfaceWidth: @(width),
         (id)kIOSurfaceHeight: @(height),
@@ -34,22 +41,77 @@ bool Surface::create(int width, int height)
         (id)kIOSurfacePixelFormat: @((uint32_t)'BGRA')
     };
 
-    surface_ = IOSurfaceCreate((__bridge CFDictionaryRef)props);
-    return surface_ != nullptr;
+    IOSurfaceRef snapshot = IOSurfaceCreate((__bridge CFDictionaryRef)props);
+    if (snapshot == nullptr)
+        return false;
+
+    // One CPU copy per detach; the child is not rendering into its chain anymore
+    IOSurfaceLock(source, kIOSurfaceLockReadOnly, nullptr);
+    IOSurfaceLock(snapshot, 0, nullptr);
+
+    auto* src = static_cast<const uint8_t*>(IOSurfaceGetBaseAddress(source));
+    auto* dst = static_cast<uint8_t*>(IOSurfaceGetBaseAddress(snapshot));
+    size_t srcStride = IOSurfaceGetBytesPerRow(source);
+    size_t dstStride = IOSurfaceGetBytesPerRow(snapshot);
+    for (size_t y = 0; y < height; ++y)
+        memcpy(dst + y * dstStride, src + y * srcStride, width * 4);
+
+    IOSurfaceUnlock(snapshot, 0, nullptr);
+    IOSurfaceUnlock(source, kIOSurfaceLockReadOnly, nullptr);
+
+    releaseSnapshot();
+    snapshot_ = snapshot;
+    return true;
+#else
+    (void)generation;
+    (void)index;
+    return false;
+#endif
+}
+
+bool Surface::readPixels(uint8_t generation, int index, void* dst, int dstStride, int width, int height) const
+{
+#if __APPLE__
+    auto source = (IOSurfaceRef)findBuffer(generation, index);
+    if (source == nullptr || dst == nullptr)
+        return false;
+
+    size_t rowWidth = std::min(static_cast<size_t>(std::max(width, 0)), IOSurfaceGetWidth(source));
+    size_t rows = std::min(static_cast<size_t>(std::max(height, 0)), IOSurfaceGetHeight(source));
+
+    IOSurfaceLock(source, kIOSurfaceLockReadOnly, nullptr);
+
+    auto* src = static_cast<const uint8_t*>(IOSurfaceGetBaseAddress(source));
+    size_t srcStride = IOSurfaceGetBytesPerRow(source);
+    for (size_t y = 0; y < rows; ++y)
+        memcpy(static_cast<uint8_t*>(dst) + y * static_cast<size_t>(dstStride), src + y * srcStride, rowWidth * 4);
+
+    IOSurfaceUnlock(source, kIOSurfaceLockReadOnly, nullptr);
+    return true;
 #else
+    (void)generation;
+    (void)index;
+    (void)dst;
+    (void)dstStride;
     (void)width;
     (void)height;
     return false;
 #endif
 }
 
-bool Surface::resize(int width, int height)
+void Surface::releaseSnapshot()
 {
 #if __APPLE__
-    width_ = width;
-    height_ = height;
+    if (snapshot_ != nullptr)
+        CFRelease((IOSurfaceRef)snapshot_);
+#endif
+    snapshot_ = nullptr;
+}
 
-    // No kIOSurfaceIsGlobal - surface is shared via Mach port IPC
+bool Surface::createChain(Chain& chain, int width, int height)
+{
+#if __APPLE__
+    // No kIOSurfaceIsGlobal - surfaces are shared via Mach port IPC
     NSDictionary* props = @{
         (id)kIOSurfaceWidth: @(width),
         (id)kIOSurfaceHeight: @(height),
@@ -57,62 +119,39 @@ bool Surface::resize(int width, int height)
         (id)kIOSurfacePixelFormat: @((uint32_t)'BGRA')
     };
 
-    IOSurfaceRef newSurface = IOSurfaceCreate((__bridge CFDictionaryRef)props);
-    if (newSurface != nullptr)
+    for (int i = 0; i < numBuffers_; ++i)
     {
-        // Keep previous surface alive - view may still be displaying it
-        if (previousSurface_ != nullptr)
-            CFRelease((IOSurfaceRef)previousSurface_);
-        previousSurface_ = surface_;
-        surface_ = newSurface;
-        return true;
+        chain.buffers[i] = IOSurfaceCreate((__bridge CFDictionaryRef)props);
+        if (chain.buffers[i] == nullptr)
+        {
+            releaseChain(chain);
+            return false;
+        }
     }
-    return false;
+
+    chain.generation = ++generation_;
+    return true;
 #else
+    (void)chain;
     (void)width;
     (void)height;
     return false;
 #endif
 }
 
-void Surface::release()
+void Surface::releaseChain(Chain& chain)
 {
 #if __APPLE__
-    if (previousSurface_ != nullptr)
+    for (auto& buffer : chain.buffers)
     {
-        CFRelease((IOSurfaceRef)previousSurface_);
-        previousSurface_ = nullptr;
+        if (buffer != nullptr)
+        {
+            CFRelease((IOSurfaceRef)buffer);
+            buffer = nullptr;
+        }
     }
-    if (surface_ != nullptr)
-    {
-        CFRelease((IOSurfaceRef)surface_);
-        surface_ = nullptr;
-    }
-#endif
-    width_ = 0;
-    height_ = 0;
-}
-
-bool Surface::isValid() const
-{
-    return surface_ != nullptr;
-}
-
-uint32_t Surface::createMachPort() const
-{
-#if __APPLE__
-    if (surface_ == nullptr)
-        return 0;
-    mach_port_t port = IOSurfaceCreateMachPort((IOSurfaceRef)surface_);
-    return (uint32_t)port;
-#else
-    return 0;
 #endif
-}
-
-void* Surface::getNativeHandle() const
-{
-    return surface_;
+    chain = {};
 }
 
 }  // namespace juce_cmp
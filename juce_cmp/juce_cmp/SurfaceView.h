@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <string>
 
 namespace juce_cmp
 {
@@ -14,7 +15,8 @@ namespace juce_cmp
  *
  * On macOS: NSView with CALayer for IOSurface display
  * On Windows: Will use HWND with Direct3D (TODO)
- * On Linux: Will use X11/Wayland with Vulkan (TODO)
+ * On Linux: X11 child window showing DMA-BUFs as DRI3 pixmaps, flipped with
+ *           Present (Wayland hosts run plugins under XWayland)
  *
  * This is a C++ wrapper around the platform-native view.
  */
@@ -23,6 +25,19 @@ class SurfaceView
 public:
     using ResizeCallback = std::function<void(int width, int height)>;
 
+    /** Called on the message thread after a flip, with the time until it reaches the display. */
+    using PresentCallback = std::function<void(double displayDelayMs)>;
+
+    /**
+     * Called on the message thread at a display refresh requested with requestVsync().
+     * A buffer set pending before deadlineNanos is shown at presentNanos. Both are
+     * system monotonic clock nanoseconds (mach_absolute_time, CLOCK_MONOTONIC).
+     */
+    using VsyncCallback = std::function<void(uint64_t deadlineNanos, uint64_t presentNanos)>;
+
+    /** Called on the message thread when the view is shown, or hidden (occluded, minimized, hidden by the host). */
+    using VisibilityCallback = std::function<void(bool visible)>;
+
     SurfaceView();
     ~SurfaceView();
 
@@ -39,7 +54,7 @@ public:
     /** Check if view is valid. */
     bool isValid() const;
 
-    /** Get the native view handle (NSView* on macOS). */
+    /** Get the native view handle (NSView* on macOS, the X11 window's SurfaceViewImpl* on Linux). */
     void* getNativeHandle() const { return nativeView_; }
 
     /** Set the surface to display. */
@@ -63,12 +78,30 @@ public:
     /** Set callback for resize requests from the view. */
     void setResizeCallback(ResizeCallback callback) { resizeCallback_ = callback; }
 
+    /** Set callback for presented frames. */
+    void setPresentCallback(PresentCallback callback) { presentCallback_ = callback; }
+
+    /** Set callback for visibility changes. */
+    void setVisibilityCallback(VisibilityCallback callback) { visibilityCallback_ = callback; }
+
+    /** Set callback for requested display refreshes. */
+    void setVsyncCallback(VsyncCallback callback) { vsyncCallback_ = callback; }
+
+    /** Call the VsyncCallback once, on the next display refresh while the view is shown. */
+    void requestVsync();
+
+    /** Show text over the top-left corner of the surface. Empty hides it. */
+    void setOverlayText(const std::string& text);
+
     /** Get backing scale factor for a native view (e.g., 2.0 for Retina). */
     static float getBackingScaleForView(void* nativeView);
 
 private:
     void* nativeView_ = nullptr;
     ResizeCallback resizeCallback_;
+    PresentCallback presentCallback_;
+    VisibilityCallback visibilityCallback_;
+    VsyncCallback vsyncCallback_;
 };
 
 }  // namespace juce_cmp
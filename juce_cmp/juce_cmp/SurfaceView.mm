@@ -17,7 +17,11 @@
  * SurfaceViewImpl - NSView that displays IOSurface content via CALayer.
  *
  * This view is purely for display - it never accepts input events.
- * Uses CADisplayLink to trigger layer refresh on each vsync.
+ * Uses CADisplayLink to flip to the latest completed buffer on vsync. The
+ * link only runs while a flip or a vsync for the child is pending, so an idle
+ * UI costs no wakeups.
+ * Watches its window's occlusion and minimization to report when nothing of
+ * the view can be seen.
  */
 @interface SurfaceViewImpl : NSView
 
@@ -26,9 +30,19 @@
 @property (nonatomic, assign) CGFloat backingScale;
 @property (nonatomic, retain) CADisplayLink *displayLink;
 @property (nonatomic, copy) void (^resizeCallback)(NSSize size);
+@property (nonatomic, copy) void (^presentCallback)(double displayDelayMs);
+@property (nonatomic, copy) void (^visibilityCallback)(BOOL visible);
+@property (nonatomic, copy) void (^vsyncCallback)(uint64_t deadlineNanos, uint64_t presentNanos);
+@property (nonatomic, assign) BOOL vsyncRequested;
+@property (nonatomic, assign) BOOL shown;
+@property (nonatomic, retain) CATextLayer *overlayLayer;
 
 - (void)displayLinkFired:(CADisplayLink*)link;
 - (void)requestResize:(NSSize)newSize;
+- (void)updateDisplayLinkState;
+- (void)updateVisibility;
+- (void)requestVsync;
+- (void)setOverlayText:(NSString*)text;
 
 @end
 
@@ -39,21 +53,30 @@
     if (self) {
         self.wantsLayer = YES;
         self.backingScale = 1.0;
-        // Anchor content to top-left corner during resize transitions
+        self.shown = NO;  // Until it moves to a window
+        // Anchor content to top-left corner during resize transitions, and clip
+        // the unused part of an over-allocated surface (Surface::sizeBucket)
         self.layer.contentsGravity = kCAGravityTopLeft;
+        self.layer.masksToBounds = YES;
 
         _displayLink = [self.window.screen displayLinkWithTarget:self selector:@selector(displayLinkFired:)];
         if (!_displayLink) {
             _displayLink = [NSScreen.mainScreen displayLinkWithTarget:self selector:@selector(displayLinkFired:)];
         }
         [_displayLink addToRunLoop:NSRunLoop.mainRunLoop forMode:NSRunLoopCommonModes];
+        _displayLink.paused = YES;
     }
     return self;
 }
 
 - (void)dealloc {
+    [NSNotificationCenter.defaultCenter removeObserver:self];
     [_displayLink invalidate];
     [_displayLink release];
+    [_presentCallback release];
+    [_visibilityCallback release];
+    [_vsyncCallback release];
+    [_overlayLayer release];
     [super dealloc];
 }
 
@@ -74,12 +97,76 @@
     [self.layer setNeedsDisplay];
 }
 
+- (void)setPendingSurface:(IOSurfaceRef)surface {
+    _pendingSurface = surface;
+    [self updateDisplayLinkState];
+}
+
+- (void)updateDisplayLinkState {
+    _displayLink.paused = (!self.shown || (_pendingSurface == nil && !_vsyncRequested));
+}
+
+- (void)requestVsync {
+    self.vsyncRequested = YES;
+    [self updateDisplayLinkState];
+}
+
+- (void)updateVisibility {
+    NSWindow* window = self.window;
+    BOOL shown = window != nil && !self.isHiddenOrHasHiddenAncestor && !window.miniaturized
+              && (window.occlusionState & NSWindowOcclusionStateVisible) != 0;
+
+    if (shown != self.shown) {
+        self.shown = shown;
+        if (self.visibilityCallback) {
+            self.visibilityCallback(shown);
+        }
+    }
+    [self updateDisplayLinkState];
+}
+
+- (void)windowVisibilityChanged:(NSNotification*)notification {
+    (void)notification;
+    [self updateVisibility];
+}
+
 - (void)requestResize:(NSSize)newSize {
     if (newSize.width > 0 && newSize.height > 0 && self.resizeCallback) {
         self.resizeCallback(newSize);
     }
 }
 
+- (void)setOverlayText:(NSString*)text {
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+
+    if (text.length == 0) {
+        [self.overlayLayer removeFromSuperlayer];
+        self.overlayLayer = nil;
+    } else {
+        NSFont* font = [NSFont fontWithName:@"Menlo" size:11] ?: [NSFont monospacedSystemFontOfSize:11 weight:NSFontWeightRegular];
+        if (!self.overlayLayer) {
+            CATextLayer* layer = [CATextLayer layer];
+            layer.font = (__bridge CFTypeRef)font;
+            layer.fontSize = font.pointSize;
+            layer.foregroundColor = NSColor.whiteColor.CGColor;
+            layer.backgroundColor = [NSColor colorWithWhite:0.0 alpha:0.6].CGColor;
+            [self.layer addSublayer:layer];
+            self.overlayLayer = layer;
+        }
+
+        // Layer-backed NSView layers are not flipped - y grows upwards
+        NSSize size = [text sizeWithAttributes:@{ NSFontAttributeName: font }];
+        CGFloat width = ceil(size.width) + 4.0;
+        CGFloat height = ceil(size.height) + 2.0;
+        self.overlayLayer.contentsScale = self.backingScale;
+        self.overlayLayer.string = text;
+        self.overlayLayer.frame = CGRectMake(4.0, self.bounds.size.height - height - 4.0, width, height);
+    }
+
+    [CATransaction commit];
+}
+
 - (NSView*)hitTest:(NSPoint)point {
     (void)point;
     return nil;
@@ -94,29 +181,60 @@
     return NO;
 }
 
+- (void)viewWillMoveToWindow:(NSWindow*)newWindow {
+    [super viewWillMoveToWindow:newWindow];
+
+    NSNotificationCenter* center = NSNotificationCenter.defaultCenter;
+    NSArray* names = @[ NSWindowDidChangeOcclusionStateNotification,
+                        NSWindowDidMiniaturizeNotification,
+                        NSWindowDidDeminiaturizeNotification ];
+    for (NSNotificationName name in names) {
+        if (self.window) {
+            [center removeObserver:self name:name object:self.window];
+        }
+        if (newWindow) {
+            [center addObserver:self selector:@selector(windowVisibilityChanged:) name:name object:newWindow];
+        }
+    }
+}
+
 - (void)viewDidMoveToWindow {
     [super viewDidMoveToWindow];
-    _displayLink.paused = (self.window == nil);
+    [self updateVisibility];
 }
 
 - (void)viewDidHide {
     [super viewDidHide];
-    _displayLink.paused = YES;
+    [self updateVisibility];
 }
 
 - (void)viewDidUnhide {
     [super viewDidUnhide];
-    _displayLink.paused = NO;
+    [self updateVisibility];
 }
 
 - (void)displayLinkFired:(CADisplayLink*)link {
-    (void)link;
+    // Only completed buffers get here (BUFFER_READY), so the layer is marked
+    // dirty once per child frame and never while the UI is idle
     if (self.pendingSurface) {
         self.surface = self.pendingSurface;
         self.pendingSurface = nil;
+        if (self.presentCallback) {
+            self.presentCallback((link.targetTimestamp - CACurrentMediaTime()) * 1000.0);
+        }
     }
-    // Always refresh to show latest IOSurface content (child renders continuously)
-    [self.layer setNeedsDisplay];
+
+    // Media time is mach_absolute_time in seconds. A buffer pending by the next
+    // callback (about targetTimestamp) is flipped there and shown a period later
+    if (self.vsyncRequested) {
+        self.vsyncRequested = NO;
+        if (self.vsyncCallback) {
+            CFTimeInterval period = link.targetTimestamp - link.timestamp;
+            self.vsyncCallback(static_cast<uint64_t>(link.targetTimestamp * 1e9),
+                               static_cast<uint64_t>((link.targetTimestamp + period) * 1e9));
+        }
+    }
+    [self updateDisplayLinkState];
 }
 
 @end
@@ -140,6 +258,19 @@ bool SurfaceView::create()
         return true;
 
     SurfaceViewImpl* view = [[SurfaceViewImpl alloc] initWithFrame:NSZeroRect];
+    SurfaceView* owner = this;
+    view.presentCallback = ^(double displayDelayMs) {
+        if (owner->presentCallback_)
+            owner->presentCallback_(displayDelayMs);
+    };
+    view.visibilityCallback = ^(BOOL visible) {
+        if (owner->visibilityCallback_)
+            owner->visibilityCallback_(visible);
+    };
+    view.vsyncCallback = ^(uint64_t deadlineNanos, uint64_t presentNanos) {
+        if (owner->vsyncCallback_)
+            owner->vsyncCallback_(deadlineNanos, presentNanos);
+    };
     nativeView_ = (void*)view;
     return true;
 #else
@@ -153,6 +284,9 @@ void SurfaceView::destroy()
     if (nativeView_)
     {
         SurfaceViewImpl* view = (__bridge SurfaceViewImpl*)nativeView_;
+        view.presentCallback = nil;
+        view.visibilityCallback = nil;
+        view.vsyncCallback = nil;
         [view removeFromSuperview];
         CFRelease(nativeView_);
         nativeView_ = nullptr;
@@ -191,6 +325,17 @@ void SurfaceView::setPendingSurface(void* surface)
 #endif
 }
 
+void SurfaceView::requestVsync()
+{
+#if __APPLE__
+    if (nativeView_)
+    {
+        SurfaceViewImpl* view = (__bridge SurfaceViewImpl*)nativeView_;
+        [view requestVsync];
+    }
+#endif
+}
+
 void SurfaceView::setBackingScale(float scale)
 {
 #if __APPLE__
@@ -204,6 +349,19 @@ void SurfaceView::setBackingScale(float scale)
 #endif
 }
 
+void SurfaceView::setOverlayText(const std::string& text)
+{
+#if __APPLE__
+    if (nativeView_)
+    {
+        SurfaceViewImpl* view = (__bridge SurfaceViewImpl*)nativeView_;
+        [view setOverlayText:[NSString stringWithUTF8String:text.c_str()]];
+    }
+#else
+    (void)text;
+#endif
+}
+
 void SurfaceView::attachToParent(void* parentView)
 {
 #if __APPLE__
@@ -0,0 +1,595 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "SurfaceView.h"
+#include "Surface.h"
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <xcb/xcb.h>
+#include <xcb/dri3.h>
+#include <xcb/present.h>
+
+namespace juce_cmp
+{
+
+/**
+ * SurfaceViewImpl - X11 child window that displays DMA-BUF content.
+ *
+ * This window is purely for display - it selects no input events, so the X
+ * server delivers them to the plugin window underneath. Buffers are imported
+ * once as DRI3 pixmaps and flipped with Present, so the X server scans out or
+ * blits them on the GPU. Like the display link on macOS, one flip is in
+ * flight at a time and only the latest completed buffer waits for the next.
+ * Reports itself hidden while unmapped, fully obscured, or while the
+ * top-level window it lives in is unmapped (minimized). Vsyncs for the child
+ * are MSC notifications, estimating the refresh period from their timestamps.
+ *
+ * Uses its own X connection, serviced from the JUCE message thread.
+ */
+struct SurfaceViewImpl
+{
+    // Current and previous chain plus the snapshot
+    static constexpr size_t maxImports = 2 * SWAP_CHAIN_MAX_BUFFERS + 1;
+
+    struct Import
+    {
+        uint64_t serial = 0;
+        xcb_pixmap_t pixmap = 0;
+    };
+
+    bool create();
+    void destroy();
+
+    xcb_pixmap_t import(const Surface::DmaBuffer* buffer);
+    void present(xcb_pixmap_t pixmap, bool notify);
+    void scheduleVsync();
+    void updateRefreshPeriod(uint64_t ust, uint64_t msc);
+    void dispatchEvents();
+    void setOverlayText(const std::string& text);
+    void drawOverlay();
+    void watchTopLevel(xcb_window_t parent);
+    void updateVisibility();
+
+    xcb_connection_t* connection = nullptr;
+    xcb_screen_t* screen = nullptr;
+    xcb_window_t window = 0;
+    xcb_window_t overlay = 0;
+    xcb_gcontext_t gc = 0;
+    xcb_font_t font = 0;
+    uint8_t presentOpcode = 0;
+    bool modifiers = false;  // DRI3 1.2, pixmaps from buffers with format modifiers
+    int charWidth = 6;
+    int ascent = 11;
+    int lineHeight = 13;
+
+    std::vector<Import> imports;
+    xcb_pixmap_t displayed = 0;
+    xcb_pixmap_t pending = 0;
+    bool presenting = false;
+    bool notifyPresent = false;
+    uint32_t presentSerial = 0;
+    float backingScale = 1.0f;
+    std::vector<std::string> overlayLines;
+    std::function<void(double displayDelayMs)> presentCallback;
+
+    bool vsyncRequested = false;
+    bool vsyncQueued = false;  // MSC notification in flight
+    uint32_t vsyncSerial = 0;
+    uint64_t lastUst = 0;
+    uint64_t lastMsc = 0;
+    uint64_t refreshNanos = 16666667;
+    std::function<void(uint64_t deadlineNanos, uint64_t presentNanos)> vsyncCallback;
+
+    xcb_window_t topLevel = 0;
+    bool mapped = false;
+    bool topLevelMapped = true;
+    bool obscured = false;
+    bool shown = false;  // Until it is mapped into a parent
+    std::function<void(bool visible)> visibilityCallback;
+};
+
+bool SurfaceViewImpl::create()
+{
+    int screenNumber = 0;
+    connection = xcb_connect(nullptr, &screenNumber);
+    if (xcb_connection_has_error(connection))
+        return false;
+
+    auto roots = xcb_setup_roots_iterator(xcb_get_setup(connection));
+    for (int i = 0; i < screenNumber && roots.rem > 0; ++i)
+        xcb_screen_next(&roots);
+    screen = roots.data;
+
+    const xcb_query_extension_reply_t* dri3 = xcb_get_extension_data(connection, &xcb_dri3_id);
+    const xcb_query_extension_reply_t* present = xcb_get_extension_data(connection, &xcb_present_id);
+    if (screen == nullptr || dri3 == nullptr || !dri3->present || present == nullptr || !present->present)
+        return false;
+    presentOpcode = present->major_opcode;
+
+    auto version = xcb_dri3_query_version_reply(connection, xcb_dri3_query_version(connection, 1, 2), nullptr);
+    if (version != nullptr)
+    {
+        modifiers = version->major_version > 1 || version->minor_version >= 2;
+        free(version);
+    }
+
+    // No background, so nothing is cleared over the last frame; content stays
+    // anchored to the top-left corner while the window resizes, and the unused
+    // part of an over-allocated buffer (Surface::sizeBucket) is clipped
+    window = xcb_generate_id(connection);
+    uint32_t windowValues[] = { XCB_BACK_PIXMAP_NONE, XCB_GRAVITY_NORTH_WEST,
+                                XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_VISIBILITY_CHANGE };
+    xcb_create_window(connection, XCB_COPY_FROM_PARENT, window, screen->root, 0, 0, 1, 1, 0,
+                      XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual,
+                      XCB_CW_BACK_PIXMAP | XCB_CW_BIT_GRAVITY | XCB_CW_EVENT_MASK, windowValues);
+
+    xcb_present_select_input(connection, xcb_generate_id(connection), window,
+                             XCB_PRESENT_EVENT_MASK_COMPLETE_NOTIFY);
+
+    overlay = xcb_generate_id(connection);
+    uint32_t overlayValues[] = { screen->black_pixel, XCB_EVENT_MASK_EXPOSURE };
+    xcb_create_window(connection, XCB_COPY_FROM_PARENT, overlay, window, 4, 4, 1, 1, 0,
+                      XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual,
+                      XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK, overlayValues);
+
+    constexpr char fontName[] = "fixed";
+    font = xcb_generate_id(connection);
+    xcb_open_font(connection, font, sizeof(fontName) - 1, fontName);
+
+    gc = xcb_generate_id(connection);
+    uint32_t gcValues[] = { screen->white_pixel, screen->black_pixel, font };
+    xcb_create_gc(connection, gc, overlay, XCB_GC_FOREGROUND | XCB_GC_BACKGROUND | XCB_GC_FONT, gcValues);
+
+    auto metrics = xcb_query_font_reply(connection, xcb_query_font(connection, font), nullptr);
+    if (metrics != nullptr)
+    {
+        charWidth = std::max<int>(1, metrics->max_bounds.character_width);
+        ascent = metrics->font_ascent;
+        lineHeight = metrics->font_ascent + metrics->font_descent;
+        free(metrics);
+    }
+
+    xcb_flush(connection);
+
+    juce::LinuxEventLoop::registerFdCallback(xcb_get_file_descriptor(connection),
+                                             [this](int) { dispatchEvents(); });
+    return true;
+}
+
+void SurfaceViewImpl::destroy()
+{
+    if (connection == nullptr)
+        return;
+
+    juce::LinuxEventLoop::unregisterFdCallback(xcb_get_file_descriptor(connection));
+    if (!xcb_connection_has_error(connection))
+    {
+        for (const auto& entry : imports)
+            xcb_free_pixmap(connection, entry.pixmap);
+        if (gc != 0)
+            xcb_free_gc(connection, gc);
+        if (font != 0)
+            xcb_close_font(connection, font);
+        if (window != 0)
+            xcb_destroy_window(connection, window);  // And the overlay with it
+        xcb_flush(connection);
+    }
+
+    xcb_disconnect(connection);
+    connection = nullptr;
+    imports.clear();
+}
+
+xcb_pixmap_t SurfaceViewImpl::import(const Surface::DmaBuffer* buffer)
+{
+    auto found = std::find_if(imports.begin(), imports.end(),
+                              [buffer](const Import& entry) { return entry.serial == buffer->serial; });
+    if (found != imports.end())
+        return found->pixmap;
+
+    bool implicit = buffer->modifier == DMABUF_MODIFIER_INVALID;
+    if (!modifiers && (!implicit || buffer->offset != 0 || buffer->stride > 0xFFFF))
+        return 0;
+
+    // xcb closes the fd once sent; the X server keeps its own reference, so the
+    // pixmap stays valid after the Surface releases the buffer
+    int fd = fcntl(buffer->fd, F_DUPFD_CLOEXEC, 0);
+    if (fd < 0)
+        return 0;
+
+    if (imports.size() >= maxImports)
+    {
+        // Oldest buffer not on screen, the chain it belonged to is gone by now
+        auto oldest = imports.end();
+        for (auto it = imports.begin(); it != imports.end(); ++it)
+            if (it->pixmap != displayed && it->pixmap != pending
+                && (oldest == imports.end() || it->serial < oldest->serial))
+                oldest = it;
+
+        if (oldest != imports.end())
+        {
+            xcb_free_pixmap(connection, oldest->pixmap);
+            imports.erase(oldest);
+        }
+    }
+
+    // Depth of the window, so the X server can present it; alpha is ignored
+    xcb_pixmap_t pixmap = xcb_generate_id(connection);
+    auto width = static_cast<uint16_t>(buffer->width);
+    auto height = static_cast<uint16_t>(buffer->height);
+    if (modifiers)
+        xcb_dri3_pixmap_from_buffers(connection, pixmap, window, 1, width, height, buffer->stride, buffer->offset,
+                                     0, 0, 0, 0, 0, 0, screen->root_depth, 32, buffer->modifier, &fd);
+    else
+        xcb_dri3_pixmap_from_buffer(connection, pixmap, window, buffer->stride * static_cast<uint32_t>(height),
+                                    width, height, static_cast<uint16_t>(buffer->stride), screen->root_depth, 32, fd);
+
+    imports.push_back({ buffer->serial, pixmap });
+    return pixmap;
+}
+
+void SurfaceViewImpl::present(xcb_pixmap_t pixmap, bool notify)
+{
+    // Next vblank, as the display link does on macOS
+    xcb_present_pixmap(connection, window, pixmap, ++presentSerial, 0, 0, 0, 0, 0, 0, 0,
+                       XCB_PRESENT_OPTION_NONE, 0, 0, 0, 0, nullptr);
+    xcb_flush(connection);
+
+    displayed = pixmap;
+    presenting = true;
+    notifyPresent = notify;
+}
+
+void SurfaceViewImpl::scheduleVsync()
+{
+    if (!vsyncRequested || vsyncQueued || !shown)
+        return;
+
+    // Divisor 1 and a past target: notify at the next vblank
+    xcb_present_notify_msc(connection, window, ++vsyncSerial, 0, 1, 0);
+    xcb_flush(connection);
+    vsyncQueued = true;
+}
+
+void SurfaceViewImpl::updateRefreshPeriod(uint64_t ust, uint64_t msc)
+{
+    // Unmapped windows tick on a slow fake CRTC; keep the last plausible rate
+    if (lastMsc != 0 && msc > lastMsc && ust > lastUst)
+    {
+        uint64_t nanos = (ust - lastUst) * 1000 / (msc - lastMsc);
+        if (nanos >= 2000000 && nanos <= 50000000)
+            refreshNanos = nanos;
+    }
+    lastUst = ust;
+    lastMsc = msc;
+}
+
+void SurfaceViewImpl::dispatchEvents()
+{
+    while (auto* event = xcb_poll_for_event(connection))
+    {
+        uint8_t type = event->response_type & 0x7F;
+        if (type == XCB_EXPOSE)
+        {
+            auto* expose = reinterpret_cast<xcb_expose_event_t*>(event);
+            if (expose->window == overlay && expose->count == 0)
+                drawOverlay();
+        }
+        else if (type == XCB_MAP_NOTIFY || type == XCB_UNMAP_NOTIFY)
+        {
+            // Both come for our window and for the top-level we watch
+            bool isMapped = type == XCB_MAP_NOTIFY;
+            xcb_window_t target = isMapped ? reinterpret_cast<xcb_map_notify_event_t*>(event)->window
+                                           : reinterpret_cast<xcb_unmap_notify_event_t*>(event)->window;
+            if (target == window)
+                mapped = isMapped;
+            else if (target == topLevel)
+                topLevelMapped = isMapped;
+            updateVisibility();
+        }
+        else if (type == XCB_VISIBILITY_NOTIFY)
+        {
+            auto* visibility = reinterpret_cast<xcb_visibility_notify_event_t*>(event);
+            if (visibility->window == window)
+            {
+                obscured = visibility->state == XCB_VISIBILITY_FULLY_OBSCURED;
+                updateVisibility();
+            }
+        }
+        else if (type == XCB_GE_GENERIC)
+        {
+            auto* generic = reinterpret_cast<xcb_ge_generic_event_t*>(event);
+            if (generic->extension == presentOpcode && generic->event_type == XCB_PRESENT_COMPLETE_NOTIFY)
+            {
+                auto* complete = reinterpret_cast<xcb_present_complete_notify_event_t*>(event);
+                updateRefreshPeriod(complete->ust, complete->msc);
+
+                if (complete->kind == XCB_PRESENT_COMPLETE_KIND_NOTIFY_MSC)
+                {
+                    // A pixmap presented before the next vblank is shown there
+                    if (complete->serial == vsyncSerial)
+                    {
+                        vsyncQueued = false;
+                        vsyncRequested = false;
+                        uint64_t nextNanos = complete->ust * 1000 + refreshNanos;
+                        if (vsyncCallback)
+                            vsyncCallback(nextNanos, nextNanos);
+                    }
+                }
+                else if (complete->serial == presentSerial)
+                {
+                    presenting = false;
+
+                    // ust is CLOCK_MONOTONIC, like the JUCE high resolution counter
+                    if (notifyPresent && presentCallback)
+                    {
+                        timespec now;
+                        clock_gettime(CLOCK_MONOTONIC, &now);
+                        double nowMs = now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+                        presentCallback(static_cast<double>(complete->ust) / 1000.0 - nowMs);
+                    }
+
+                    if (pending != 0)
+                    {
+                        xcb_pixmap_t next = pending;
+                        pending = 0;
+                        present(next, true);
+                    }
+                }
+            }
+        }
+        free(event);
+    }
+}
+
+void SurfaceViewImpl::watchTopLevel(xcb_window_t parent)
+{
+    // The window manager unmaps the top-level (or its frame) when it is minimized;
+    // our window stays mapped, so watch the child of the root above it
+    xcb_window_t current = parent;
+    for (;;)
+    {
+        auto tree = xcb_query_tree_reply(connection, xcb_query_tree(connection, current), nullptr);
+        if (tree == nullptr)
+            break;
+        xcb_window_t up = tree->parent;
+        free(tree);
+        if (up == screen->root || up == 0)
+            break;
+        current = up;
+    }
+
+    if (current == topLevel)
+        return;
+
+    if (topLevel != 0)
+    {
+        uint32_t none = XCB_EVENT_MASK_NO_EVENT;
+        xcb_change_window_attributes(connection, topLevel, XCB_CW_EVENT_MASK, &none);
+    }
+
+    // Our own event mask on a window of the plugin's connection; each client has its own
+    topLevel = current;
+    uint32_t mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    xcb_change_window_attributes(connection, topLevel, XCB_CW_EVENT_MASK, &mask);
+
+    auto attributes = xcb_get_window_attributes_reply(connection, xcb_get_window_attributes(connection, topLevel), nullptr);
+    topLevelMapped = attributes == nullptr || attributes->map_state != XCB_MAP_STATE_UNMAPPED;
+    free(attributes);
+}
+
+void SurfaceViewImpl::updateVisibility()
+{
+    bool visible = mapped && topLevelMapped && !obscured;
+    if (visible == shown)
+        return;
+
+    shown = visible;
+    if (visibilityCallback)
+        visibilityCallback(visible);
+    scheduleVsync();
+}
+
+void SurfaceViewImpl::setOverlayText(const std::string& text)
+{
+    overlayLines.clear();
+    for (size_t start = 0; start < text.size();)
+    {
+        size_t end = std::min(text.find('\n', start), text.size());
+        overlayLines.push_back(text.substr(start, std::min<size_t>(end - start, 255)));
+        start = end + 1;
+    }
+
+    if (overlayLines.empty())
+    {
+        xcb_unmap_window(connection, overlay);
+    }
+    else
+    {
+        size_t columns = 0;
+        for (const auto& line : overlayLines)
+            columns = std::max(columns, line.size());
+
+        uint32_t size[] = { static_cast<uint32_t>(columns * static_cast<size_t>(charWidth) + 4),
+                            static_cast<uint32_t>(overlayLines.size() * static_cast<size_t>(lineHeight) + 2) };
+        xcb_configure_window(connection, overlay, XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, size);
+        xcb_map_window(connection, overlay);
+        drawOverlay();
+    }
+    xcb_flush(connection);
+}
+
+void SurfaceViewImpl::drawOverlay()
+{
+    xcb_clear_area(connection, 0, overlay, 0, 0, 0, 0);
+    int baseline = 1 + ascent;
+    for (const auto& line : overlayLines)
+    {
+        xcb_image_text_8(connection, static_cast<uint8_t>(line.size()), overlay, gc, 2,
+                         static_cast<int16_t>(baseline), line.c_str());
+        baseline += lineHeight;
+    }
+    xcb_flush(connection);
+}
+
+SurfaceView::SurfaceView() = default;
+
+SurfaceView::~SurfaceView()
+{
+    destroy();
+}
+
+bool SurfaceView::create()
+{
+    if (nativeView_)
+        return true;
+
+    auto* view = new SurfaceViewImpl();
+    if (!view->create())
+    {
+        view->destroy();
+        delete view;
+        return false;
+    }
+
+    view->presentCallback = [this](double displayDelayMs) {
+        if (presentCallback_)
+            presentCallback_(displayDelayMs);
+    };
+    view->visibilityCallback = [this](bool visible) {
+        if (visibilityCallback_)
+            visibilityCallback_(visible);
+    };
+    view->vsyncCallback = [this](uint64_t deadlineNanos, uint64_t presentNanos) {
+        if (vsyncCallback_)
+            vsyncCallback_(deadlineNanos, presentNanos);
+    };
+    nativeView_ = view;
+    return true;
+}
+
+void SurfaceView::destroy()
+{
+    if (nativeView_)
+    {
+        auto* view = static_cast<SurfaceViewImpl*>(nativeView_);
+        view->destroy();
+        delete view;
+        nativeView_ = nullptr;
+    }
+}
+
+bool SurfaceView::isValid() const
+{
+    return nativeView_ != nullptr;
+}
+
+void SurfaceView::setSurface(void* surface)
+{
+    auto* view = static_cast<SurfaceViewImpl*>(nativeView_);
+    if (view == nullptr || surface == nullptr)
+        return;
+
+    if (xcb_pixmap_t pixmap = view->import(static_cast<const Surface::DmaBuffer*>(surface)))
+    {
+        view->pending = 0;
+        view->present(pixmap, false);
+    }
+}
+
+void SurfaceView::setPendingSurface(void* surface)
+{
+    auto* view = static_cast<SurfaceViewImpl*>(nativeView_);
+    if (view == nullptr)
+        return;
+
+    view->pending = surface != nullptr ? view->import(static_cast<const Surface::DmaBuffer*>(surface)) : 0;
+    if (view->pending != 0 && !view->presenting)
+    {
+        xcb_pixmap_t next = view->pending;
+        view->pending = 0;
+        view->present(next, true);
+    }
+}
+
+void SurfaceView::requestVsync()
+{
+    if (auto* view = static_cast<SurfaceViewImpl*>(nativeView_))
+    {
+        view->vsyncRequested = true;
+        view->scheduleVsync();
+    }
+}
+
+void SurfaceView::setBackingScale(float scale)
+{
+    if (auto* view = static_cast<SurfaceViewImpl*>(nativeView_))
+        view->backingScale = scale;
+}
+
+void SurfaceView::setOverlayText(const std::string& text)
+{
+    if (auto* view = static_cast<SurfaceViewImpl*>(nativeView_))
+        view->setOverlayText(text);
+}
+
+void SurfaceView::attachToParent(void* parentView)
+{
+    auto* view = static_cast<SurfaceViewImpl*>(nativeView_);
+    if (view == nullptr || parentView == nullptr)
+        return;
+
+    // The peer's native handle is its X window id
+    auto parent = static_cast<xcb_window_t>(reinterpret_cast<uintptr_t>(parentView));
+    xcb_reparent_window(view->connection, view->window, parent, 0, 0);
+    xcb_map_window(view->connection, view->window);
+    view->watchTopLevel(parent);
+    xcb_flush(view->connection);
+}
+
+void SurfaceView::detachFromParent()
+{
+    if (auto* view = static_cast<SurfaceViewImpl*>(nativeView_))
+    {
+        xcb_unmap_window(view->connection, view->window);
+        xcb_reparent_window(view->connection, view->window, view->screen->root, 0, 0);
+        xcb_flush(view->connection);
+    }
+}
+
+void SurfaceView::setFrame(int x, int y, int width, int height)
+{
+    auto* view = static_cast<SurfaceViewImpl*>(nativeView_);
+    if (view == nullptr || width <= 0 || height <= 0)
+        return;
+
+    // Component coordinates are logical, X windows are in physical pixels
+    auto physical = [view](int value) { return static_cast<uint32_t>(std::lround(value * view->backingScale)); };
+    uint32_t values[] = { physical(x), physical(y), physical(width), physical(height) };
+    xcb_configure_window(view->connection, view->window,
+                         XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH
+                             | XCB_CONFIG_WINDOW_HEIGHT,
+                         values);
+    xcb_flush(view->connection);
+}
+
+float SurfaceView::getBackingScaleForView(void* nativeView)
+{
+    for (int i = 0; i < juce::ComponentPeer::getNumPeers(); ++i)
+    {
+        auto* peer = juce::ComponentPeer::getPeer(i);
+        if (peer->getNativeHandle() == nativeView)
+            return static_cast<float>(peer->getPlatformScaleFactor());
+    }
+    return 1.0f;
+}
+
+}  // namespace juce_cmp
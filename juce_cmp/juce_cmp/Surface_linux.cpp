@@ -0,0 +1,211 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "Surface.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <gbm.h>
+
+namespace juce_cmp
+{
+
+bool Surface::captureSnapshot(uint8_t generation, int index)
+{
+    auto* source = static_cast<DmaBuffer*>(findBuffer(generation, index));
+    if (source == nullptr)
+        return false;
+
+    // Linear, so it can be mapped for the copy on any driver
+    DmaBuffer* snapshot = createBuffer(source->width, source->height, true);
+    if (snapshot == nullptr)
+        return false;
+
+    // One CPU copy per detach; the child is not rendering into its chain anymore
+    auto* sourceBo = static_cast<gbm_bo*>(source->bo);
+    auto* snapshotBo = static_cast<gbm_bo*>(snapshot->bo);
+    uint32_t width = static_cast<uint32_t>(source->width);
+    uint32_t height = static_cast<uint32_t>(source->height);
+
+    uint32_t srcStride = 0;
+    uint32_t dstStride = 0;
+    void* srcData = nullptr;
+    void* dstData = nullptr;
+    auto* src = static_cast<const uint8_t*>(gbm_bo_map(sourceBo, 0, 0, width, height, GBM_BO_TRANSFER_READ,
+                                                       &srcStride, &srcData));
+    auto* dst = static_cast<uint8_t*>(gbm_bo_map(snapshotBo, 0, 0, width, height, GBM_BO_TRANSFER_WRITE,
+                                                 &dstStride, &dstData));
+
+    bool copied = src != nullptr && dst != nullptr;
+    if (copied)
+        for (uint32_t y = 0; y < height; ++y)
+            memcpy(dst + y * dstStride, src + y * srcStride, width * 4);
+
+    if (dst != nullptr)
+        gbm_bo_unmap(snapshotBo, dstData);
+    if (src != nullptr)
+        gbm_bo_unmap(sourceBo, srcData);
+
+    if (!copied)
+    {
+        releaseBuffer(snapshot);
+        return false;
+    }
+
+    releaseSnapshot();
+    snapshot_ = snapshot;
+    return true;
+}
+
+bool Surface::readPixels(uint8_t generation, int index, void* dst, int dstStride, int width, int height) const
+{
+    auto* source = static_cast<DmaBuffer*>(findBuffer(generation, index));
+    if (source == nullptr || dst == nullptr)
+        return false;
+
+    uint32_t rowWidth = static_cast<uint32_t>(std::clamp(width, 0, source->width));
+    uint32_t rows = static_cast<uint32_t>(std::clamp(height, 0, source->height));
+    if (rowWidth == 0 || rows == 0)
+        return true;
+
+    auto* sourceBo = static_cast<gbm_bo*>(source->bo);
+    uint32_t srcStride = 0;
+    void* srcData = nullptr;
+    auto* src = static_cast<const uint8_t*>(gbm_bo_map(sourceBo, 0, 0, rowWidth, rows, GBM_BO_TRANSFER_READ,
+                                                       &srcStride, &srcData));
+    if (src == nullptr)
+        return false;
+
+    for (uint32_t y = 0; y < rows; ++y)
+        memcpy(static_cast<uint8_t*>(dst) + y * static_cast<size_t>(dstStride), src + y * srcStride, rowWidth * 4);
+
+    gbm_bo_unmap(sourceBo, srcData);
+    return true;
+}
+
+void Surface::releaseSnapshot()
+{
+    releaseBuffer(static_cast<DmaBuffer*>(snapshot_));
+    snapshot_ = nullptr;
+}
+
+bool Surface::createChain(Chain& chain, int width, int height)
+{
+    if (!openDevice())
+        return false;
+
+    for (int i = 0; i < numBuffers_; ++i)
+    {
+        chain.buffers[i] = createBuffer(width, height, false);
+        if (chain.buffers[i] == nullptr)
+        {
+            releaseChain(chain);
+            return false;
+        }
+    }
+
+    chain.generation = ++generation_;
+    return true;
+}
+
+void Surface::releaseChain(Chain& chain)
+{
+    for (auto& buffer : chain.buffers)
+        releaseBuffer(static_cast<DmaBuffer*>(buffer));
+    chain = {};
+}
+
+bool Surface::openDevice()
+{
+    if (device_ != nullptr)
+        return true;
+
+    // Render nodes need neither DRM master nor a display server connection
+    for (int minor = 128; minor < 192; ++minor)
+    {
+        char path[32];
+        snprintf(path, sizeof(path), "/dev/dri/renderD%d", minor);
+
+        int fd = open(path, O_RDWR | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        gbm_device* device = gbm_create_device(fd);
+        if (device != nullptr
+            && gbm_device_is_format_supported(device, GBM_FORMAT_ARGB8888, GBM_BO_USE_RENDERING))
+        {
+            device_ = device;
+            deviceFD_ = fd;
+            return true;
+        }
+
+        if (device != nullptr)
+            gbm_device_destroy(device);
+        close(fd);
+    }
+
+    return false;
+}
+
+void Surface::closeDevice()
+{
+    if (device_ != nullptr)
+    {
+        gbm_device_destroy(static_cast<gbm_device*>(device_));
+        device_ = nullptr;
+    }
+    if (deviceFD_ >= 0)
+    {
+        close(deviceFD_);
+        deviceFD_ = -1;
+    }
+}
+
+Surface::DmaBuffer* Surface::createBuffer(int width, int height, bool linear)
+{
+    if (!openDevice() || width <= 0 || height <= 0)
+        return nullptr;
+
+    uint32_t flags = GBM_BO_USE_RENDERING | (linear ? GBM_BO_USE_LINEAR : 0);
+    gbm_bo* bo = gbm_bo_create(static_cast<gbm_device*>(device_), static_cast<uint32_t>(width),
+                               static_cast<uint32_t>(height), GBM_FORMAT_ARGB8888, flags);
+    if (bo == nullptr)
+        return nullptr;
+
+    // The protocol carries one plane per buffer
+    int fd = gbm_bo_get_plane_count(bo) == 1 ? gbm_bo_get_fd(bo) : -1;
+    if (fd < 0)
+    {
+        gbm_bo_destroy(bo);
+        return nullptr;
+    }
+
+    auto* buffer = new DmaBuffer();
+    buffer->bo = bo;
+    buffer->fd = fd;
+    buffer->width = width;
+    buffer->height = height;
+    buffer->stride = gbm_bo_get_stride_for_plane(bo, 0);
+    buffer->offset = gbm_bo_get_offset(bo, 0);
+    buffer->format = DMABUF_FORMAT_ARGB8888;
+    buffer->modifier = gbm_bo_get_modifier(bo);
+    buffer->serial = ++nextSerial_;
+    return buffer;
+}
+
+void Surface::releaseBuffer(DmaBuffer* buffer)
+{
+    if (buffer == nullptr)
+        return;
+
+    // Importers hold their own references, the memory lives until they drop them
+    close(buffer->fd);
+    gbm_bo_destroy(static_cast<gbm_bo*>(buffer->bo));
+    delete buffer;
+}
+
+}  // namespace juce_cmp
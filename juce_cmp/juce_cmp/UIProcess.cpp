@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "UIProcess.h"
+#include "ipc_protocol.h"
+
+#include <cstring>
+#include <vector>
+
+#if __APPLE__ || __linux__
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+namespace juce_cmp
+{
+
+UIProcess::UIProcess() = default;
+
+UIProcess::~UIProcess()
+{
+    stop();
+}
+
+bool UIProcess::ensureRunning(const std::string& executable, const std::string& workingDir)
+{
+    std::lock_guard<std::mutex> lock(lock_);
+
+    if (child_.isRunning())
+    {
+        // One shared process serves a single UI binary
+        return executable == executable_;
+    }
+
+    child_.stop();
+    if (!child_.launchShared(executable, workingDir))
+        return false;
+
+    executable_ = executable;
+    return true;
+}
+
+void UIProcess::stop()
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    child_.stop();
+    executable_.clear();
+}
+
+bool UIProcess::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(lock_);
+    return child_.isRunning();
+}
+
+bool UIProcess::openChannel(int socketFD, int sharedMemoryFD, int visualStreamFD,
+                            float scale, const std::string& machServiceName)
+{
+#if __APPLE__ || __linux__
+    std::lock_guard<std::mutex> lock(lock_);
+
+    int controlFD = child_.getSocketFD();
+    if (controlFD < 0 || socketFD < 0)
+        return false;
+
+    // Arguments use the same flags as a dedicated child's command line,
+    // except that fd flags give a position in the SCM_RIGHTS list
+    int fds[CONTROL_MAX_FDS] = { socketFD };
+    int numFDs = 1;
+
+    std::string args = "--scale=" + std::to_string(scale);
+    args.push_back('\0');
+    if (!machServiceName.empty())
+    {
+        args += "--mach-service=" + machServiceName;
+        args.push_back('\0');
+    }
+    if (sharedMemoryFD >= 0)
+    {
+        args += "--shm-fd=" + std::to_string(numFDs);
+        args.push_back('\0');
+        fds[numFDs++] = sharedMemoryFD;
+    }
+    if (visualStreamFD >= 0)
+    {
+        args += "--stream-fd=" + std::to_string(numFDs);
+        args.push_back('\0');
+        fds[numFDs++] = visualStreamFD;
+    }
+
+    uint8_t header[5];
+    header[0] = CONTROL_OPEN_CHANNEL;
+    uint32_t length = static_cast<uint32_t>(args.size());
+    memcpy(header + 1, &length, sizeof(length));
+
+    struct iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = const_cast<char*>(args.data());
+    iov[1].iov_len = args.size();
+
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * CONTROL_MAX_FDS)] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * numFDs);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * numFDs);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * numFDs);
+
+    // Control messages are tiny; the blocking socket takes them whole
+    ssize_t n;
+    do
+    {
+        n = sendmsg(controlFD, &msg, 0);
+    } while (n < 0 && errno == EINTR);
+
+    return n == static_cast<ssize_t>(sizeof(header) + args.size());
+#else
+    (void)socketFD;
+    (void)sharedMemoryFD;
+    (void)visualStreamFD;
+    (void)scale;
+    (void)machServiceName;
+    return false;
+#endif
+}
+
+}  // namespace juce_cmp
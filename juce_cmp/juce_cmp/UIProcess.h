@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "ChildProcess.h"
+#include <mutex>
+#include <string>
+
+namespace juce_cmp
+{
+
+/**
+ * UIProcess - One UI child process shared by several ComposeProviders.
+ *
+ * Instead of one JVM per editor, the child is launched once with a control
+ * socket and every editor opens a channel on it: a socket pair of its own
+ * (plus the optional shared memory ring) passed with SCM_RIGHTS. The child
+ * runs one Compose scene per channel on a shared Metal device, DirectContext
+ * and JIT. See ipc_protocol.h for the control message.
+ *
+ * Ownership: whoever creates the UIProcess decides who shares it, typically
+ * by handing the same std::shared_ptr to each ComposeComponent. The module
+ * keeps no process-wide registry (plugin instances share the host process).
+ *
+ * Pre-warming: call ensureRunning() early, e.g. from the AudioProcessor
+ * constructor. While no editor is open the child initializes Metal and
+ * composes the UI once offscreen, so opening an editor only costs a channel,
+ * a swap chain and one frame. The process stays warm when editors close.
+ */
+class UIProcess
+{
+public:
+    UIProcess();
+    ~UIProcess();
+
+    // Non-copyable
+    UIProcess(const UIProcess&) = delete;
+    UIProcess& operator=(const UIProcess&) = delete;
+
+    /** Launch the shared child if it is not running yet (also used to pre-warm). Returns true if running. */
+    bool ensureRunning(const std::string& executable, const std::string& workingDir = "");
+
+    /** Stop the shared child. Open channels see EOF. */
+    void stop();
+
+    /** Check if the shared child is still running. */
+    bool isRunning() const;
+
+    /**
+     * Open an editor channel on the running child. socketFD is the child's end
+     * of the editor socket pair; the caller closes its copy afterwards, as with
+     * sharedMemoryFD (-1 = socket only). visualStreamFD is only duplicated
+     * into the child and stays open (-1 = none). Returns true on success.
+     */
+    bool openChannel(int socketFD, int sharedMemoryFD, int visualStreamFD,
+                     float scale, const std::string& machServiceName);
+
+private:
+    ChildProcess child_;
+    std::string executable_;
+    mutable std::mutex lock_;
+};
+
+}  // namespace juce_cmp
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "ValueTreeSync.h"
+#include "ipc_protocol.h"
+
+namespace juce_cmp
+{
+
+ValueTreeSync::ValueTreeSync(const juce::ValueTree& tree, SendFunction send)
+    : juce::ValueTreeSynchroniser(tree), tree_(tree), send_(std::move(send))
+{
+}
+
+ValueTreeSync::~ValueTreeSync() = default;
+
+void ValueTreeSync::sendFullSync()
+{
+    sendFullSyncCallback();
+}
+
+bool ValueTreeSync::applyChange(const void* data, size_t size)
+{
+    if (size == 0)
+        return false;
+
+    // Our listener sees these edits too - don't send them back
+    const juce::ScopedValueSetter<bool> applying(applying_, true);
+
+    // A full sync would reassign the tree and detach it from the app's copy;
+    // rebuild the existing one in place instead
+    if (static_cast<const uint8_t*>(data)[0] == SYNC_CHANGE_FULL)
+    {
+        auto tree = juce::ValueTree::readFromData(static_cast<const uint8_t*>(data) + 1, size - 1);
+        if (!tree.isValid() || tree.getType() != tree_.getType())
+            return false;
+
+        tree_.copyPropertiesAndChildrenFrom(tree, nullptr);
+        return true;
+    }
+
+    return juce::ValueTreeSynchroniser::applyChange(tree_, data, size, nullptr);
+}
+
+void ValueTreeSync::stateChanged(const void* encodedChange, size_t encodedChangeSize)
+{
+    if (applying_ || !send_)
+        return;
+
+    if (send_(encodedChange, encodedChangeSize) || resyncing_)
+        return;
+
+    // A delta was lost on overflow - the UI's mirror is stale, start it over
+    const juce::ScopedValueSetter<bool> resyncing(resyncing_, true);
+    sendFullSyncCallback();
+}
+
+}  // namespace juce_cmp
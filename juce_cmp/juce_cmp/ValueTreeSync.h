@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <juce_data_structures/juce_data_structures.h>
+#include <functional>
+
+namespace juce_cmp
+{
+
+/**
+ * ValueTreeSync - Keeps a ValueTree mirrored in the UI process.
+ *
+ * Instead of shipping the whole tree on every edit, each property or child
+ * change is sent as a small delta addressed by its child-index path
+ * (EVENT_TYPE_SYNC, juce::ValueTreeSynchroniser format). The UI side keeps
+ * the mirror in SyncedValueTree.kt and sends its own edits back the same way.
+ *
+ * Changes received from the UI are applied to the tree without echoing them
+ * back. Message thread only, like the ValueTree itself.
+ */
+class ValueTreeSync : private juce::ValueTreeSynchroniser
+{
+public:
+    /** Sends one change. Returns false if it (or an earlier one) was lost. */
+    using SendFunction = std::function<bool(const void* data, size_t size)>;
+
+    ValueTreeSync(const juce::ValueTree& tree, SendFunction send);
+    ~ValueTreeSync() override;
+
+    /** Send the whole tree, e.g. when the UI connects. */
+    void sendFullSync();
+
+    /** Apply a change received from the UI. Returns false if it does not match the tree. */
+    bool applyChange(const void* data, size_t size);
+
+    const juce::ValueTree& getTree() const { return tree_; }
+
+private:
+    void stateChanged(const void* encodedChange, size_t encodedChangeSize) override;
+
+    juce::ValueTree tree_;  // Shares its data with the synchronised tree
+    SendFunction send_;
+    bool applying_ = false;
+    bool resyncing_ = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ValueTreeSync)
+};
+
+}  // namespace juce_cmp
@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include "VisualStream.h"
+#include "ipc_protocol.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <random>
+
+#if __APPLE__ || __linux__
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+namespace juce_cmp
+{
+
+VisualStream::VisualStream() = default;
+
+VisualStream::~VisualStream()
+{
+    release();
+}
+
+bool VisualStream::create(size_t numFloats)
+{
+#if __APPLE__ || __linux__
+    release();
+
+    if (numFloats == 0)
+        return false;
+
+    // Short name: macOS limits shm names to 31 characters
+    char name[32];
+    snprintf(name, sizeof(name), "/jcmv.%d.%u", getpid(), (unsigned)(std::random_device{}() & 0xFFFFFF));
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0)
+        return false;
+
+    // Unlink right away - children reach the region through the fd
+    shm_unlink(name);
+
+    size_t slotSize = (numFloats * sizeof(float) + 63) & ~size_t(63);
+    size_t size = VISUAL_STREAM_HEADER_SIZE + VISUAL_STREAM_SLOT_COUNT * slotSize;
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    auto* bytes = static_cast<uint8_t*>(base);
+    memset(bytes, 0, size);
+
+    // Writer starts on slot 0, slot 1 is spare, the reader holds slot 2
+    state_ = new (bytes + VISUAL_STREAM_HEADER_STATE) std::atomic<uint32_t>(1);
+    new (bytes + VISUAL_STREAM_HEADER_READER_SLOT) std::atomic<uint32_t>(2);
+    back_ = 0;
+
+    uint32_t header[4] = { VISUAL_STREAM_MAGIC, VISUAL_STREAM_VERSION,
+                           static_cast<uint32_t>(numFloats), static_cast<uint32_t>(slotSize) };
+    memcpy(bytes + VISUAL_STREAM_HEADER_MAGIC, &header[0], 4);
+    memcpy(bytes + VISUAL_STREAM_HEADER_VERSION, &header[1], 4);
+    memcpy(bytes + VISUAL_STREAM_HEADER_NUM_FLOATS, &header[2], 4);
+    memcpy(bytes + VISUAL_STREAM_HEADER_SLOT_SIZE, &header[3], 4);
+
+    base_ = base;
+    size_ = size;
+    numFloats_ = numFloats;
+    slotSize_ = slotSize;
+    fd_ = fd;
+    return true;
+#else
+    (void)numFloats;
+    return false;
+#endif
+}
+
+void VisualStream::release()
+{
+#if __APPLE__ || __linux__
+    if (fd_ >= 0)
+    {
+        close(fd_);
+        fd_ = -1;
+    }
+    if (base_ != nullptr)
+    {
+        munmap(base_, size_);
+        base_ = nullptr;
+    }
+#endif
+    size_ = 0;
+    numFloats_ = 0;
+    slotSize_ = 0;
+    state_ = nullptr;
+    back_ = 0;
+}
+
+float* VisualStream::beginWrite()
+{
+    return base_ != nullptr ? slot(back_) : nullptr;
+}
+
+void VisualStream::publish()
+{
+    if (base_ == nullptr)
+        return;
+
+    // acq_rel: release our frame, acquire the slot the reader gave back
+    uint32_t previous = state_->exchange(back_ | VISUAL_STREAM_FRESH, std::memory_order_acq_rel);
+    back_ = previous & VISUAL_STREAM_INDEX_MASK;
+}
+
+void VisualStream::write(const float* data, size_t numFloats)
+{
+    if (float* frame = beginWrite())
+    {
+        memcpy(frame, data, std::min(numFloats, numFloats_) * sizeof(float));
+        publish();
+    }
+}
+
+float* VisualStream::slot(uint32_t index) const
+{
+    auto* bytes = static_cast<uint8_t*>(base_) + VISUAL_STREAM_HEADER_SIZE + index * slotSize_;
+    return reinterpret_cast<float*>(bytes);
+}
+
+}  // namespace juce_cmp
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace juce_cmp
+{
+
+/**
+ * VisualStream - Float frames from the audio thread to the UI (host side).
+ *
+ * For meters, scopes and spectra: the audio thread fills a frame of floats
+ * (peak/RMS, a decimated waveform, FFT bins - the layout is up to the app)
+ * and publishes it. The UI reads the latest frame once per rendered frame
+ * straight from shared memory (VisualStream.kt). Nothing is queued: frames
+ * published faster than the UI renders replace each other.
+ *
+ * The region holds a triple buffer. Publishing swaps the written slot with
+ * the spare one through a single atomic word, so both sides are wait-free
+ * and neither ever sees a frame that is being written.
+ *
+ * Unlike SharedRing, the region outlives child launches, so the audio thread
+ * may keep writing across editor open/close. The reader records which slot it
+ * holds in the header, so a relaunched child resumes with the right one. The
+ * fd stays close-on-exec; the child gets a dup2'd copy when it is spawned.
+ * See ipc_protocol.h for the layout.
+ */
+class VisualStream
+{
+public:
+    VisualStream();
+    ~VisualStream();
+
+    // Non-copyable
+    VisualStream(const VisualStream&) = delete;
+    VisualStream& operator=(const VisualStream&) = delete;
+
+    /** Create and map the region for frames of numFloats values. */
+    bool create(size_t numFloats);
+
+    /** Unmap the region and close the fd. Not while the audio thread writes. */
+    void release();
+
+    /** Check if the region is mapped. */
+    bool isValid() const { return base_ != nullptr; }
+
+    /** File descriptor passed to each child (--stream-fd), -1 if not created. */
+    int getFD() const { return fd_; }
+
+    /** Number of floats in a frame. */
+    size_t getNumFloats() const { return numFloats_; }
+
+    /**
+     * Frame to fill, numFloats long. Real-time safe. It holds an older frame,
+     * so write every value the UI reads. nullptr if not created.
+     */
+    float* beginWrite();
+
+    /** Hand the frame from beginWrite() to the UI. Real-time safe. */
+    void publish();
+
+    /** Copy up to numFloats values into a frame and publish it. Real-time safe. */
+    void write(const float* data, size_t numFloats);
+
+private:
+    float* slot(uint32_t index) const;
+
+    void* base_ = nullptr;
+    size_t size_ = 0;
+    size_t numFloats_ = 0;
+    size_t slotSize_ = 0;
+    int fd_ = -1;
+    std::atomic<uint32_t>* state_ = nullptr;
+    uint32_t back_ = 0;  // Slot owned by the writer
+};
+
+}  // namespace juce_cmp
@@ -23,26 +23,251 @@ extern "C" {
 #define EVENT_TYPE_CMP              1
 #define EVENT_TYPE_MIDI             2
 #define EVENT_TYPE_JUCE             3
+#define EVENT_TYPE_RING             4  /* Wakeup: shared memory ring has data */
+#define EVENT_TYPE_SYNC             5  /* Synchronized ValueTree delta */
+#define EVENT_TYPE_PARAM            6  /* Batch of parameter values */
+#define EVENT_TYPE_BLOB             7  /* Shared memory payload, fd attached */
+#define EVENT_TYPE_MIDI_BUFFER      8  /* Timestamped MIDI events of any length */
+#define EVENT_TYPE_SOCKET           9  /* Ring only: the next message is on the socket */
 
 /*
  * CMP event types (second byte for EVENT_TYPE_CMP)
  */
 #define CMP_EVENT_SURFACE_READY     0  /* UI→Host: surface ready to display */
+#define CMP_EVENT_BUFFER_READY      1  /* UI→Host: swap chain buffer finished rendering */
+#define CMP_EVENT_DETACH            2  /* Host→UI: editor closed, release the swap chain */
+#define CMP_EVENT_FRAME_TIMING      3  /* UI→Host: costs of one frame (while enabled) */
+#define CMP_EVENT_TIMING_ENABLE     4  /* Host→UI: start or stop FRAME_TIMING reports */
+#define CMP_EVENT_SWAP_CHAIN        5  /* Host→UI: DMA-BUF swap chain, fds attached (Linux) */
+#define CMP_EVENT_VISIBILITY        6  /* Host→UI: view shown or hidden (occluded, minimized) */
+#define CMP_EVENT_FRAME_REQUEST     7  /* UI→Host: deliver a VSYNC on the next display refresh */
+#define CMP_EVENT_VSYNC             8  /* Host→UI: display refresh, time to render a frame */
+
+#define CMP_FRAME_TIMING_SIZE       26 /* FRAME_TIMING payload after the subtype */
+#define CMP_SWAP_CHAIN_HEADER_SIZE  22 /* SWAP_CHAIN payload after the subtype, before the buffers */
+#define CMP_SWAP_CHAIN_BUFFER_SIZE  8  /* Per buffer: uint32 stride + uint32 offset */
+#define CMP_VSYNC_SIZE              16 /* VSYNC payload after the subtype */
+
+/*
+ * Parameter records (EVENT_TYPE_PARAM). Flags mark the user grabbing or
+ * releasing a control, i.e. AudioProcessorParameter change gestures.
+ */
+#define PARAM_RECORD_SIZE           9     /* uint32 id + float value + uint8 flags */
+#define PARAM_MAX_RECORDS           1024  /* Per message */
+
+#define PARAM_FLAG_GESTURE_BEGIN    0x01
+#define PARAM_FLAG_GESTURE_END      0x02
+
+/*
+ * Shared memory blobs (EVENT_TYPE_BLOB, see SharedBlob.h). The size limit
+ * keeps a blob addressable by a single Java ByteBuffer.
+ */
+#define BLOB_HEADER_SIZE            8           /* uint32 id + uint32 size */
+#define BLOB_MAX_SIZE               0x7FFFFFFF
+
+/*
+ * Sized messages: 4-byte size, then the payload. A reader skips the payload
+ * of a message that exceeds its type's limit, keeping the stream in sync.
+ */
+#define MIDI_BUFFER_MAX_SIZE        (1024 * 1024)       /* EVENT_TYPE_MIDI_BUFFER, encoded events */
+#define VALUETREE_MAX_SIZE          (16 * 1024 * 1024)  /* EVENT_TYPE_JUCE and EVENT_TYPE_SYNC */
+
+/*
+ * ValueTree sync change types (first payload byte of EVENT_TYPE_SYNC).
+ * Values match juce::ValueTreeSynchroniser.
+ */
+#define SYNC_CHANGE_PROPERTY_CHANGED 1
+#define SYNC_CHANGE_FULL             2
+#define SYNC_CHANGE_CHILD_ADDED      3
+#define SYNC_CHANGE_CHILD_REMOVED    4
+#define SYNC_CHANGE_CHILD_MOVED      5
+#define SYNC_CHANGE_PROPERTY_REMOVED 6
+
+/*
+ * Swap chain - the host shares SWAP_CHAIN_BUFFER_COUNT surfaces of the same
+ * size in a single Mach message, tagged with an 8-bit generation that changes
+ * every time the chain is recreated (resize).
+ */
+#define SWAP_CHAIN_BUFFER_COUNT     3
+#define SWAP_CHAIN_MAX_BUFFERS      4
+
+/*
+ * DMA-BUF swap chains (Linux) - single-plane buffers in a DRM fourcc format.
+ * ARGB8888 is B, G, R, A in memory, like the BGRA IOSurfaces on macOS.
+ */
+#define DMABUF_FORMAT_ARGB8888      0x34325241  /* 'AR24' */
+#define DMABUF_MODIFIER_INVALID     0x00FFFFFFFFFFFFFFULL  /* Implicit layout */
 
 /**
  * CMP event payload - 1 byte subtype, follows EVENT_TYPE_CMP prefix.
- *   CMP_EVENT_SURFACE_READY: Surface rendered and ready to display (no additional data)
+ *   CMP_EVENT_SURFACE_READY: First frame rendered to a new swap chain or at a new
+ *     scene size within the current one (no additional data)
+ *   CMP_EVENT_BUFFER_READY:  1-byte generation + 1-byte buffer index. Sent once the
+ *                            GPU has finished the frame; the host displays that buffer.
+ *   CMP_EVENT_DETACH:        1-byte generation. The editor closed and the host released
+ *                            that swap chain; the child drops it and stops rendering
+ *                            (keeping its scene) until a newer chain arrives.
+ *   CMP_EVENT_FRAME_TIMING:  1-byte generation + 1-byte buffer index, then 32-bit
+ *                            little-endian fields: timestamp of the oldest input
+ *                            dispatched for the frame (InputEvent.timestamp, 0 = none),
+ *                            then microseconds that input waited in the child, input
+ *                            dispatch, scene render, flush and GPU execution.
+ *                            Sent right before the frame's BUFFER_READY.
+ *   CMP_EVENT_TIMING_ENABLE: 1-byte flag (1 = send FRAME_TIMING, 0 = stop).
+ *   CMP_EVENT_SWAP_CHAIN:    1-byte generation + 1-byte buffer count, then 32-bit
+ *                            width, height and DRM fourcc format, 64-bit format
+ *                            modifier, and per buffer a 32-bit stride and offset,
+ *                            all little-endian. One DMA-BUF fd per buffer arrives
+ *                            as SCM_RIGHTS ancillary data on the type byte, in
+ *                            buffer order. Linux only.
+ *   CMP_EVENT_VISIBILITY:    1-byte flag (1 = shown, 0 = hidden). A hidden view is
+ *                            occluded, minimized or hidden by the host; the child
+ *                            renders nothing until it is shown again.
+ *   CMP_EVENT_FRAME_REQUEST: No additional data. The child has a frame to render; the
+ *                            host answers with one VSYNC on its next display refresh.
+ *   CMP_EVENT_VSYNC:         64-bit little-endian deadline and presentation time in
+ *                            nanoseconds of the system monotonic clock (System.nanoTime:
+ *                            mach_absolute_time on macOS, CLOCK_MONOTONIC on Linux).
+ *                            A BUFFER_READY before the deadline is shown at the
+ *                            presentation time, which is the child's frame time.
  *
- * Note: IOSurface sharing uses Mach port IPC (see MachPort.h), not socket.
+ * Note: on macOS IOSurface sharing uses Mach port IPC (see MachPort.h), not
+ * the socket. On Linux the swap chain travels on the socket (SWAP_CHAIN).
  *
  * INPUT event payload - see InputEvent.h
  *
  * MIDI event payload - follows EVENT_TYPE_MIDI prefix.
  *   1-byte size + raw MIDI bytes (bidirectional)
  *
+ * MIDI_BUFFER event payload - follows EVENT_TYPE_MIDI_BUFFER prefix (bidirectional).
+ *   4-byte size (little-endian, 1..MIDI_BUFFER_MAX_SIZE), then events in time
+ *   order, each a varint sample position, a varint length and that many raw
+ *   MIDI bytes. Varints are unsigned LEB128: 7 bits per byte, low bits first,
+ *   high bit set on every byte but the last. Lengths are at least 1 and may
+ *   exceed 255 (SysEx). Sample positions come from juce::MidiBuffer and are
+ *   relative to the start of the batch; the sender picks the time base.
+ *
  * JUCE event payload - follows EVENT_TYPE_JUCE prefix.
- *   4-byte size (little-endian) + ValueTree binary data
+ *   4-byte size (little-endian, 1..VALUETREE_MAX_SIZE) + ValueTree binary data
+ *
+ * SYNC event payload - follows EVENT_TYPE_SYNC prefix (bidirectional).
+ *   4-byte size (little-endian, 1..VALUETREE_MAX_SIZE) + one juce::ValueTreeSynchroniser change:
+ *   1-byte change type (SYNC_CHANGE_*), then for all but SYNC_CHANGE_FULL the
+ *   path from the root (compressed int depth + compressed int child indices),
+ *   followed by:
+ *     PROPERTY_CHANGED: property name (NUL-terminated) + var
+ *     PROPERTY_REMOVED: property name (NUL-terminated)
+ *     CHILD_ADDED:      compressed int index + ValueTree
+ *     CHILD_REMOVED:    compressed int index
+ *     CHILD_MOVED:      compressed int old index + compressed int new index
+ *     FULL:             ValueTree (replaces the whole mirrored tree)
+ *
+ * PARAM event payload - follows EVENT_TYPE_PARAM prefix (bidirectional).
+ *   2-byte record count (little-endian, 1..PARAM_MAX_RECORDS), then that many
+ *   PARAM_RECORD_SIZE records: 32-bit id, 32-bit IEEE float value, 1-byte
+ *   PARAM_FLAG_* bitmask, all little-endian. The value is current even for
+ *   gesture records. Host→UI batches carry the latest value of each parameter
+ *   that changed since the previous batch.
+ *
+ * BLOB event payload - follows EVENT_TYPE_BLOB prefix (Host→UI).
+ *   32-bit id + 32-bit size in bytes (little-endian). The region's fd arrives
+ *   as SCM_RIGHTS ancillary data on the type byte, which is sent and received
+ *   on its own so the fd stays with its message. The child maps the region
+ *   and closes the fd; contents are the first size bytes of the mapping.
+ *   With the shared memory transport blobs still use the socket; an
+ *   EVENT_TYPE_SOCKET record in the ring marks their place, so they stay in
+ *   order with ring messages (see below).
+ *
+ * RING event - no payload. Only sent on the socket when the shared memory
+ * transport is enabled, to wake a reader sleeping on an empty ring or a
+ * writer waiting for room in a full one.
+ */
+
+/*
+ * Shared memory ring transport (optional, see SharedRing.h)
+ *
+ * The host maps a region and passes its fd to the child (--shm-fd=<fd>).
+ * Region layout:
+ *   [region header][ring 0 control][ring 0 data][ring 1 control][ring 1 data]
+ *
+ * Ring 0 carries host→UI messages, ring 1 carries UI→host messages. Each
+ * ring is single-producer/single-consumer. Records are a 4-byte length
+ * (little-endian) followed by one message framed exactly as on the socket
+ * (1-byte EVENT_TYPE_* + payload). Records may wrap around the data area.
+ *
+ * Control block fields are native 32-bit atomics holding free-running byte
+ * counters (wrap at 2^32). The reader sets READER_WAITING before sleeping on
+ * the socket; a writer that clears it sends one EVENT_TYPE_RING wakeup. A
+ * writer finding the ring full sets WRITER_WAITING and waits; the reader
+ * clears it after reading and sends one EVENT_TYPE_RING wakeup the other way.
+ *
+ * Messages carrying fds still travel on the socket. The writer puts a 1-byte
+ * EVENT_TYPE_SOCKET record in the ring at their position, and the reader takes
+ * the next socket message other than a wakeup when it reaches that record, so
+ * the order of all messages is kept. Outside of such records, the reader only
+ * expects wakeups on the socket.
+ */
+#define SHM_RING_MAGIC              0x524D434A  /* 'JCMR' */
+#define SHM_RING_VERSION            2
+
+#define SHM_RING_HEADER_SIZE        64   /* Region header: magic, version, capacity */
+#define SHM_RING_HEADER_MAGIC       0
+#define SHM_RING_HEADER_VERSION     4
+#define SHM_RING_HEADER_CAPACITY    8    /* Data bytes per ring (power of two) */
+
+#define SHM_RING_CONTROL_SIZE       256  /* Per-ring control block, one cache line per field */
+#define SHM_RING_WRITE_POS          0
+#define SHM_RING_READ_POS           64
+#define SHM_RING_READER_WAITING     128
+#define SHM_RING_WRITER_WAITING     192
+
+#define SHM_RING_RECORD_HEADER_SIZE 4
+
+/*
+ * Visualization stream (optional, see VisualStream.h)
+ *
+ * A second region, passed as --stream-fd=<fd>, carrying float frames from
+ * the audio thread to the UI without a message per frame. Layout:
+ *   [header][slot 0][slot 1][slot 2]
+ * Each slot holds NUM_FLOATS native floats, padded to SLOT_SIZE bytes.
+ *
+ * STATE is a native 32-bit atomic holding the index of the spare slot, plus
+ * VISUAL_STREAM_FRESH when it holds a frame the reader has not taken yet.
+ * The writer publishes by exchanging its slot for the spare one with FRESH
+ * set; the reader takes a fresh frame by exchanging its slot for the spare
+ * one, then stores the index it now holds in READER_SLOT.
+ */
+#define VISUAL_STREAM_MAGIC             0x564D434A  /* 'JCMV' */
+#define VISUAL_STREAM_VERSION           1
+
+#define VISUAL_STREAM_HEADER_SIZE       64
+#define VISUAL_STREAM_HEADER_MAGIC      0
+#define VISUAL_STREAM_HEADER_VERSION    4
+#define VISUAL_STREAM_HEADER_NUM_FLOATS 8
+#define VISUAL_STREAM_HEADER_SLOT_SIZE  12   /* Bytes per slot, multiple of 64 */
+#define VISUAL_STREAM_HEADER_STATE      16
+#define VISUAL_STREAM_HEADER_READER_SLOT 20
+
+#define VISUAL_STREAM_SLOT_COUNT        3
+#define VISUAL_STREAM_INDEX_MASK        0x3
+#define VISUAL_STREAM_FRESH             0x4
+
+/*
+ * Shared UI process control channel (optional, see UIProcess.h)
+ *
+ * A UI process launched with --control-fd=<fd> serves many editors. Each
+ * editor gets its own socket pair, so every channel speaks the protocol above
+ * unchanged. The host opens a channel by sending on the control socket:
+ *   1-byte CONTROL_OPEN_CHANNEL + 4-byte length (little-endian) + arguments
+ * Arguments are NUL-separated command line flags (--scale, --mach-service).
+ * The message carries SCM_RIGHTS ancillary data: the channel socket first,
+ * then the optional region fds. --shm-fd=<n> and --stream-fd=<n> give their
+ * position in that list instead of an fd number.
+ * Closing the channel socket closes the editor; EOF on the control socket
+ * ends the process.
  */
+#define CONTROL_OPEN_CHANNEL        1
+#define CONTROL_MAX_FDS             3
 
 #ifdef __cplusplus
 }
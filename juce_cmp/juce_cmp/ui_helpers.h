@@ -10,6 +10,18 @@ namespace juce_cmp
 namespace ui_helpers
 {
 
+/**
+ * Returns the UI executable bundled next to the plugin binary (<BinaryName>_UI).
+ *
+ * ComposeComponent launches this by default. Use it to start a UIProcess
+ * ahead of time, e.g. from the AudioProcessor constructor.
+ */
+inline juce::File getUIExecutable()
+{
+    auto execFile = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
+    return execFile.getParentDirectory().getChildFile(execFile.getFileNameWithoutExtension() + "_UI");
+}
+
 /**
  * Hides the native resize corner while keeping it functional.
  *
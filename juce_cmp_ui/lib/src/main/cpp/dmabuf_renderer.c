@@ -0,0 +1,313 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#define GL_GLEXT_PROTOTYPES
+#define EGL_EGLEXT_PROTOTYPES
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <gbm.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+/**
+ * Zero-copy OpenGL renderer for Compose DMA-BUF integration (Linux).
+ *
+ * This library provides a surfaceless EGL context on a DRM render node and
+ * framebuffers backed by the host's DMA-BUFs, which Skia renders to directly
+ * via DirectContext.makeGL() and BackendRenderTarget.makeGL().
+ *
+ * Architecture:
+ * - Kotlin creates the EGL context via createEglContext()
+ * - Each DMA-BUF of a swap chain is imported as an EGLImage-backed texture
+ *   attached to a framebuffer via createTextureFromDmaBuf()
+ * - Skia's DirectContext and BackendRenderTarget use these GL resources
+ * - Compose renders directly to the DMA-BUF - zero CPU pixel copies!
+ */
+
+// Must match DMABUF_MODIFIER_INVALID in ipc_protocol.h
+#define DMABUF_MODIFIER_INVALID 0x00FFFFFFFFFFFFFFULL
+
+typedef void (*FrameFenceCallback)(int32_t token);
+
+// A fence submitted by commitFrameFence(), waited on by the fence thread
+typedef struct PendingFence {
+    EGLSyncKHR sync;
+    FrameFenceCallback callback;
+    int32_t token;
+    struct PendingFence* next;
+} PendingFence;
+
+// EGL context with its render node and the fence thread
+typedef struct {
+    int deviceFD;
+    struct gbm_device* device;
+    EGLDisplay display;
+    EGLContext context;
+    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC imageTargetTexture;
+
+    pthread_t fenceThread;
+    pthread_mutex_t fenceLock;
+    pthread_cond_t fenceCond;
+    PendingFence* fenceHead;
+    PendingFence* fenceTail;
+} EglContext;
+
+// One imported DMA-BUF
+typedef struct {
+    EGLImageKHR image;
+    GLuint texture;
+    GLuint framebuffer;
+} DmaBufTexture;
+
+// Wait for fences in submission order and report each once signaled
+static void* fenceThreadMain(void* arg) {
+    EglContext* ctx = (EglContext*)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&ctx->fenceLock);
+        while (ctx->fenceHead == NULL)
+            pthread_cond_wait(&ctx->fenceCond, &ctx->fenceLock);
+        PendingFence* fence = ctx->fenceHead;
+        ctx->fenceHead = fence->next;
+        if (ctx->fenceHead == NULL)
+            ctx->fenceTail = NULL;
+        pthread_mutex_unlock(&ctx->fenceLock);
+
+        eglClientWaitSyncKHR(ctx->display, fence->sync, 0, EGL_FOREVER_KHR);
+        eglDestroySyncKHR(ctx->display, fence->sync);
+        fence->callback(fence->token);
+        free(fence);
+    }
+
+    return NULL;
+}
+
+// Open the first render node that can render ARGB8888 (the host's Surface picks the same way)
+static int openRenderNode(EglContext* ctx) {
+    for (int minor = 128; minor < 192; minor++) {
+        char path[32];
+        snprintf(path, sizeof(path), "/dev/dri/renderD%d", minor);
+
+        int fd = open(path, O_RDWR | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        struct gbm_device* device = gbm_create_device(fd);
+        if (device != NULL && gbm_device_is_format_supported(device, GBM_FORMAT_ARGB8888, GBM_BO_USE_RENDERING)) {
+            ctx->deviceFD = fd;
+            ctx->device = device;
+            return 1;
+        }
+
+        if (device != NULL)
+            gbm_device_destroy(device);
+        close(fd);
+    }
+
+    return 0;
+}
+
+static void destroyEglContext(EglContext* ctx) {
+    if (ctx->context != EGL_NO_CONTEXT)
+        eglDestroyContext(ctx->display, ctx->context);
+    if (ctx->display != EGL_NO_DISPLAY)
+        eglTerminate(ctx->display);
+    if (ctx->device != NULL)
+        gbm_device_destroy(ctx->device);
+    if (ctx->deviceFD >= 0)
+        close(ctx->deviceFD);
+    free(ctx);
+}
+
+// Create a surfaceless desktop GL context for GPU operations
+void* createEglContext(void) {
+    EglContext* ctx = (EglContext*)calloc(1, sizeof(EglContext));
+    if (ctx == NULL) return NULL;
+    ctx->deviceFD = -1;
+    ctx->display = EGL_NO_DISPLAY;
+    ctx->context = EGL_NO_CONTEXT;
+
+    if (!openRenderNode(ctx)) {
+        destroyEglContext(ctx);
+        return NULL;
+    }
+
+    ctx->display = eglGetPlatformDisplay(EGL_PLATFORM_GBM_KHR, ctx->device, NULL);
+    if (ctx->display == EGL_NO_DISPLAY || !eglInitialize(ctx->display, NULL, NULL)) {
+        ctx->display = EGL_NO_DISPLAY;
+        destroyEglContext(ctx);
+        return NULL;
+    }
+
+    // Skia's GL backend wants desktop GL; nothing is drawn to a window, so no config
+    const char* extensions = eglQueryString(ctx->display, EGL_EXTENSIONS);
+    if (extensions == NULL
+        || strstr(extensions, "EGL_KHR_no_config_context") == NULL
+        || strstr(extensions, "EGL_KHR_surfaceless_context") == NULL
+        || strstr(extensions, "EGL_EXT_image_dma_buf_import") == NULL
+        || strstr(extensions, "EGL_KHR_fence_sync") == NULL
+        || !eglBindAPI(EGL_OPENGL_API)) {
+        destroyEglContext(ctx);
+        return NULL;
+    }
+
+    ctx->context = eglCreateContext(ctx->display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, NULL);
+    ctx->imageTargetTexture = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)eglGetProcAddress("glEGLImageTargetTexture2DOES");
+    if (ctx->context == EGL_NO_CONTEXT || ctx->imageTargetTexture == NULL) {
+        destroyEglContext(ctx);
+        return NULL;
+    }
+
+    pthread_mutex_init(&ctx->fenceLock, NULL);
+    pthread_cond_init(&ctx->fenceCond, NULL);
+    if (pthread_create(&ctx->fenceThread, NULL, fenceThreadMain, ctx) != 0) {
+        pthread_cond_destroy(&ctx->fenceCond);
+        pthread_mutex_destroy(&ctx->fenceLock);
+        destroyEglContext(ctx);
+        return NULL;
+    }
+    pthread_detach(ctx->fenceThread);
+
+    // The context lives as long as the process, like the Metal device on macOS
+    return ctx;
+}
+
+// Bind the context to the calling thread (one thread at a time)
+// Returns 1 on success, 0 on failure
+int makeEglContextCurrent(void* context) {
+    if (context == NULL) return 0;
+
+    EglContext* ctx = (EglContext*)context;
+    return eglMakeCurrent(ctx->display, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx->context) ? 1 : 0;
+}
+
+// Unbind the context from the calling thread so another thread can take it
+void clearEglContextCurrent(void* context) {
+    if (context == NULL) return;
+
+    EglContext* ctx = (EglContext*)context;
+    eglMakeCurrent(ctx->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+// Import a single-plane DMA-BUF as a texture attached to a new framebuffer
+// The EGLImage keeps its own reference to the buffer; the caller still owns fd.
+// Returns an opaque texture (caller must release via releaseDmaBufTexture), or NULL on failure.
+// Call with the context current.
+void* createTextureFromDmaBuf(void* context, int fd, int width, int height, uint32_t format,
+                              uint32_t stride, uint32_t offset, uint64_t modifier, GLuint* outFramebuffer) {
+    if (context == NULL || fd < 0 || width <= 0 || height <= 0) return NULL;
+
+    EglContext* ctx = (EglContext*)context;
+
+    EGLAttrib attribs[] = {
+        EGL_WIDTH, width,
+        EGL_HEIGHT, height,
+        EGL_LINUX_DRM_FOURCC_EXT, format,
+        EGL_DMA_BUF_PLANE0_FD_EXT, fd,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT, offset,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT, stride,
+        EGL_NONE, 0,
+        EGL_NONE, 0,
+        EGL_NONE
+    };
+
+    // An explicit layout needs EGL_EXT_image_dma_buf_import_modifiers
+    if (modifier != DMABUF_MODIFIER_INVALID) {
+        attribs[12] = EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT;
+        attribs[13] = (EGLAttrib)(modifier & 0xFFFFFFFF);
+        attribs[14] = EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT;
+        attribs[15] = (EGLAttrib)(modifier >> 32);
+    }
+
+    EGLImageKHR image = eglCreateImage(ctx->display, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, NULL, attribs);
+    if (image == EGL_NO_IMAGE_KHR) return NULL;
+
+    DmaBufTexture* tex = (DmaBufTexture*)calloc(1, sizeof(DmaBufTexture));
+    if (tex == NULL) {
+        eglDestroyImage(ctx->display, image);
+        return NULL;
+    }
+    tex->image = image;
+
+    glGenTextures(1, &tex->texture);
+    glBindTexture(GL_TEXTURE_2D, tex->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    ctx->imageTargetTexture(GL_TEXTURE_2D, (GLeglImageOES)image);
+
+    glGenFramebuffers(1, &tex->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, tex->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex->texture, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        glDeleteFramebuffers(1, &tex->framebuffer);
+        glDeleteTextures(1, &tex->texture);
+        eglDestroyImage(ctx->display, image);
+        free(tex);
+        return NULL;
+    }
+
+    if (outFramebuffer) *outFramebuffer = tex->framebuffer;
+    return tex;
+}
+
+// Release a texture returned by createTextureFromDmaBuf
+// Call with the context current.
+void releaseDmaBufTexture(void* context, void* texture) {
+    if (context == NULL || texture == NULL) return;
+
+    EglContext* ctx = (EglContext*)context;
+    DmaBufTexture* tex = (DmaBufTexture*)texture;
+
+    glDeleteFramebuffers(1, &tex->framebuffer);
+    glDeleteTextures(1, &tex->texture);
+    eglDestroyImage(ctx->display, tex->image);
+    free(tex);
+}
+
+// Invoke callback(token) once all GPU work submitted so far has completed.
+// Lets the render loop pipeline frames instead of waiting on the CPU.
+// Call with the context current.
+void commitFrameFence(void* context, FrameFenceCallback callback, int32_t token) {
+    if (context == NULL || callback == NULL) return;
+
+    EglContext* ctx = (EglContext*)context;
+
+    PendingFence* fence = (PendingFence*)malloc(sizeof(PendingFence));
+    if (fence == NULL) return;
+
+    // The fence signals after every command before it; flush so it gets there
+    fence->sync = eglCreateSyncKHR(ctx->display, EGL_SYNC_FENCE_KHR, NULL);
+    if (fence->sync == EGL_NO_SYNC_KHR) {
+        free(fence);
+        glFinish();
+        callback(token);
+        return;
+    }
+    glFlush();
+
+    fence->callback = callback;
+    fence->token = token;
+    fence->next = NULL;
+
+    pthread_mutex_lock(&ctx->fenceLock);
+    if (ctx->fenceTail != NULL)
+        ctx->fenceTail->next = fence;
+    else
+        ctx->fenceHead = fence;
+    ctx->fenceTail = fence;
+    pthread_cond_signal(&ctx->fenceCond);
+    pthread_mutex_unlock(&ctx->fenceLock);
+}
@@ -2,7 +2,6 @@
 // SPDX-License-Identifier: MIT
 
 #import <stdlib.h>
-#import <unistd.h>
 #import <mach/mach.h>
 #import <servers/bootstrap.h>
 #import <IOSurface/IOSurface.h>
@@ -28,6 +27,9 @@ typedef struct {
     id<MTLCommandQueue> commandQueue;
 } MetalContext;
 
+// Must match SWAP_CHAIN_MAX_BUFFERS in ipc_protocol.h
+#define SWAP_CHAIN_MAX_BUFFERS 4
+
 // Mach port channel for receiving IOSurface ports from parent
 typedef struct {
     mach_port_t receivePort;  // Our receive port
@@ -101,18 +103,6 @@ void flushAndSync(void* context) {
     }
 }
 
-// Read data from a socket file descriptor
-// Returns number of bytes read, or -1 on error
-ssize_t socketRead(int socketFD, void* buffer, size_t length) {
-    return read(socketFD, buffer, length);
-}
-
-// Write data to a socket file descriptor
-// Returns number of bytes written, or -1 on error
-ssize_t socketWrite(int socketFD, const void* buffer, size_t length) {
-    return write(socketFD, buffer, length);
-}
-
 // Connect to parent's Mach service and establish bidirectional channel
 // Returns opaque channel handle or NULL on failure
 void* machChannelConnect(const char* serviceName) {
@@ -184,19 +174,22 @@ void* machChannelConnect(const char* serviceName) {
     return channel;
 }
 
-// Receive an IOSurface port from parent (blocking)
-// Returns IOSurfaceRef (caller must CFRelease) or NULL on failure/disconnect
-IOSurfaceRef machChannelReceiveSurface(void* channelPtr) {
-    if (channelPtr == NULL) return NULL;
+// Receive a swap chain from parent (blocking)
+// Fills outSurfaces (caller must CFRelease each) and outGeneration.
+// Returns the number of surfaces, or -1 on failure/disconnect
+int machChannelReceiveSwapChain(void* channelPtr, IOSurfaceRef* outSurfaces, int maxSurfaces, uint32_t* outGeneration) {
+    if (channelPtr == NULL || outSurfaces == NULL) return -1;
 
     MachChannel* channel = (MachChannel*)channelPtr;
-    if (!channel->connected) return NULL;
+    if (!channel->connected) return -1;
 
-    // Receive message with port descriptor
+    // Receive message with port descriptors (layout: see MachPort.h)
     struct {
         mach_msg_header_t header;
         mach_msg_body_t body;
-        mach_msg_port_descriptor_t portDescriptor;
+        mach_msg_port_descriptor_t portDescriptors[SWAP_CHAIN_MAX_BUFFERS];
+        uint32_t count;
+        uint32_t generation;
         mach_msg_trailer_t trailer;
     } msg = {};
 
@@ -211,18 +204,61 @@ IOSurfaceRef machChannelReceiveSurface(void* channelPtr) {
     );
 
     if (kr != KERN_SUCCESS)
-        return NULL;
+        return -1;
+
+    int count = 0;
+    for (int i = 0; i < SWAP_CHAIN_MAX_BUFFERS; i++) {
+        mach_port_t surfacePort = msg.portDescriptors[i].name;
+        if (surfacePort == MACH_PORT_NULL)
+            continue;
+
+        // Convert Mach port to IOSurface
+        IOSurfaceRef surface = IOSurfaceLookupFromMachPort(surfacePort);
+        mach_port_deallocate(mach_task_self(), surfacePort);
+
+        if (surface == NULL)
+            continue;
+        if (count < maxSurfaces && count < (int)msg.count)
+            outSurfaces[count++] = surface;
+        else
+            CFRelease(surface);
+    }
+
+    if (outGeneration) *outGeneration = msg.generation;
+    return count > 0 ? count : -1;
+}
 
-    mach_port_t surfacePort = msg.portDescriptor.name;
+// Release an IOSurface received through the Mach channel
+void releaseIOSurface(IOSurfaceRef surface) {
+    if (surface != NULL)
+        CFRelease(surface);
+}
 
-    // Convert Mach port to IOSurface
-    IOSurfaceRef surface = IOSurfaceLookupFromMachPort(surfacePort);
-    mach_port_deallocate(mach_task_self(), surfacePort);
+// Check if an IOSurface is still in use by another process (e.g. the host's layer)
+int ioSurfaceIsInUse(IOSurfaceRef surface) {
+    if (surface == NULL) return 0;
+    return IOSurfaceIsInUse(surface) ? 1 : 0;
+}
 
-    if (surface == NULL)
-        return NULL;
+// Invoke callback(token) once all GPU work committed so far has completed.
+// Lets the render loop pipeline frames instead of waiting on the CPU.
+typedef void (*FrameFenceCallback)(int32_t token);
+
+void commitFrameFence(void* context, FrameFenceCallback callback, int32_t token) {
+    if (context == NULL || callback == NULL) return;
+
+    @autoreleasepool {
+        MetalContext* ctx = (MetalContext*)context;
 
-    return surface;  // Caller must CFRelease
+        // Command buffers on a queue complete in order, so an empty one
+        // committed after Skia's submit completes after the frame does
+        id<MTLCommandBuffer> commandBuffer = [ctx->commandQueue commandBuffer];
+        [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+            (void)buffer;
+            callback(token);
+        }];
+        [commandBuffer commit];
+    }
 }
 
 // Close the Mach channel
@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+
+/**
+ * Socket and shared memory access for the Kotlin IPC (Ipc.kt).
+ *
+ * Plain POSIX, built into the native renderer library of each platform
+ * (iosurface_renderer on macOS, dmabuf_renderer on Linux).
+ */
+
+// Read data from a socket file descriptor
+// Returns number of bytes read, or -1 on error
+ssize_t socketRead(int socketFD, void* buffer, size_t length) {
+    return read(socketFD, buffer, length);
+}
+
+// Write data to a socket file descriptor
+// Returns number of bytes written, or -1 on error
+ssize_t socketWrite(int socketFD, const void* buffer, size_t length) {
+    return write(socketFD, buffer, length);
+}
+
+// Shut down and close a socket file descriptor (editor channels of a shared UI process)
+// A reader blocked on it sees EOF after socketShutdown()
+void socketShutdown(int socketFD) {
+    shutdown(socketFD, SHUT_RDWR);
+}
+
+void socketClose(int socketFD) {
+    close(socketFD);
+}
+
+// Read data received together with file descriptors (SCM_RIGHTS) from the control socket
+// Stores up to maxFDs descriptors in outFDs and their count in outNumFDs
+// Returns number of bytes read, or -1 on error
+ssize_t socketReceiveFDs(int socketFD, void* buffer, size_t length, int* outFDs, int maxFDs, int* outNumFDs) {
+    char control[CMSG_SPACE(sizeof(int) * 4)];
+    struct iovec iov = { buffer, length };
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    *outNumFDs = 0;
+    ssize_t n = recvmsg(socketFD, &msg, 0);
+    if (n <= 0)
+        return n;
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+        int count = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        int* fds = (int*)CMSG_DATA(cmsg);
+        for (int i = 0; i < count; i++) {
+            if (*outNumFDs < maxFDs)
+                outFDs[(*outNumFDs)++] = fds[i];
+            else
+                close(fds[i]);  // More than the caller expects - don't leak them
+        }
+    }
+
+    return n;
+}
+
+// Map the shared memory ring region inherited from the parent
+// Returns base address (and region size in outSize), or NULL on failure
+void* shmMap(int fd, size_t* outSize) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+        return NULL;
+
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+
+    // The mapping keeps the region alive; the fd is no longer needed
+    close(fd);
+
+    if (outSize) *outSize = (size_t)st.st_size;
+    return base;
+}
+
+// Unmap a region returned by shmMap
+void shmUnmap(void* base, size_t size) {
+    if (base != NULL)
+        munmap(base, size);
+}
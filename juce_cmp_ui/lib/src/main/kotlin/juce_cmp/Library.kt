@@ -4,9 +4,18 @@
 package juce_cmp
 
 import androidx.compose.runtime.Composable
+import juce_cmp.ipc.ControlChannel
 import juce_cmp.ipc.Ipc
 import juce_cmp.ipc.JuceValueTree
+import juce_cmp.ipc.JuceValueTreeVisitor
+import juce_cmp.ipc.JuceValueTreeWriter
+import juce_cmp.ipc.ParameterHandler
+import juce_cmp.ipc.SharedBlob
+import juce_cmp.ipc.SyncedValueTree
+import juce_cmp.ipc.VisualStream
 import juce_cmp.renderer.runIOSurfaceRenderer
+import juce_cmp.renderer.warmUpIOSurfaceRenderer
+import javax.sound.midi.MidiEvent
 import javax.sound.midi.MidiMessage
 import java.io.FileDescriptor
 import java.io.FileOutputStream
@@ -17,10 +26,21 @@ import java.io.PrintStream
  *
  * Client applications MUST call init() as the very first thing in main(),
  * before any other code runs. This sets up the socket-based IPC channel.
+ *
+ * A host may also launch one shared UI process for many editors
+ * (--control-fd), often before any editor opens. host() then composes the
+ * content once offscreen to warm up, and renders one scene per editor
+ * channel, each on its own thread, until the host closes the control socket.
+ *
+ * The build launches the app once with --training-run to record the classes
+ * it loads into a class data sharing archive (README, Startup Archive). host()
+ * then renders a few frames offscreen and exits, without any host.
  */
 object Library {
     private var initialized = false
     private var socketFD: Int? = null
+    private var controlFD: Int? = null
+    private var trainingRun = false
     private var scaleFactor: Float = 1f
     private var machServiceName: String? = null
     private var ipc: Ipc? = null
@@ -29,22 +49,62 @@ object Library {
      * Whether the application was launched by a host.
      */
     val hasHost: Boolean
-        get() = socketFD != null
+        get() = socketFD != null || controlFD != null || trainingRun
 
     /**
-     * Send a JuceValueTree event to the host.
+     * Send a JuceValueTree event to the host. Returns false if it was not sent.
+     * In a shared UI process it goes to the editor of the calling render or IPC thread.
      */
-    fun sendJuceEvent(tree: JuceValueTree) {
-        ipc?.sendJuceEvent(tree)
+    fun sendJuceEvent(tree: JuceValueTree): Boolean =
+        (Ipc.current.get() ?: ipc)?.sendJuceEvent(tree) ?: false
+
+    /**
+     * Send the tree encoded by a JuceValueTreeWriter to the host, without
+     * allocating. Reuse the writer (reset()) for the next event. Returns false if it was not sent.
+     */
+    fun sendJuceEvent(writer: JuceValueTreeWriter): Boolean =
+        (Ipc.current.get() ?: ipc)?.sendJuceEvent(writer) ?: false
+
+    /**
+     * ValueTree mirrored from the host (ComposeComponent::setSyncedTree), or null without a host.
+     * In a shared UI process it is the one of the calling render or IPC thread's editor.
+     */
+    val syncedTree: SyncedValueTree?
+        get() = (Ipc.current.get() ?: ipc)?.syncedTree
+
+    /**
+     * Float frames from the host's audio thread (ComposeProvider::setVisualStream),
+     * or null if the host did not enable it. Read [VisualStream.latest] once per frame.
+     */
+    val visualStream: VisualStream?
+        get() = (Ipc.current.get() ?: ipc)?.visualStream
+
+    /**
+     * Send a parameter value to the host (ComposeComponent::onParameter) without
+     * allocating. Wrap drags in Param.FLAG_GESTURE_BEGIN/END records so the
+     * host can group automation. In a shared UI process it goes to the editor
+     * of the calling render or IPC thread.
+     */
+    fun sendParameter(id: Int, value: Float, flags: Int = 0) {
+        (Ipc.current.get() ?: ipc)?.sendParameter(id, value, flags)
     }
 
     /**
      * Send a MIDI message to the host.
+     * In a shared UI process it goes to the editor of the calling render or IPC thread.
      */
     fun sendMidiEvent(message: MidiMessage) {
-        ipc?.sendMidiEvent(message)
+        (Ipc.current.get() ?: ipc)?.sendMidiEvent(message)
     }
 
+    /**
+     * Send several MIDI messages to the host in one message, each event's tick
+     * becoming its sample position (ComposeProvider::setMidiBufferCallback).
+     * Messages may be SysEx of any length. Returns false if they were not sent.
+     */
+    fun sendMidiEvents(events: List<MidiEvent>): Boolean =
+        (Ipc.current.get() ?: ipc)?.sendMidiEvents(events) ?: false
+
     /**
      * Initialize the juce_cmp library.
      *
@@ -62,6 +122,28 @@ object Library {
         if (initialized) return
         initialized = true
 
+        // Parse --training-run: record startup classes for the build, no host
+        if (args.contains("--training-run")) {
+            System.setProperty("apple.awt.UIElement", "true")
+            trainingRun = true
+            return
+        }
+
+        // Parse --control-fd=<fd> to detect a shared UI process
+        val controlArg = args.firstOrNull { it.startsWith("--control-fd=") }
+        if (controlArg != null) {
+            System.setProperty("apple.awt.UIElement", "true")
+
+            controlFD = controlArg
+                .substringAfter("=")
+                .toIntOrNull()
+                ?: error("Invalid --control-fd value")
+
+            // Channels bring their own settings (see host())
+            System.setOut(PrintStream(FileOutputStream(FileDescriptor.err), true))
+            return
+        }
+
         // Parse --socket-fd=<fd> to detect embedded mode
         val socketArg = args.firstOrNull { it.startsWith("--socket-fd=") }
         if (socketArg != null) {
@@ -85,8 +167,20 @@ object Library {
                 .firstOrNull { it.startsWith("--mach-service=") }
                 ?.substringAfter("=")
 
+            // Parse --shm-fd=<fd> for the optional shared memory transport
+            val shmFD = args
+                .firstOrNull { it.startsWith("--shm-fd=") }
+                ?.substringAfter("=")
+                ?.toIntOrNull()
+
+            // Parse --stream-fd=<fd> for the optional visualization stream
+            val streamFD = args
+                .firstOrNull { it.startsWith("--stream-fd=") }
+                ?.substringAfter("=")
+                ?.toIntOrNull()
+
             // Create IPC channel on the inherited socket FD
-            ipc = Ipc(socketFD!!)
+            ipc = Ipc(socketFD!!, shmFD, streamFD)
 
             // Redirect System.out to stderr so library noise doesn't corrupt our protocol
             System.setOut(PrintStream(FileOutputStream(FileDescriptor.err), true))
@@ -101,15 +195,34 @@ object Library {
      *
      * @param onJuceEvent Optional callback when host sends JuceValueTree events
      * @param onMidiEvent Optional callback when host sends MIDI messages
+     * @param onParameter Optional callback for parameter values from the host (ComposeComponent::setParameter)
+     * @param onBlob Optional callback for large payloads from the host (ComposeComponent::sendBlob), on the
+     *   receiver thread. The callee owns the blob and must close it once done
+     * @param juceEventVisitor Optional decoder for JUCE events on the receiver thread, walking each
+     *   message in place instead of building a JuceValueTree. onJuceEvent is not called when set
      * @param onFrameRendered Optional callback after each frame (for debugging/capture)
      * @param content The Compose content to render
      */
     fun host(
         onJuceEvent: ((tree: JuceValueTree) -> Unit)? = null,
         onMidiEvent: ((message: MidiMessage) -> Unit)? = null,
+        onParameter: ParameterHandler? = null,
+        onBlob: ((blob: SharedBlob) -> Unit)? = null,
         onFrameRendered: ((frameNumber: Long, surface: org.jetbrains.skia.Surface) -> Unit)? = null,
+        juceEventVisitor: JuceValueTreeVisitor? = null,
         content: @Composable () -> Unit
     ) {
+        if (trainingRun) {
+            // Same code paths as the first editor frame: GPU setup, composition, render
+            warmUpIOSurfaceRenderer(content, TRAINING_FRAMES)
+            kotlin.system.exitProcess(0)
+        }
+
+        controlFD?.let { fd ->
+            hostChannels(fd, onJuceEvent, onMidiEvent, onParameter, onBlob, onFrameRendered, juceEventVisitor, content)
+            return
+        }
+
         val fd = socketFD ?: error("host() called but not in embedded mode")
         val channel = ipc ?: error("host() called but IPC not initialized")
 
@@ -121,7 +234,67 @@ object Library {
             onFrameRendered = onFrameRendered,
             onJuceEvent = onJuceEvent,
             onMidiEvent = onMidiEvent,
+            onParameter = onParameter,
+            onBlob = onBlob,
+            juceEventVisitor = juceEventVisitor,
             content = content
         )
     }
+
+    /**
+     * Shared UI process: render one scene per editor channel the host opens,
+     * each on its own thread, until the control socket closes.
+     */
+    private fun hostChannels(
+        controlFD: Int,
+        onJuceEvent: ((tree: JuceValueTree) -> Unit)?,
+        onMidiEvent: ((message: MidiMessage) -> Unit)?,
+        onParameter: ParameterHandler?,
+        onBlob: ((blob: SharedBlob) -> Unit)?,
+        onFrameRendered: ((frameNumber: Long, surface: org.jetbrains.skia.Surface) -> Unit)?,
+        juceEventVisitor: JuceValueTreeVisitor?,
+        content: @Composable () -> Unit
+    ) {
+        val control = ControlChannel(controlFD)
+
+        // The host may start this process before any editor opens - get ready meanwhile
+        try {
+            warmUpIOSurfaceRenderer(content)
+        } catch (e: Exception) {
+            // Not fatal, the first channel initializes lazily
+        }
+
+        while (true) {
+            val channel = control.receive() ?: break
+
+            Thread({
+                val channelIpc = Ipc(channel.socketFD, channel.shmFD, channel.streamFD, exitOnClose = false)
+                try {
+                    runIOSurfaceRenderer(
+                        socketFD = channel.socketFD,
+                        scaleFactor = channel.scaleFactor,
+                        machServiceName = channel.machServiceName,
+                        ipc = channelIpc,
+                        onFrameRendered = onFrameRendered,
+                        onJuceEvent = onJuceEvent,
+                        onMidiEvent = onMidiEvent,
+                        onParameter = onParameter,
+                        onBlob = onBlob,
+                        juceEventVisitor = juceEventVisitor,
+                        content = content
+                    )
+                } catch (e: Exception) {
+                    // A broken channel must not take the other editors down
+                } finally {
+                    channelIpc.close()
+                }
+            }, "Channel-${channel.socketFD}").start()
+        }
+
+        // Host closed the control socket - all editors are gone
+        kotlin.system.exitProcess(0)
+    }
+
+    // Enough frames for animations to load their classes too
+    private const val TRAINING_FRAMES = 60
 }
@@ -7,6 +7,7 @@ import androidx.compose.ui.InternalComposeUiApi
 import androidx.compose.ui.geometry.Offset
 import androidx.compose.ui.input.pointer.*
 import androidx.compose.ui.scene.ComposeScene
+import java.util.Queue
 
 /**
  * Dispatches input events from the binary protocol to a ComposeScene.
@@ -27,7 +28,61 @@ class InputDispatcher(
     private var lastPosition = Offset.Zero
     private var pressedButtons = mutableSetOf<Int>()
     private val pointerId = PointerId(0)
+
+    /** Host timestamp of the oldest event in the last dispatchAll(), 0 if it had none. */
+    var oldestTimestamp = 0L
+        private set
+
+    /** When the child received that event (System.nanoTime). */
+    var oldestReceivedNanos = 0L
+        private set
     
+    /**
+     * Drain the queue, merging consecutive mouse moves (latest position wins)
+     * and consecutive scrolls (deltas add up) so a frame dispatches at most one
+     * of each run. Presses, releases and keys keep their exact order.
+     * Must be called on the main/render thread.
+     */
+    fun dispatchAll(queue: Queue<InputEvent>) {
+        oldestTimestamp = 0L
+        var pending: InputEvent? = null
+        while (true) {
+            val event = queue.poll() ?: break
+            if (oldestTimestamp == 0L) {
+                oldestTimestamp = event.timestamp
+                oldestReceivedNanos = event.receivedNanos
+            }
+            val held = pending
+            if (held != null && canMerge(held, event)) {
+                pending = merge(held, event)
+                continue
+            }
+            if (held != null) dispatch(held)
+            if (isCoalescable(event)) {
+                pending = event
+            } else {
+                pending = null
+                dispatch(event)
+            }
+        }
+        pending?.let { dispatch(it) }
+    }
+
+    private fun isCoalescable(event: InputEvent) =
+        event.type == InputType.MOUSE &&
+            (event.action == InputAction.MOVE || event.action == InputAction.SCROLL)
+
+    private fun canMerge(held: InputEvent, event: InputEvent) =
+        isCoalescable(event) && event.action == held.action &&
+            event.button == held.button && event.modifiers == held.modifiers
+
+    private fun merge(held: InputEvent, event: InputEvent): InputEvent =
+        if (event.action == InputAction.SCROLL) {
+            event.copy(data1 = held.data1 + event.data1, data2 = held.data2 + event.data2)
+        } else {
+            event
+        }
+
     /**
      * Dispatch an input event to the Compose scene.
      * Must be called on the main/render thread.
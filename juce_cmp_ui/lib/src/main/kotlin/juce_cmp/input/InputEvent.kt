@@ -58,7 +58,8 @@ data class InputEvent(
     val y: Int,           // Mouse Y or height
     val data1: Int,       // Scroll X (*10000) or codepoint low
     val data2: Int,       // Scroll Y (*10000) or codepoint high
-    val timestamp: Long   // Milliseconds
+    val timestamp: Long,  // Milliseconds, host clock
+    val receivedNanos: Long = 0  // System.nanoTime() when the child received it
 ) {
     /** For scroll events, get the scroll delta X */
     val scrollX: Float get() = data1 / 10000f
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.ipc
+
+import com.sun.jna.Memory
+import com.sun.jna.ptr.IntByReference
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Control socket of a shared UI process (--control-fd, see UIProcess.h).
+ *
+ * The host opens one channel per editor: a socket of its own plus the
+ * optional shared memory and visualization stream fds, passed with
+ * SCM_RIGHTS. Each channel then speaks the regular protocol through its own Ipc.
+ */
+internal class ControlChannel(private val controlFD: Int) {
+    /** An editor channel, with the same settings a dedicated child gets on its command line. */
+    class OpenChannel(
+        val socketFD: Int,
+        val shmFD: Int?,
+        val streamFD: Int?,
+        val scaleFactor: Float,
+        val machServiceName: String?
+    )
+
+    private val buffer = Memory(1024)
+    private val fds = Memory(4L * Control.MAX_FDS)
+
+    /**
+     * Block until the host opens a channel. Returns null once the host closes
+     * the control socket, which means the shared process should exit.
+     */
+    fun receive(): OpenChannel? {
+        while (true) {
+            // Descriptors arrive with the first bytes of the message
+            val numFDs = IntByReference()
+            val n = SocketLib.INSTANCE.socketReceiveFDs(
+                controlFD, buffer, Control.HEADER_SIZE.toLong(), fds, Control.MAX_FDS, numFDs
+            )
+            if (n <= 0) return null
+
+            val received = IntArray(numFDs.value) { fds.getInt(4L * it) }
+            val header = readRest(n.toInt(), Control.HEADER_SIZE) ?: return null
+            val type = header[0].toInt() and 0xFF
+            val length = ByteBuffer.wrap(header, 1, 4).order(ByteOrder.LITTLE_ENDIAN).int
+            val args = readRest(0, length) ?: return null
+
+            if (type != Control.OPEN_CHANNEL || received.isEmpty()) {
+                received.forEach { SocketLib.INSTANCE.socketClose(it) }
+                continue
+            }
+
+            val values = String(args, Charsets.UTF_8).split('\u0000').filter { it.isNotEmpty() }
+            fun value(flag: String) = values.firstOrNull { it.startsWith(flag) }?.substringAfter("=")
+
+            // fd flags give a position in the received list rather than an fd number
+            fun fd(flag: String) = value(flag)?.toIntOrNull()?.let { received.getOrNull(it) }
+
+            return OpenChannel(
+                socketFD = received[0],
+                shmFD = fd("--shm-fd="),
+                streamFD = fd("--stream-fd="),
+                scaleFactor = value("--scale=")?.toFloatOrNull() ?: 1f,
+                machServiceName = value("--mach-service=")
+            )
+        }
+    }
+
+    /**
+     * Complete a read of size bytes of which the first `have` are already in buffer.
+     */
+    private fun readRest(have: Int, size: Int): ByteArray? {
+        val data = ByteArray(size)
+        buffer.read(0, data, 0, have)
+        var offset = have
+        while (offset < size) {
+            val toRead = minOf(buffer.size(), (size - offset).toLong())
+            val n = SocketLib.INSTANCE.socketRead(controlFD, buffer, toRead)
+            if (n <= 0) return null
+            buffer.read(0, data, offset, n.toInt())
+            offset += n.toInt()
+        }
+        return data
+    }
+}
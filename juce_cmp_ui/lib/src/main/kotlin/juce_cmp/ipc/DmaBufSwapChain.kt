@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.ipc
+
+import java.util.concurrent.atomic.AtomicBoolean
+
+/**
+ * Swap chain sent by the host on Linux (CMP_EVENT_SWAP_CHAIN, Surface_linux.cpp).
+ *
+ * Each buffer is a DMA-BUF the host allocated on its render node. The receiver
+ * owns the fds: import them into the GPU API, which keeps its own references,
+ * then [close] the chain.
+ */
+class DmaBufSwapChain internal constructor(
+    /** Generation of the chain, as in BUFFER_READY. */
+    val generation: Int,
+    /** Buffer dimensions, which may exceed the scene (Surface::sizeBucket). */
+    val width: Int,
+    val height: Int,
+    /** DRM fourcc format, DmaBuf.FORMAT_ARGB8888. */
+    val format: Int,
+    /** DRM format modifier, DmaBuf.MODIFIER_INVALID for the driver's implicit layout. */
+    val modifier: Long,
+    val buffers: List<Buffer>
+) : AutoCloseable {
+    class Buffer(val fd: Int, val stride: Int, val offset: Int)
+
+    private val closed = AtomicBoolean(false)
+
+    /** Close the fds. Safe to call more than once. */
+    override fun close() {
+        if (closed.compareAndSet(false, true)) {
+            buffers.forEach { SocketLib.INSTANCE.socketClose(it.fd) }
+        }
+    }
+}
@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.ipc
+
+/**
+ * Costs of one rendered frame, reported to the host while it collects
+ * timings (CmpEvent.FRAME_TIMING, see FrameStats.h). Times are microseconds.
+ * Mutable so the renderer can keep one per buffer instead of allocating.
+ */
+class FrameTiming {
+    /** Host timestamp of the oldest input dispatched for the frame, 0 if none. */
+    var inputTimestamp = 0L
+    /** How long that input waited in the child before dispatch. */
+    var queueMicros = 0
+    var dispatchMicros = 0
+    var renderMicros = 0
+    var flushMicros = 0
+    var gpuMicros = 0
+}
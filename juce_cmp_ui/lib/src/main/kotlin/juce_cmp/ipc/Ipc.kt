@@ -6,9 +6,14 @@ package juce_cmp.ipc
 import com.sun.jna.Library
 import com.sun.jna.Memory
 import com.sun.jna.Native
+import com.sun.jna.Platform
 import com.sun.jna.Pointer
+import com.sun.jna.ptr.IntByReference
+import com.sun.jna.ptr.LongByReference
+import java.io.ByteArrayOutputStream
 import java.nio.ByteBuffer
 import java.nio.ByteOrder
+import javax.sound.midi.MidiEvent
 import javax.sound.midi.MidiMessage
 import javax.sound.midi.ShortMessage
 import javax.sound.midi.SysexMessage
@@ -17,18 +22,35 @@ import juce_cmp.input.InputEvent
 /**
  * Native library interface for socket I/O operations.
  */
-private interface SocketLib : Library {
+internal interface SocketLib : Library {
     fun socketRead(socketFD: Int, buffer: Pointer, length: Long): Long
     fun socketWrite(socketFD: Int, buffer: Pointer, length: Long): Long
+    fun socketShutdown(socketFD: Int)
+    fun socketClose(socketFD: Int)
+    fun socketReceiveFDs(socketFD: Int, buffer: Pointer, length: Long, outFDs: Pointer, maxFDs: Int, outNumFDs: IntByReference): Long
+    fun shmMap(fd: Int, outSize: LongByReference): Pointer?
+    fun shmUnmap(base: Pointer, size: Long)
 
     companion object {
+        /** Native library bundled for this OS (see CMakeLists.txt). */
+        val LIBRARY = if (Platform.isMac()) "iosurface_renderer" else "dmabuf_renderer"
+
         val INSTANCE: SocketLib by lazy {
-            val libFile = Native.extractFromResourcePath("iosurface_renderer")
+            val libFile = Native.extractFromResourcePath(LIBRARY)
             Native.load(libFile.absolutePath, SocketLib::class.java)
         }
     }
 }
 
+/**
+ * Receives parameter records from the host. Unlike a Kotlin function type it
+ * takes primitives, so delivering a record does not box.
+ */
+fun interface ParameterHandler {
+    /** flags is a Param.FLAG_* bitmask. */
+    fun onParameter(id: Int, value: Float, flags: Int)
+}
+
 /**
  * Bidirectional IPC channel between UI and host process.
  *
@@ -36,18 +58,83 @@ private interface SocketLib : Library {
  * Protocol: 1-byte event type followed by type-specific payload.
  * See ipc_protocol.h for details.
  *
+ * When the host passes a shared memory fd, messages travel through the
+ * shared rings instead (see SharedRing.kt) and the socket only carries
+ * wakeups. EOF on the socket still means the host went away.
+ *
  * - Receiving runs on a background thread (host → UI)
  * - Sending is synchronous and thread-safe (UI → host)
+ *
+ * In a shared UI process there is one Ipc per editor channel (see
+ * ControlChannel.kt); EOF then ends only that channel instead of the process.
+ *
+ * @param socketFD Inherited socket file descriptor (--socket-fd), or a channel socket
+ * @param shmFD Inherited shared memory fd (--shm-fd), or null for socket only
+ * @param streamFD Visualization stream fd (--stream-fd), or null if the host has none
+ * @param exitOnClose Exit the process when the host closes the socket
  */
-class Ipc(private val socketFD: Int) {
+class Ipc(
+    private val socketFD: Int,
+    shmFD: Int? = null,
+    streamFD: Int? = null,
+    private val exitOnClose: Boolean = true
+) {
     @Volatile
     private var running = false
     private var thread: Thread? = null
+    private var receiverThread: Thread? = null  // Kept after stopReceiving() for close()
     private val writeLock = Any()
+    private val ringSpace = Object()  // Notified when the host has read from the TX ring
+
+    // Shared memory transport (optional)
+    private val shmSize = LongByReference()
+    private val shmBase: Pointer? = shmFD?.let { fd ->
+        SocketLib.INSTANCE.shmMap(fd, shmSize) ?: error("Failed to map shared memory")
+    }
+    private val ring: SharedRing? = shmBase?.let { SharedRing(it.getByteBuffer(0, shmSize.value)) }
+
+    // Visualization stream (optional)
+    private val streamSize = LongByReference()
+    private val streamBase: Pointer? = streamFD?.let { fd ->
+        SocketLib.INSTANCE.shmMap(fd, streamSize) ?: error("Failed to map visualization stream")
+    }
+
+    /** Float frames from the host's audio thread (ComposeProvider::setVisualStream), if enabled. */
+    val visualStream: VisualStream? = streamBase?.let { VisualStream(it.getByteBuffer(0, streamSize.value)) }
+
+    // FRAME_TIMING message, reused under writeLock
+    private val timingBuffer = ByteBuffer.allocate(2 + CmpEvent.FRAME_TIMING_SIZE).order(ByteOrder.LITTLE_ENDIAN)
 
-    // Reusable buffers for native I/O
+    // PARAM message of one record, reused under writeLock
+    private val paramBuffer = ByteBuffer.allocate(3 + Param.RECORD_SIZE).order(ByteOrder.LITTLE_ENDIAN)
+
+    // PARAM records read from the socket (receiver thread)
+    private val paramRecords = ByteBuffer.allocate(Param.MAX_RECORDS * Param.RECORD_SIZE).order(ByteOrder.LITTLE_ENDIAN)
+
+    // JUCE events decoded in place for juceEventVisitor (receiver thread); grows to the largest one
+    private var juceEventBuffer = ByteBuffer.allocate(1024).order(ByteOrder.LITTLE_ENDIAN)
+    private val juceEventReader = JuceValueTreeReader()
+
+    // JUCE message prefix for JuceValueTreeWriter sends, reused under writeLock
+    private val juceEventPrefix = ByteBuffer.allocate(5).order(ByteOrder.LITTLE_ENDIAN)
+
+    // Reusable buffers for native I/O (writeBuffer grows to fit the largest frame)
     private val readBuffer = Memory(1024)
-    private val writeBuffer = Memory(1024)
+
+    // Descriptors received with an event type byte; BLOB and SWAP_CHAIN claim theirs (receiver thread)
+    private val receivedFDs = Memory(4L * MAX_RECEIVED_FDS)
+    private val numReceivedFDs = IntByReference()
+    private val messageFDs = IntArray(MAX_RECEIVED_FDS)
+    private var numMessageFDs = 0
+    private var writeBuffer = Memory(1024)
+
+    /** ValueTree mirrored from the host with setSyncedTree(), invalid until it sends one. */
+    val syncedTree = SyncedValueTree { sendSync(it) }
+
+    /** True while the host collects frame timings (ComposeProvider::setFrameTimingEnabled). */
+    @Volatile
+    var isTimingEnabled = false
+        private set
 
     /** Returns true if the receiver is still running (socket not closed) */
     val isRunning: Boolean get() = running
@@ -56,40 +143,70 @@ class Ipc(private val socketFD: Int) {
 
     private var onInputEvent: ((InputEvent) -> Unit)? = null
     private var onJuceEvent: ((JuceValueTree) -> Unit)? = null
+    private var juceEventVisitor: JuceValueTreeVisitor? = null
     private var onMidiEvent: ((MidiMessage) -> Unit)? = null
+    private var onParameter: ParameterHandler? = null
+    private var onBlob: ((SharedBlob) -> Unit)? = null
+    private var onDetach: ((generation: Int) -> Unit)? = null
+    private var onVisibility: ((visible: Boolean) -> Unit)? = null
+    private var onSwapChain: ((DmaBufSwapChain) -> Unit)? = null
+    private var onVsync: ((deadlineNanos: Long, presentNanos: Long) -> Unit)? = null
 
+    /**
+     * @param onSwapChain Swap chains the host sends on the socket (Linux). The
+     *   callee owns the chain and must close it once its fds are imported
+     * @param onVisibility The host's view was shown, or hidden (occluded, minimized)
+     * @param onVsync The display is about to refresh, after [sendFrameRequest]. A
+     *   frame ready by deadlineNanos is shown at presentNanos (System.nanoTime clock)
+     * @param juceEventVisitor Decodes JUCE events in place instead of building a
+     *   JuceValueTree for onJuceEvent, which is then not called
+     */
     fun startReceiving(
         onInputEvent: (InputEvent) -> Unit,
         onJuceEvent: ((JuceValueTree) -> Unit)? = null,
-        onMidiEvent: ((MidiMessage) -> Unit)? = null
+        onMidiEvent: ((MidiMessage) -> Unit)? = null,
+        onParameter: ParameterHandler? = null,
+        onBlob: ((SharedBlob) -> Unit)? = null,
+        onDetach: ((generation: Int) -> Unit)? = null,
+        onSwapChain: ((DmaBufSwapChain) -> Unit)? = null,
+        onVisibility: ((visible: Boolean) -> Unit)? = null,
+        onVsync: ((deadlineNanos: Long, presentNanos: Long) -> Unit)? = null,
+        juceEventVisitor: JuceValueTreeVisitor? = null
     ) {
         if (running) return
         this.onInputEvent = onInputEvent
         this.onJuceEvent = onJuceEvent
+        this.juceEventVisitor = juceEventVisitor
         this.onMidiEvent = onMidiEvent
+        this.onParameter = onParameter
+        this.onBlob = onBlob
+        this.onDetach = onDetach
+        this.onSwapChain = onSwapChain
+        this.onVisibility = onVisibility
+        this.onVsync = onVsync
         running = true
         thread = Thread({
+            current.set(this)
             while (running) {
                 try {
-                    val eventType = readByte()
-                    if (eventType < 0) {
-                        running = false
-                        kotlin.system.exitProcess(0)
-                    }
+                    ring?.let { drainRing(it) }
 
-                    when (eventType) {
-                        EventType.INPUT -> handleInputEvent()
-                        EventType.CMP -> handleCmpEvent()
-                        EventType.JUCE -> handleJuceEvent()
-                        EventType.MIDI -> handleMidiEvent()
+                    val eventType = readEventType()
+                    if (eventType < 0) {
+                        closed()
+                        break
                     }
+                    handleSocketEvent(eventType)
                 } catch (e: Exception) {
                     // Silently ignore exceptions when running
+                } finally {
+                    closeMessageFDs()
                 }
             }
         }, "Ipc")
         thread?.isDaemon = true
         thread?.start()
+        receiverThread = thread
     }
 
     fun stopReceiving() {
@@ -98,12 +215,68 @@ class Ipc(private val socketFD: Int) {
         thread = null
     }
 
+    /**
+     * Release the socket and shared memory of a channel that has ended.
+     * Only for channels of a shared UI process; call once nothing uses this Ipc.
+     */
+    fun close() {
+        // Wake the receiver with EOF and let it finish before the fd can be reused
+        stopReceiving()
+        SocketLib.INSTANCE.socketShutdown(socketFD)
+        receiverThread?.join(1000)
+        SocketLib.INSTANCE.socketClose(socketFD)
+        shmBase?.let { SocketLib.INSTANCE.shmUnmap(it, shmSize.value) }
+        streamBase?.let { SocketLib.INSTANCE.shmUnmap(it, streamSize.value) }
+    }
+
+    /** The host closed the socket. */
+    private fun closed() {
+        running = false
+        if (exitOnClose) kotlin.system.exitProcess(0)
+    }
+
     private fun readByte(): Int {
         val n = SocketLib.INSTANCE.socketRead(socketFD, readBuffer, 1)
         if (n <= 0) return -1
         return readBuffer.getByte(0).toInt() and 0xFF
     }
 
+    /**
+     * Read the type byte of the next message. It is received on its own with
+     * recvmsg(), so the fds a BLOB or SWAP_CHAIN message carries stay with it.
+     */
+    private fun readEventType(): Int {
+        val n = SocketLib.INSTANCE.socketReceiveFDs(socketFD, readBuffer, 1, receivedFDs, MAX_RECEIVED_FDS, numReceivedFDs)
+        if (n <= 0) return -1
+        val eventType = readBuffer.getByte(0).toInt() and 0xFF
+
+        for (i in 0 until numReceivedFDs.value) {
+            val fd = receivedFDs.getInt(4L * i)
+            if (eventType == EventType.BLOB || eventType == EventType.CMP) {
+                messageFDs[numMessageFDs++] = fd
+            } else {
+                SocketLib.INSTANCE.socketClose(fd)
+            }
+        }
+        return eventType
+    }
+
+    /** Take ownership of the index-th fd of the current message, -1 if there is none. */
+    private fun claimFD(index: Int): Int {
+        if (index >= numMessageFDs) return -1
+        val fd = messageFDs[index]
+        messageFDs[index] = -1
+        return fd
+    }
+
+    /** Close the fds of the current message that no handler claimed. */
+    private fun closeMessageFDs() {
+        for (i in 0 until numMessageFDs) {
+            if (messageFDs[i] >= 0) SocketLib.INSTANCE.socketClose(messageFDs[i])
+        }
+        numMessageFDs = 0
+    }
+
     private fun readFully(size: Int): ByteArray? {
         val data = ByteArray(size)
         var offset = 0
@@ -119,73 +292,371 @@ class Ipc(private val socketFD: Int) {
         return if (offset == size) data else null
     }
 
+    /** Like readFully(), into the start of dst instead of a new array. */
+    private fun readInto(dst: ByteArray, size: Int): Boolean {
+        var offset = 0
+        while (offset < size && running) {
+            val n = SocketLib.INSTANCE.socketRead(socketFD, readBuffer, minOf(1024L, (size - offset).toLong()))
+            if (n <= 0) return false
+            readBuffer.read(0, dst, offset, n.toInt())
+            offset += n.toInt()
+        }
+        return offset == size
+    }
+
+    /** Read and drop size bytes, e.g. the payload of a message over its limit. */
+    private fun skipFully(size: Long): Boolean {
+        var remaining = size
+        while (remaining > 0 && running) {
+            val n = SocketLib.INSTANCE.socketRead(socketFD, readBuffer, minOf(1024L, remaining))
+            if (n <= 0) return false
+            remaining -= n
+        }
+        return remaining == 0L
+    }
+
+    private fun handleSocketEvent(eventType: Int) {
+        when (eventType) {
+            EventType.INPUT -> handleInputEvent()
+            EventType.CMP -> handleCmpEvent()
+            EventType.JUCE, EventType.SYNC, EventType.MIDI_BUFFER -> handleSizedEvent(eventType)
+            EventType.MIDI -> handleMidiEvent()
+            EventType.PARAM -> handleParamEvent()
+            EventType.BLOB -> handleBlobEvent()
+            EventType.RING -> ringWakeup()  // Ring drained at top of loop
+        }
+    }
+
+    /**
+     * Handle the socket message a ring SOCKET record stands for, skipping the
+     * wakeups sent before it, so it keeps its place among the ring messages.
+     */
+    private fun readSocketMessage() {
+        while (running) {
+            val eventType = readEventType()
+            if (eventType < 0) {
+                closed()
+                return
+            }
+            if (eventType == EventType.RING) {
+                ringWakeup()
+                continue
+            }
+            try {
+                handleSocketEvent(eventType)
+            } finally {
+                closeMessageFDs()
+            }
+            return
+        }
+    }
+
+    /**
+     * Dispatch everything in the shared memory ring, then announce that we are
+     * about to block on the socket. Returns once a wait is safe.
+     */
+    private fun drainRing(ring: SharedRing) {
+        do {
+            while (true) {
+                val frame = ring.read() ?: break
+                dispatchFrame(frame)
+
+                // A host waiting for room in a full ring can go on
+                if (ring.takeWriterWaiting()) {
+                    synchronized(writeLock) { writeFully(byteArrayOf(EventType.RING.toByte())) }
+                }
+            }
+        } while (!ring.prepareWait())
+    }
+
+    /**
+     * Dispatch one ring message. Same framing as the socket: 1-byte type + payload.
+     */
+    private fun dispatchFrame(frame: ByteBuffer) {
+        when (val eventType = frame.get().toInt() and 0xFF) {
+            EventType.INPUT -> {
+                if (frame.remaining() >= 16) onInputEvent?.invoke(decodeInputEvent(frame))
+            }
+            EventType.CMP -> {
+                if (!frame.hasRemaining()) return
+                val subtype = frame.get().toInt() and 0xFF
+                if (subtype == CmpEvent.VSYNC) {
+                    if (frame.remaining() >= CmpEvent.VSYNC_SIZE) onVsync?.invoke(frame.long, frame.long)
+                } else if (frame.hasRemaining()) {
+                    deliverCmpEvent(subtype, frame.get().toInt() and 0xFF)
+                }
+            }
+            EventType.JUCE, EventType.SYNC, EventType.MIDI_BUFFER -> {
+                if (frame.remaining() < 4) return
+                val size = frame.int
+                val visitor = juceEventVisitor
+                if (eventType == EventType.JUCE && visitor != null && size > 0 && size <= frame.remaining()) {
+                    frame.limit(frame.position() + size)
+                    juceEventReader.read(frame, visitor)
+                } else if (size > 0 && size <= frame.remaining()) {
+                    val payload = ByteArray(size)
+                    frame.get(payload)
+                    deliverSizedEvent(eventType, payload)
+                }
+            }
+            EventType.MIDI -> {
+                if (!frame.hasRemaining()) return
+                val size = frame.get().toInt() and 0xFF
+                if (size > 0 && size <= frame.remaining() && onMidiEvent != null) {
+                    val payload = ByteArray(size)
+                    frame.get(payload)
+                    createMidiMessage(payload)?.let { onMidiEvent?.invoke(it) }
+                }
+            }
+            EventType.PARAM -> {
+                if (frame.remaining() < 2) return
+                val count = frame.short.toInt() and 0xFFFF
+                if (count in 1..Param.MAX_RECORDS && count * Param.RECORD_SIZE <= frame.remaining()) {
+                    deliverParams(frame, count)
+                }
+            }
+            EventType.SOCKET -> readSocketMessage()
+        }
+    }
+
     private fun handleInputEvent() {
         val buffer = readFully(16) ?: run {
-            running = false
-            kotlin.system.exitProcess(0)
-        }
-
-        val byteBuffer = ByteBuffer.wrap(buffer).order(ByteOrder.LITTLE_ENDIAN)
-        val event = InputEvent(
-            type = byteBuffer.get().toInt() and 0xFF,
-            action = byteBuffer.get().toInt() and 0xFF,
-            button = byteBuffer.get().toInt() and 0xFF,
-            modifiers = byteBuffer.get().toInt() and 0xFF,
-            x = byteBuffer.short.toInt(),
-            y = byteBuffer.short.toInt(),
-            data1 = byteBuffer.short.toInt(),
-            data2 = byteBuffer.short.toInt(),
-            timestamp = byteBuffer.int.toLong() and 0xFFFFFFFFL
-        )
+            closed()
+            return
+        }
+
+        val event = decodeInputEvent(ByteBuffer.wrap(buffer).order(ByteOrder.LITTLE_ENDIAN))
         onInputEvent?.invoke(event)
     }
 
+    private fun decodeInputEvent(byteBuffer: ByteBuffer) = InputEvent(
+        type = byteBuffer.get().toInt() and 0xFF,
+        action = byteBuffer.get().toInt() and 0xFF,
+        button = byteBuffer.get().toInt() and 0xFF,
+        modifiers = byteBuffer.get().toInt() and 0xFF,
+        x = byteBuffer.short.toInt(),
+        y = byteBuffer.short.toInt(),
+        data1 = byteBuffer.short.toInt(),
+        data2 = byteBuffer.short.toInt(),
+        timestamp = byteBuffer.int.toLong() and 0xFFFFFFFFL,
+        receivedNanos = System.nanoTime()
+    )
+
     private fun handleCmpEvent() {
         val subtype = readByte()
         if (subtype < 0) {
-            running = false
-            kotlin.system.exitProcess(0)
+            closed()
+            return
         }
 
-        // CmpEvent.FRAME_READY is UI → Host only
-        // IOSurface sharing uses Mach port IPC, not socket events
+        // SURFACE_READY, BUFFER_READY, FRAME_TIMING and FRAME_REQUEST are UI → Host only
+        // IOSurfaces travel over Mach ports on macOS; Linux swap chains arrive here
+        if (subtype == CmpEvent.SWAP_CHAIN) {
+            handleSwapChainEvent()
+        } else if (subtype == CmpEvent.VSYNC) {
+            val payload = readFully(CmpEvent.VSYNC_SIZE) ?: run {
+                closed()
+                return
+            }
+            val fields = ByteBuffer.wrap(payload).order(ByteOrder.LITTLE_ENDIAN)
+            onVsync?.invoke(fields.long, fields.long)
+        } else if (subtype == CmpEvent.DETACH || subtype == CmpEvent.TIMING_ENABLE || subtype == CmpEvent.VISIBILITY) {
+            val value = readByte()
+            if (value < 0) {
+                closed()
+                return
+            }
+            deliverCmpEvent(subtype, value)
+        }
     }
 
-    private fun handleJuceEvent() {
+    private fun handleSwapChainEvent() {
+        val header = readFully(CmpEvent.SWAP_CHAIN_HEADER_SIZE) ?: run {
+            closed()
+            return
+        }
+
+        val fields = ByteBuffer.wrap(header).order(ByteOrder.LITTLE_ENDIAN)
+        val generation = fields.get().toInt() and 0xFF
+        val count = fields.get().toInt() and 0xFF
+        val width = fields.int
+        val height = fields.int
+        val format = fields.int
+        val modifier = fields.long
+
+        // Always consume the records so the stream stays in sync
+        val records = readFully(count * CmpEvent.SWAP_CHAIN_BUFFER_SIZE) ?: run {
+            closed()
+            return
+        }
+        if (count !in 1..SwapChain.MAX_BUFFERS || numMessageFDs < count) return
+
+        val strides = ByteBuffer.wrap(records).order(ByteOrder.LITTLE_ENDIAN)
+        val buffers = List(count) { i -> DmaBufSwapChain.Buffer(claimFD(i), strides.int, strides.int) }
+
+        // Ownership passes to the handler, which closes the chain once imported
+        val chain = DmaBufSwapChain(generation, width, height, format, modifier, buffers)
+        onSwapChain?.invoke(chain) ?: chain.close()
+    }
+
+    private fun deliverCmpEvent(subtype: Int, value: Int) {
+        when (subtype) {
+            CmpEvent.DETACH -> onDetach?.invoke(value)
+            CmpEvent.TIMING_ENABLE -> isTimingEnabled = value != 0
+            CmpEvent.VISIBILITY -> onVisibility?.invoke(value != 0)
+        }
+    }
+
+    private fun handleSizedEvent(eventType: Int) {
         val sizeBuffer = readFully(4) ?: run {
-            running = false
-            kotlin.system.exitProcess(0)
+            closed()
+            return
         }
 
         val size = ByteBuffer.wrap(sizeBuffer).order(ByteOrder.LITTLE_ENDIAN).int
-        if (size > 0 && onJuceEvent != null) {
+        val maxSize = if (eventType == EventType.MIDI_BUFFER) MidiBuffer.MAX_SIZE else ValueTreeMessage.MAX_SIZE
+        if (size < 0 || size > maxSize) {
+            // Over the limit (a negative Int is over 2 GiB): drop it, keep the stream in sync
+            if (!skipFully(size.toLong() and 0xFFFFFFFFL)) closed()
+            return
+        }
+
+        val visitor = juceEventVisitor
+        if (eventType == EventType.JUCE && visitor != null && size > 0) {
+            if (juceEventBuffer.capacity() < size) {
+                juceEventBuffer = ByteBuffer.allocate(maxOf(size, juceEventBuffer.capacity() * 2)).order(ByteOrder.LITTLE_ENDIAN)
+            }
+            if (!readInto(juceEventBuffer.array(), size)) {
+                closed()
+                return
+            }
+
+            juceEventBuffer.clear().limit(size)
+            juceEventReader.read(juceEventBuffer, visitor)
+        } else if (size > 0) {
+            // Always consume the payload so the stream stays in sync
             val payload = readFully(size) ?: run {
-                running = false
-                kotlin.system.exitProcess(0)
+                closed()
+                return
+            }
+
+            deliverSizedEvent(eventType, payload)
+        }
+    }
+
+    private fun deliverSizedEvent(eventType: Int, payload: ByteArray) {
+        when (eventType) {
+            EventType.SYNC -> syncedTree.applyChange(payload)
+            EventType.MIDI_BUFFER -> deliverMidiBuffer(payload)
+            else -> onJuceEvent?.invoke(JuceValueTree.fromByteArray(payload))
+        }
+    }
+
+    /**
+     * Decode a MIDI buffer and deliver its messages in order. Sample positions
+     * are the host's audio clock, which means nothing here, so they are dropped.
+     */
+    private fun deliverMidiBuffer(payload: ByteArray) {
+        val handler = onMidiEvent ?: return
+        var offset = 0
+
+        fun readVarint(): Int {
+            var value = 0
+            var shift = 0
+            while (offset < payload.size && shift < 32) {
+                val byte = payload[offset++].toInt() and 0xFF
+                value = value or ((byte and 0x7F) shl shift)
+                if ((byte and 0x80) == 0) return value
+                shift += 7
             }
+            return -1
+        }
 
-            val tree = JuceValueTree.fromByteArray(payload)
-            onJuceEvent?.invoke(tree)
+        while (offset < payload.size) {
+            if (readVarint() < 0) return
+            val length = readVarint()
+            if (length <= 0 || length > payload.size - offset) return
+            createMidiMessage(payload.copyOfRange(offset, offset + length))?.let { handler(it) }
+            offset += length
         }
     }
 
     private fun handleMidiEvent() {
         val size = readByte()
         if (size < 0) {
-            running = false
-            kotlin.system.exitProcess(0)
+            closed()
+            return
         }
 
-        if (size > 0 && onMidiEvent != null) {
-            val payload = readFully(size) ?: run {
-                running = false
-                kotlin.system.exitProcess(0)
-            }
+        if (size == 0) return
 
-            val message = createMidiMessage(payload)
-            if (message != null) {
-                onMidiEvent?.invoke(message)
-            }
+        // Always consume the payload so the stream stays in sync
+        val payload = readFully(size) ?: run {
+            closed()
+            return
+        }
+
+        val handler = onMidiEvent ?: return
+        createMidiMessage(payload)?.let { handler(it) }
+    }
+
+    private fun handleParamEvent() {
+        val buffer = paramRecords.array()
+        if (!readInto(buffer, 2)) {
+            closed()
+            return
+        }
+
+        val count = (buffer[0].toInt() and 0xFF) or ((buffer[1].toInt() and 0xFF) shl 8)
+        if (count == 0 || count > Param.MAX_RECORDS) return
+
+        if (!readInto(buffer, count * Param.RECORD_SIZE)) {
+            closed()
+            return
+        }
+
+        paramRecords.clear()
+        deliverParams(paramRecords, count)
+    }
+
+    private fun handleBlobEvent() {
+        val fd = claimFD(0)
+
+        val header = readFully(Blob.HEADER_SIZE) ?: run {
+            if (fd >= 0) SocketLib.INSTANCE.socketClose(fd)
+            closed()
+            return
+        }
+        if (fd < 0) return
+
+        val fields = ByteBuffer.wrap(header).order(ByteOrder.LITTLE_ENDIAN)
+        val id = fields.int
+        val size = fields.int
+
+        // shmMap closes the fd once mapped
+        val mappedSize = LongByReference()
+        val base = SocketLib.INSTANCE.shmMap(fd, mappedSize) ?: run {
+            SocketLib.INSTANCE.socketClose(fd)
+            return
+        }
+
+        if (size <= 0 || size > mappedSize.value) {
+            SocketLib.INSTANCE.shmUnmap(base, mappedSize.value)
+            return
+        }
+
+        // Ownership passes to the handler, which closes the blob when done
+        val blob = SharedBlob(id, base, mappedSize.value, size)
+        onBlob?.invoke(blob) ?: blob.close()
+    }
+
+    /** Decode count records at the buffer's position, without allocating. */
+    private fun deliverParams(records: ByteBuffer, count: Int) {
+        val handler = onParameter ?: return
+        repeat(count) {
+            val id = records.int
+            val value = records.float
+            handler.onParameter(id, value, records.get().toInt() and 0xFF)
         }
     }
 
@@ -207,56 +678,260 @@ class Ipc(private val socketFD: Int) {
     // ---- Sending (UI → Host) ----
 
     private fun writeFully(data: ByteArray) {
-        var offset = 0
-        while (offset < data.size) {
-            val toWrite = minOf(1024, data.size - offset)
-            for (i in 0 until toWrite) {
-                writeBuffer.setByte(i.toLong(), data[offset + i])
+        writeBuffer.write(0, data, 0, data.size)
+        writeNative(data.size.toLong())
+    }
+
+    /**
+     * Write the first size bytes of writeBuffer, normally in a single syscall.
+     */
+    private fun writeNative(size: Long): Boolean {
+        var offset = 0L
+        while (offset < size) {
+            val n = SocketLib.INSTANCE.socketWrite(socketFD, writeBuffer.share(offset), size - offset)
+            if (n <= 0) return false
+            offset += n
+        }
+        return true
+    }
+
+    /**
+     * Send one message (prefix + payload) through the ring or the socket.
+     * On the socket the frame is assembled contiguously and written at once,
+     * so the host never sees a partial header followed by another message.
+     * A full ring blocks until the host has read from it, as a full socket does.
+     * Returns false if the message was not sent: the connection is gone, or it
+     * is larger than the ring. Must be called with writeLock held.
+     */
+    private fun writeFrame(prefix: ByteArray, payload: ByteArray? = null, payloadLength: Int = payload?.size ?: 0): Boolean {
+        val ring = ring
+        if (ring == null) {
+            val frameSize = prefix.size.toLong() + payloadLength
+            if (writeBuffer.size() < frameSize) {
+                writeBuffer = Memory(maxOf(frameSize, writeBuffer.size() * 2))
             }
-            val n = SocketLib.INSTANCE.socketWrite(socketFD, writeBuffer, toWrite.toLong())
-            if (n <= 0) return
-            offset += n.toInt()
+            writeBuffer.write(0, prefix, 0, prefix.size)
+            if (payload != null && payloadLength > 0) {
+                writeBuffer.write(prefix.size.toLong(), payload, 0, payloadLength)
+            }
+            return writeNative(frameSize)
         }
+
+        if (!ring.canHold(prefix.size + payloadLength)) return false
+
+        while (!ring.write(prefix, payload, payloadLength)) {
+            if (!running) return false
+            // Announce the wait, then look again: room freed before that comes without a wakeup
+            val written = synchronized(ringSpace) {
+                ring.prepareWriterWait()
+                ring.write(prefix, payload, payloadLength).also { if (!it) ringSpace.wait(RING_SPACE_WAIT_MS) }
+            }
+            if (written) break
+        }
+
+        if (ring.takeReaderWaiting()) {
+            writeFully(byteArrayOf(EventType.RING.toByte()))
+        }
+        return true
+    }
+
+    /** A RING wakeup arrived: the host may have read from a full TX ring. */
+    private fun ringWakeup() = synchronized(ringSpace) {
+        ringSpace.notifyAll()
     }
 
     /**
-     * Send a JuceValueTree to the host.
+     * Send a JuceValueTree to the host. Returns false if it was not sent: the
+     * connection is gone, or the tree is larger than the shared memory ring
+     * or ValueTreeMessage.MAX_SIZE.
      * Format: EventType.JUCE + 4-byte size + ValueTree bytes
      */
-    fun sendJuceEvent(tree: JuceValueTree) {
+    fun sendJuceEvent(tree: JuceValueTree): Boolean {
         val treeBytes = tree.toByteArray()
-        val sizeBuffer = ByteBuffer.allocate(4).order(ByteOrder.LITTLE_ENDIAN)
-        sizeBuffer.putInt(treeBytes.size)
+        if (treeBytes.size > ValueTreeMessage.MAX_SIZE) return false
+        val prefix = ByteBuffer.allocate(5).order(ByteOrder.LITTLE_ENDIAN)
+        prefix.put(EventType.JUCE.toByte())
+        prefix.putInt(treeBytes.size)
+
+        return synchronized(writeLock) {
+            writeFrame(prefix.array(), treeBytes)
+        }
+    }
+
+    /**
+     * Send the tree encoded by a JuceValueTreeWriter to the host, without
+     * allocating. The writer may be reset as soon as this returns. Returns
+     * false if it was not sent, as sendJuceEvent(JuceValueTree) does.
+     * Format: EventType.JUCE + 4-byte size + ValueTree bytes
+     */
+    fun sendJuceEvent(writer: JuceValueTreeWriter): Boolean {
+        if (writer.size == 0) return true
+        if (writer.size > ValueTreeMessage.MAX_SIZE) return false
+
+        return synchronized(writeLock) {
+            juceEventPrefix.clear()
+            juceEventPrefix.put(EventType.JUCE.toByte())
+            juceEventPrefix.putInt(writer.size)
+            writeFrame(juceEventPrefix.array(), writer.bytes, writer.size)
+        }
+    }
+
+    /**
+     * Send one synchronized ValueTree change to the host.
+     * Format: EventType.SYNC + 4-byte size + change bytes
+     */
+    private fun sendSync(change: ByteArray) {
+        if (change.size > ValueTreeMessage.MAX_SIZE) return
+        val prefix = ByteBuffer.allocate(5).order(ByteOrder.LITTLE_ENDIAN)
+        prefix.put(EventType.SYNC.toByte())
+        prefix.putInt(change.size)
 
         synchronized(writeLock) {
-            writeFully(byteArrayOf(EventType.JUCE.toByte()))
-            writeFully(sizeBuffer.array())
-            writeFully(treeBytes)
+            writeFrame(prefix.array(), change)
         }
     }
 
     /**
-     * Notify host that first frame has been rendered to a new surface.
+     * Notify host that first frame has been rendered to a new swap chain.
      * Format: EventType.CMP + CmpEvent.SURFACE_READY
      */
     fun sendSurfaceReady() {
         synchronized(writeLock) {
-            writeFully(byteArrayOf(EventType.CMP.toByte(), CmpEvent.SURFACE_READY.toByte()))
+            writeFrame(byteArrayOf(EventType.CMP.toByte(), CmpEvent.SURFACE_READY.toByte()))
+        }
+    }
+
+    /**
+     * Ask the host for one VSYNC on its next display refresh.
+     * Format: EventType.CMP + CmpEvent.FRAME_REQUEST
+     */
+    fun sendFrameRequest() {
+        synchronized(writeLock) {
+            writeFrame(byteArrayOf(EventType.CMP.toByte(), CmpEvent.FRAME_REQUEST.toByte()))
+        }
+    }
+
+    /**
+     * Notify host that a swap chain buffer has finished rendering.
+     * Format: EventType.CMP + CmpEvent.BUFFER_READY + 1-byte generation + 1-byte index
+     * Called from the Metal completion thread.
+     */
+    fun sendBufferReady(generation: Int, index: Int) {
+        synchronized(writeLock) {
+            writeFrame(byteArrayOf(
+                EventType.CMP.toByte(), CmpEvent.BUFFER_READY.toByte(),
+                generation.toByte(), index.toByte()
+            ))
+        }
+    }
+
+    /**
+     * Report the costs of one frame, right before its BUFFER_READY. Only while
+     * [isTimingEnabled]. Times are microseconds; inputTimestamp is the host
+     * timestamp of the oldest input dispatched for the frame, 0 if none.
+     * Format: EventType.CMP + CmpEvent.FRAME_TIMING + generation + index + 6 x 32-bit
+     */
+    fun sendFrameTiming(generation: Int, index: Int, timing: FrameTiming) {
+        synchronized(writeLock) {
+            timingBuffer.clear()
+            timingBuffer.put(EventType.CMP.toByte())
+            timingBuffer.put(CmpEvent.FRAME_TIMING.toByte())
+            timingBuffer.put(generation.toByte())
+            timingBuffer.put(index.toByte())
+            timingBuffer.putInt(timing.inputTimestamp.toInt())
+            timingBuffer.putInt(timing.queueMicros)
+            timingBuffer.putInt(timing.dispatchMicros)
+            timingBuffer.putInt(timing.renderMicros)
+            timingBuffer.putInt(timing.flushMicros)
+            timingBuffer.putInt(timing.gpuMicros)
+            writeFrame(timingBuffer.array())
+        }
+    }
+
+    /**
+     * Send a parameter value to the host, optionally marking a gesture
+     * (Param.FLAG_GESTURE_BEGIN/END). Allocation-free.
+     * Format: EventType.PARAM + 16-bit count (1) + id + value + flags
+     */
+    fun sendParameter(id: Int, value: Float, flags: Int = 0) {
+        synchronized(writeLock) {
+            paramBuffer.clear()
+            paramBuffer.put(EventType.PARAM.toByte())
+            paramBuffer.putShort(1)
+            paramBuffer.putInt(id)
+            paramBuffer.putFloat(value)
+            paramBuffer.put(flags.toByte())
+            writeFrame(paramBuffer.array())
         }
     }
 
     /**
-     * Send a MIDI message to the host.
+     * Send a MIDI message to the host. Longer than 255 bytes (SysEx) it goes
+     * out as a MIDI buffer of one.
      * Format: EventType.MIDI + 1-byte size + raw MIDI bytes
      */
     fun sendMidiEvent(message: MidiMessage) {
         val data = message.message
         val length = message.length
-        if (length == 0 || length > 255) return
+        if (length == 0) return
+        if (length > 255) {
+            sendMidiEvents(listOf(MidiEvent(message, 0)))
+            return
+        }
 
         synchronized(writeLock) {
-            writeFully(byteArrayOf(EventType.MIDI.toByte(), length.toByte()))
-            writeFully(data.copyOf(length))
+            writeFrame(byteArrayOf(EventType.MIDI.toByte(), length.toByte()), data, length)
         }
     }
+
+    /**
+     * Send MIDI events to the host in one message, each tick sent as its
+     * sample position in the host's MidiBuffer. Returns false if the events
+     * encode to more than MidiBuffer.MAX_SIZE, or were not sent.
+     * Format: EventType.MIDI_BUFFER + 4-byte size + events (see IpcProtocol.kt)
+     */
+    fun sendMidiEvents(events: List<MidiEvent>): Boolean {
+        val stream = ByteArrayOutputStream()
+        fun writeVarint(value: Int) {
+            var v = value
+            while ((v and 0x7F.inv()) != 0) {
+                stream.write((v and 0x7F) or 0x80)
+                v = v ushr 7
+            }
+            stream.write(v)
+        }
+
+        for (event in events) {
+            val length = event.message.length
+            if (length == 0) continue
+            writeVarint(event.tick.coerceIn(0L, Int.MAX_VALUE.toLong()).toInt())
+            writeVarint(length)
+            stream.write(event.message.message, 0, length)
+        }
+
+        val payload = stream.toByteArray()
+        if (payload.isEmpty()) return true
+        if (payload.size > MidiBuffer.MAX_SIZE) return false
+
+        val prefix = ByteBuffer.allocate(5).order(ByteOrder.LITTLE_ENDIAN)
+        prefix.put(EventType.MIDI_BUFFER.toByte())
+        prefix.putInt(payload.size)
+
+        return synchronized(writeLock) {
+            writeFrame(prefix.array(), payload)
+        }
+    }
+
+    companion object {
+        private const val MAX_RECEIVED_FDS = 4
+
+        // A sender on the receiver thread cannot take the host's wakeup, so waits are bounded
+        private const val RING_SPACE_WAIT_MS = 10L
+
+        /**
+         * The channel serving the current thread (receiver or render thread),
+         * so Library.sendJuceEvent() reaches the right editor in a shared UI process.
+         */
+        internal val current = ThreadLocal<Ipc?>()
+    }
 }
@@ -16,10 +16,119 @@ object EventType {
     const val CMP = 1
     const val MIDI = 2
     const val JUCE = 3
+    const val RING = 4      // Wakeup: shared memory ring has data (no payload)
+    const val SYNC = 5      // Synchronized ValueTree delta (see SyncedValueTree.kt)
+    const val PARAM = 6     // Batch of parameter records
+    const val BLOB = 7      // Shared memory payload, fd attached to the type byte
+    const val MIDI_BUFFER = 8  // Timestamped MIDI events of any length
+    const val SOCKET = 9    // Ring only: the next message (fds attached) is on the socket
+}
+
+// MIDI buffers (EventType.MIDI_BUFFER): 4-byte size, then per event a varint
+// sample position, varint length and raw bytes (unsigned LEB128 varints)
+object MidiBuffer {
+    const val MAX_SIZE = 1024 * 1024
+}
+
+// ValueTree messages (EventType.JUCE and EventType.SYNC): 4-byte size, then the tree
+object ValueTreeMessage {
+    const val MAX_SIZE = 16 * 1024 * 1024
+}
+
+// Shared memory blobs (EventType.BLOB): 4-byte id + 4-byte size, region fd via SCM_RIGHTS
+object Blob {
+    const val HEADER_SIZE = 8
+}
+
+// Parameter records (EventType.PARAM): 2-byte count, then id + value + flags each
+object Param {
+    const val RECORD_SIZE = 9     // uint32 id + float value + uint8 flags
+    const val MAX_RECORDS = 1024  // Per message
+
+    const val FLAG_GESTURE_BEGIN = 0x01
+    const val FLAG_GESTURE_END = 0x02
+}
+
+// ValueTree sync change types (first payload byte of EventType.SYNC, as juce::ValueTreeSynchroniser)
+object SyncChange {
+    const val PROPERTY_CHANGED = 1
+    const val FULL = 2
+    const val CHILD_ADDED = 3
+    const val CHILD_REMOVED = 4
+    const val CHILD_MOVED = 5
+    const val PROPERTY_REMOVED = 6
 }
 
 // CMP event types (second byte for EventType.CMP)
-// Note: IOSurface sharing uses Mach port IPC, not socket
+// Note: IOSurface sharing uses Mach port IPC on macOS, DMA-BUFs travel on the socket on Linux
 object CmpEvent {
-    const val SURFACE_READY = 0   // UI→Host: first frame rendered to new surface
+    const val SURFACE_READY = 0   // UI→Host: first frame rendered to new swap chain
+    const val BUFFER_READY = 1    // UI→Host: 1-byte generation + 1-byte buffer index
+    const val DETACH = 2          // Host→UI: 1-byte generation, editor closed - release that chain
+    const val FRAME_TIMING = 3    // UI→Host: costs of one frame (see FrameTiming)
+    const val TIMING_ENABLE = 4   // Host→UI: 1-byte flag, start/stop FRAME_TIMING
+    const val SWAP_CHAIN = 5      // Host→UI: DMA-BUF swap chain, fds attached (Linux)
+    const val VISIBILITY = 6      // Host→UI: 1-byte flag, view shown (1) or hidden (0)
+    const val FRAME_REQUEST = 7   // UI→Host: deliver a VSYNC on the next display refresh
+    const val VSYNC = 8           // Host→UI: 64-bit deadline + presentation time (System.nanoTime clock)
+
+    const val FRAME_TIMING_SIZE = 26        // FRAME_TIMING payload after the subtype
+    const val SWAP_CHAIN_HEADER_SIZE = 22   // SWAP_CHAIN payload after the subtype, before the buffers
+    const val SWAP_CHAIN_BUFFER_SIZE = 8    // Per buffer: uint32 stride + uint32 offset
+    const val VSYNC_SIZE = 16               // VSYNC payload after the subtype
+}
+
+// Swap chain shared by the host (see ipc_protocol.h)
+object SwapChain {
+    const val MAX_BUFFERS = 4
+}
+
+// DMA-BUF swap chains (Linux): single-plane buffers in a DRM fourcc format
+object DmaBuf {
+    const val FORMAT_ARGB8888 = 0x34325241             // 'AR24', B G R A in memory
+    const val MODIFIER_INVALID = 0x00FFFFFFFFFFFFFFL    // Implicit layout
+}
+
+// Shared memory ring transport layout (see ipc_protocol.h)
+object ShmRing {
+    const val MAGIC = 0x524D434A          // 'JCMR'
+    const val VERSION = 2
+
+    const val HEADER_SIZE = 64
+    const val HEADER_MAGIC = 0
+    const val HEADER_VERSION = 4
+    const val HEADER_CAPACITY = 8
+
+    const val CONTROL_SIZE = 256
+    const val WRITE_POS = 0
+    const val READ_POS = 64
+    const val READER_WAITING = 128
+    const val WRITER_WAITING = 192
+
+    const val RECORD_HEADER_SIZE = 4
+}
+
+// Visualization stream region (see ipc_protocol.h)
+object Stream {
+    const val MAGIC = 0x564D434A          // 'JCMV'
+    const val VERSION = 1
+
+    const val HEADER_SIZE = 64
+    const val HEADER_MAGIC = 0
+    const val HEADER_VERSION = 4
+    const val HEADER_NUM_FLOATS = 8
+    const val HEADER_SLOT_SIZE = 12
+    const val HEADER_STATE = 16
+    const val HEADER_READER_SLOT = 20
+
+    const val SLOT_COUNT = 3
+    const val INDEX_MASK = 0x3
+    const val FRESH = 0x4
+}
+
+// Control channel of a shared UI process (see ipc_protocol.h)
+object Control {
+    const val OPEN_CHANNEL = 1    // Host→UI: open an editor channel (fds via SCM_RIGHTS)
+    const val MAX_FDS = 3
+    const val HEADER_SIZE = 5     // 1-byte type + 4-byte length
 }
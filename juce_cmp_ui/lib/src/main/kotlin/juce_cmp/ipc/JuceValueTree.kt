@@ -115,6 +115,15 @@ class JuceValueTree(
 
     fun removeChild(child: JuceValueTree): Boolean = children.remove(child)
 
+    /** Index of this exact child instance, or -1. */
+    fun indexOf(child: JuceValueTree): Int = children.indexOfFirst { it === child }
+
+    /** Move a child to a new index (same semantics as juce::ValueTree::moveChild). */
+    fun moveChild(currentIndex: Int, newIndex: Int) {
+        if (currentIndex !in children.indices || newIndex !in children.indices) return
+        children.add(newIndex, children.removeAt(currentIndex))
+    }
+
     fun removeAllChildren() = children.clear()
 
     // --- Binary serialization (JUCE-compatible, LITTLE-ENDIAN) ---
@@ -175,7 +184,7 @@ class JuceValueTree(
             return fromByteArray(data)
         }
 
-        private fun readFrom(buffer: ByteBuffer): JuceValueTree {
+        internal fun readFrom(buffer: ByteBuffer): JuceValueTree {
             // Type (null-terminated UTF-8 string)
             val type = JuceIO.readString(buffer)
             if (type.isEmpty()) return invalid
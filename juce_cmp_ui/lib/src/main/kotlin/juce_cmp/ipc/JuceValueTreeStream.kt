@@ -0,0 +1,517 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.ipc
+
+import java.nio.BufferUnderflowException
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/*
+ * Streaming access to the JuceValueTree binary format, without building trees.
+ *
+ * JuceValueTree allocates a map, a Var per property and a list per child for
+ * every message it decodes. For messages that stream at frame rate that is
+ * garbage the collector has to catch up with, and a collector pause stalls
+ * the reader while the host's sends back up. JuceValueTreeReader instead walks
+ * the bytes in place and hands each tree and property to a visitor, which
+ * pulls just the fields it needs. JuceValueTreeWriter encodes into a buffer
+ * it keeps across messages. Names are interned Identifiers compared by
+ * reference, so a known name costs no allocation either way.
+ *
+ * Both are wire-compatible with juce::ValueTree::writeToStream() and
+ * readFromData(), and with JuceValueTree.
+ */
+
+/**
+ * An interned type or property name, like juce::Identifier. Equal names are
+ * the same instance, so compare with ===. Intern the names a handler looks
+ * for once, e.g. in a companion object.
+ */
+class Identifier private constructor(val name: String, internal val utf8: ByteArray, private val hash: Int) {
+    override fun toString() = name
+
+    companion object {
+        private const val INITIAL_CAPACITY = 256  // Power of two
+
+        private var table = arrayOfNulls<Identifier>(INITIAL_CAPACITY)
+        private var count = 0
+
+        /** The Identifier for name, created the first time it is asked for. */
+        fun of(name: String): Identifier {
+            val utf8 = name.toByteArray(Charsets.UTF_8)
+            return intern(ByteBuffer.wrap(utf8), 0, utf8.size, hashOf(utf8, 0, utf8.size), name)
+        }
+
+        /** Look up the UTF-8 name at buffer[start, start + length), allocating only if it is new. */
+        internal fun of(buffer: ByteBuffer, start: Int, length: Int, hash: Int): Identifier =
+            intern(buffer, start, length, hash, null)
+
+        /** FNV-1a, also computed incrementally by the reader while it scans for the terminator. */
+        internal fun hashOf(bytes: ByteArray, start: Int, length: Int): Int {
+            var hash = HASH_SEED
+            for (i in start until start + length) hash = hashStep(hash, bytes[i])
+            return hash
+        }
+
+        internal const val HASH_SEED = -0x7ee3623b  // 0x811C9DC5
+        internal fun hashStep(hash: Int, byte: Byte): Int = (hash xor (byte.toInt() and 0xFF)) * 0x01000193
+
+        @Synchronized
+        private fun intern(buffer: ByteBuffer, start: Int, length: Int, hash: Int, name: String?): Identifier {
+            var slot = hash and (table.size - 1)
+            while (true) {
+                val existing = table[slot] ?: break
+                if (existing.hash == hash && existing.matches(buffer, start, length)) return existing
+                slot = (slot + 1) and (table.size - 1)
+            }
+
+            val utf8 = ByteArray(length)
+            for (i in 0 until length) utf8[i] = buffer.get(start + i)
+            val identifier = Identifier(name ?: String(utf8, Charsets.UTF_8), utf8, hash)
+            table[slot] = identifier
+            if (++count * 4 > table.size * 3) grow()
+            return identifier
+        }
+
+        private fun grow() {
+            val old = table
+            table = arrayOfNulls(old.size * 2)
+            for (identifier in old) {
+                if (identifier == null) continue
+                var slot = identifier.hash and (table.size - 1)
+                while (table[slot] != null) slot = (slot + 1) and (table.size - 1)
+                table[slot] = identifier
+            }
+        }
+    }
+
+    internal fun matches(buffer: ByteBuffer, start: Int, length: Int): Boolean {
+        if (utf8.size != length) return false
+        for (i in 0 until length) {
+            if (buffer.get(start + i) != utf8[i]) return false
+        }
+        return true
+    }
+}
+
+/**
+ * Receives the trees and properties of a message, depth first: beginTree(),
+ * its properties, its children, then endTree(). depth is 0 for the root.
+ */
+interface JuceValueTreeVisitor {
+    /** A tree begins. Return false to skip its properties and children (endTree() is still called). */
+    fun beginTree(type: Identifier, depth: Int): Boolean = true
+
+    /** A property of the current tree. value is only valid during the call. */
+    fun property(name: Identifier, value: JuceValueTreeReader.Value) {}
+
+    /** The tree that began at depth ends. */
+    fun endTree(type: Identifier, depth: Int) {}
+}
+
+/**
+ * Decodes one tree from a ByteBuffer in place, calling a visitor. Reuse one
+ * reader per thread: decoding allocates nothing but Identifiers for names not
+ * seen before, unless the visitor asks for a String or Var.
+ */
+class JuceValueTreeReader {
+    /**
+     * The value of the property being visited, a view into the message. Read
+     * it during JuceValueTreeVisitor.property(); it changes with the next one.
+     */
+    class Value internal constructor() {
+        enum class Type { VOID, INT, INT64, BOOL, DOUBLE, STRING, BINARY }
+
+        var type = Type.VOID
+            private set
+
+        private var number = 0L
+        private var real = 0.0
+        private var buffer: ByteBuffer = EMPTY
+        private var start = 0
+
+        /** Bytes of a STRING (UTF-8, without terminator) or BINARY value. */
+        var size = 0
+            private set
+
+        fun toInt(): Int = toLong().toInt()
+
+        fun toLong(): Long = when (type) {
+            Type.INT, Type.INT64, Type.BOOL -> number
+            Type.DOUBLE -> real.toLong()
+            else -> 0L
+        }
+
+        fun toDouble(): Double = if (type == Type.DOUBLE) real else toLong().toDouble()
+
+        fun toFloat(): Float = toDouble().toFloat()
+
+        fun toBool(): Boolean = if (type == Type.DOUBLE) real != 0.0 else toLong() != 0L
+
+        /** True if this is a STRING equal to text. Allocation-free. */
+        fun equalsString(text: Identifier): Boolean = type == Type.STRING && text.matches(buffer, start, size)
+
+        /** A STRING value as an interned Identifier, for enum-like strings (null otherwise). */
+        fun toIdentifier(): Identifier? =
+            if (type == Type.STRING) Identifier.of(buffer, start, size, hash()) else null
+
+        /** The value as a String. Allocates; numbers are formatted like Var.toStr(). */
+        fun toStr(): String = when (type) {
+            Type.STRING -> String(copyBytes(), Charsets.UTF_8)
+            Type.DOUBLE -> real.toString()
+            Type.BOOL -> (number != 0L).toString()
+            Type.INT, Type.INT64 -> number.toString()
+            else -> ""
+        }
+
+        /** Copy a BINARY or STRING value into dst at offset. Returns the bytes copied. */
+        fun copyTo(dst: ByteArray, offset: Int = 0): Int {
+            val n = minOf(size, dst.size - offset)
+            for (i in 0 until n) dst[offset + i] = buffer.get(start + i)
+            return n
+        }
+
+        /** The value as a Var, for code written against JuceValueTree. Allocates. */
+        fun toVar(): Var = when (type) {
+            Type.VOID -> Var.Void
+            Type.INT -> Var.IntVal(number.toInt())
+            Type.INT64 -> Var.Int64Val(number)
+            Type.BOOL -> Var.BoolVal(number != 0L)
+            Type.DOUBLE -> Var.DoubleVal(real)
+            Type.STRING -> Var.StrVal(toStr())
+            Type.BINARY -> Var.BinaryVal(copyBytes())
+        }
+
+        override fun toString() = toStr()
+
+        private fun copyBytes(): ByteArray = ByteArray(size).also { copyTo(it) }
+
+        private fun hash(): Int {
+            var hash = Identifier.HASH_SEED
+            for (i in start until start + size) hash = Identifier.hashStep(hash, buffer.get(i))
+            return hash
+        }
+
+        internal fun setNumber(type: Type, value: Long) {
+            this.type = type
+            number = value
+            size = 0
+        }
+
+        internal fun setDouble(value: Double) {
+            type = Type.DOUBLE
+            real = value
+            size = 0
+        }
+
+        internal fun setBytes(type: Type, buffer: ByteBuffer, start: Int, size: Int) {
+            this.type = type
+            this.buffer = buffer
+            this.start = start
+            this.size = size
+        }
+
+        internal fun clear() {
+            type = Type.VOID
+            buffer = EMPTY
+            size = 0
+        }
+
+        private companion object {
+            val EMPTY: ByteBuffer = ByteBuffer.allocate(0)
+        }
+    }
+
+    private val value = Value()
+
+    /**
+     * Decode the tree at the buffer's position, up to its limit, and leave the
+     * position after it. Returns false if the data is malformed or the tree is
+     * invalid (empty type); the visitor may have seen part of it by then.
+     */
+    fun read(buffer: ByteBuffer, visitor: JuceValueTreeVisitor): Boolean {
+        val order = buffer.order()
+        buffer.order(ByteOrder.LITTLE_ENDIAN)
+        return try {
+            readTree(buffer, visitor, 0, true)
+        } catch (e: BufferUnderflowException) {
+            false
+        } catch (e: Malformed) {
+            false
+        } finally {
+            value.clear()
+            buffer.order(order)
+        }
+    }
+
+    private fun readTree(buffer: ByteBuffer, visitor: JuceValueTreeVisitor, depth: Int, visit: Boolean): Boolean {
+        if (depth > MAX_DEPTH) throw Malformed
+
+        val type = readName(buffer) ?: return false
+        val visitChildren = visit && visitor.beginTree(type, depth)
+
+        repeat(readCount(buffer)) {
+            val name = readName(buffer) ?: throw Malformed
+            readValue(buffer)
+            if (visitChildren) visitor.property(name, value)
+        }
+
+        repeat(readCount(buffer)) {
+            if (!readTree(buffer, visitor, depth + 1, visitChildren)) throw Malformed
+        }
+
+        if (visit) visitor.endTree(type, depth)
+        return true
+    }
+
+    /** A NUL-terminated name, interned; null if empty. */
+    private fun readName(buffer: ByteBuffer): Identifier? {
+        val start = buffer.position()
+        var hash = Identifier.HASH_SEED
+        while (true) {
+            val byte = buffer.get()
+            if (byte == 0.toByte()) break
+            hash = Identifier.hashStep(hash, byte)
+        }
+        val length = buffer.position() - 1 - start
+        return if (length > 0) Identifier.of(buffer, start, length, hash) else null
+    }
+
+    /** juce::var::readFromStream(): compressed size, then marker and data. */
+    private fun readValue(buffer: ByteBuffer) {
+        val size = readCompressedInt(buffer)
+        if (size == 0) {
+            value.clear()
+            return
+        }
+        if (size < 0 || size > buffer.remaining()) throw Malformed
+
+        val end = buffer.position() + size
+        when (buffer.get().toInt() and 0xFF) {
+            VAR_MARKER_INT -> value.setNumber(Value.Type.INT, buffer.int.toLong())
+            VAR_MARKER_INT64 -> value.setNumber(Value.Type.INT64, buffer.long)
+            VAR_MARKER_BOOL_TRUE -> value.setNumber(Value.Type.BOOL, 1L)
+            VAR_MARKER_BOOL_FALSE -> value.setNumber(Value.Type.BOOL, 0L)
+            VAR_MARKER_DOUBLE -> value.setDouble(buffer.double)
+            // Size counts the marker and the terminator
+            VAR_MARKER_STRING -> value.setBytes(Value.Type.STRING, buffer, buffer.position(), maxOf(0, size - 2))
+            VAR_MARKER_BINARY -> value.setBytes(Value.Type.BINARY, buffer, buffer.position(), size - 1)
+            else -> value.clear()  // Undefined, or arrays (not supported, as in Var)
+        }
+        buffer.position(end)
+    }
+
+    private fun readCount(buffer: ByteBuffer): Int {
+        val count = readCompressedInt(buffer)
+        if (count < 0) throw Malformed
+        return count
+    }
+
+    /** juce::InputStream::readCompressedInt(): size byte (0x80 = negative), then LE bytes. */
+    private fun readCompressedInt(buffer: ByteBuffer): Int {
+        val sizeByte = buffer.get().toInt() and 0xFF
+        val numBytes = sizeByte and 0x7F
+        if (numBytes > 4) throw Malformed
+
+        var result = 0
+        for (i in 0 until numBytes) {
+            result = result or ((buffer.get().toInt() and 0xFF) shl (i * 8))
+        }
+        return if ((sizeByte and 0x80) != 0) -result else result
+    }
+
+    // Thrown on malformed data only, without a stack trace
+    private object Malformed : RuntimeException() {
+        override fun fillInStackTrace(): Throwable = this
+    }
+
+    private companion object {
+        const val MAX_DEPTH = 64
+    }
+}
+
+/**
+ * Encodes trees into a buffer kept across messages. Write a tree as
+ * beginTree() with its property count, that many property() calls, then
+ * children() with its child count, followed by each child written the same
+ * way. reset() starts the next message. Allocation-free once the buffer has
+ * grown to the largest message, apart from Identifiers for new names.
+ */
+class JuceValueTreeWriter(initialCapacity: Int = 1024) {
+    private var buffer: ByteBuffer = ByteBuffer.allocate(initialCapacity).order(ByteOrder.LITTLE_ENDIAN)
+    private var pendingProperties = 0
+
+    /** Bytes written since reset(). */
+    val size: Int get() = buffer.position()
+
+    /** Backing array of the encoded message, valid up to size until the next write. */
+    internal val bytes: ByteArray get() = buffer.array()
+
+    fun reset(): JuceValueTreeWriter {
+        buffer.clear()
+        pendingProperties = 0
+        return this
+    }
+
+    fun beginTree(type: Identifier, numProperties: Int): JuceValueTreeWriter {
+        check(pendingProperties == 0) { "Properties missing before the next tree" }
+        putName(type)
+        putCompressedInt(numProperties)
+        pendingProperties = numProperties
+        return this
+    }
+
+    fun children(numChildren: Int): JuceValueTreeWriter {
+        check(pendingProperties == 0) { "Properties missing before children()" }
+        putCompressedInt(numChildren)
+        return this
+    }
+
+    fun property(name: Identifier, value: Int): JuceValueTreeWriter {
+        beginProperty(name, 5)
+        buffer.put(VAR_MARKER_INT.toByte())
+        buffer.putInt(value)
+        return this
+    }
+
+    fun property(name: Identifier, value: Long): JuceValueTreeWriter {
+        beginProperty(name, 9)
+        buffer.put(VAR_MARKER_INT64.toByte())
+        buffer.putLong(value)
+        return this
+    }
+
+    fun property(name: Identifier, value: Double): JuceValueTreeWriter {
+        beginProperty(name, 9)
+        buffer.put(VAR_MARKER_DOUBLE.toByte())
+        buffer.putDouble(value)
+        return this
+    }
+
+    /** Floats are sent as doubles, as juce::var stores them. */
+    fun property(name: Identifier, value: Float): JuceValueTreeWriter = property(name, value.toDouble())
+
+    fun property(name: Identifier, value: Boolean): JuceValueTreeWriter {
+        beginProperty(name, 1)
+        buffer.put((if (value) VAR_MARKER_BOOL_TRUE else VAR_MARKER_BOOL_FALSE).toByte())
+        return this
+    }
+
+    fun property(name: Identifier, value: Identifier): JuceValueTreeWriter {
+        beginProperty(name, value.utf8.size + 2)
+        buffer.put(VAR_MARKER_STRING.toByte())
+        buffer.put(value.utf8)
+        buffer.put(0)
+        return this
+    }
+
+    /** Encoded straight from the chars, without an intermediate byte array. */
+    fun property(name: Identifier, value: CharSequence): JuceValueTreeWriter {
+        val length = utf8Length(value)
+        beginProperty(name, length + 2)
+        buffer.put(VAR_MARKER_STRING.toByte())
+        putUtf8(value)
+        buffer.put(0)
+        return this
+    }
+
+    fun property(name: Identifier, value: ByteArray, offset: Int = 0, length: Int = value.size - offset): JuceValueTreeWriter {
+        beginProperty(name, length + 1)
+        buffer.put(VAR_MARKER_BINARY.toByte())
+        buffer.put(value, offset, length)
+        return this
+    }
+
+    /** A copy of the encoded message, e.g. for JuceValueTree.fromByteArray(). */
+    fun toByteArray(): ByteArray = buffer.array().copyOf(size)
+
+    private fun beginProperty(name: Identifier, valueSize: Int) {
+        check(pendingProperties > 0) { "More properties than announced in beginTree()" }
+        --pendingProperties
+        putName(name)
+        putCompressedInt(valueSize)
+        ensure(valueSize)
+    }
+
+    private fun putName(name: Identifier) {
+        ensure(name.utf8.size + 1)
+        buffer.put(name.utf8)
+        buffer.put(0)
+    }
+
+    /** juce::OutputStream::writeCompressedInt() for a non-negative value. */
+    private fun putCompressedInt(value: Int) {
+        require(value >= 0)
+        ensure(5)
+        var numBytes = 0
+        var rest = value
+        while (rest != 0) {
+            ++numBytes
+            rest = rest ushr 8
+        }
+        buffer.put(numBytes.toByte())
+        for (i in 0 until numBytes) buffer.put((value ushr (i * 8)).toByte())
+    }
+
+    private fun putUtf8(text: CharSequence) {
+        var i = 0
+        while (i < text.length) {
+            val c = text[i++]
+            when {
+                c.code < 0x80 -> buffer.put(c.code.toByte())
+                c.code < 0x800 -> {
+                    buffer.put((0xC0 or (c.code shr 6)).toByte())
+                    buffer.put((0x80 or (c.code and 0x3F)).toByte())
+                }
+                c.isHighSurrogate() && i < text.length && text[i].isLowSurrogate() -> {
+                    val cp = Character.toCodePoint(c, text[i++])
+                    buffer.put((0xF0 or (cp shr 18)).toByte())
+                    buffer.put((0x80 or ((cp shr 12) and 0x3F)).toByte())
+                    buffer.put((0x80 or ((cp shr 6) and 0x3F)).toByte())
+                    buffer.put((0x80 or (cp and 0x3F)).toByte())
+                }
+                else -> {
+                    // Lone surrogates become U+FFFD, as String.toByteArray() does
+                    val code = if (c.isSurrogate()) 0xFFFD else c.code
+                    buffer.put((0xE0 or (code shr 12)).toByte())
+                    buffer.put((0x80 or ((code shr 6) and 0x3F)).toByte())
+                    buffer.put((0x80 or (code and 0x3F)).toByte())
+                }
+            }
+        }
+    }
+
+    private fun utf8Length(text: CharSequence): Int {
+        var length = 0
+        var i = 0
+        while (i < text.length) {
+            val c = text[i++]
+            length += when {
+                c.code < 0x80 -> 1
+                c.code < 0x800 -> 2
+                c.isHighSurrogate() && i < text.length && text[i].isLowSurrogate() -> { ++i; 4 }
+                else -> 3
+            }
+        }
+        return length
+    }
+
+    private fun ensure(bytes: Int) {
+        if (buffer.remaining() >= bytes) return
+        val grown = ByteBuffer.allocate(maxOf(buffer.capacity() * 2, buffer.position() + bytes))
+            .order(ByteOrder.LITTLE_ENDIAN)
+        buffer.flip()
+        grown.put(buffer)
+        buffer = grown
+    }
+}
+
+// JUCE VariantStreamMarkers (from juce_Variant.cpp), as in Var
+private const val VAR_MARKER_INT = 1
+private const val VAR_MARKER_BOOL_TRUE = 2
+private const val VAR_MARKER_BOOL_FALSE = 3
+private const val VAR_MARKER_DOUBLE = 4
+private const val VAR_MARKER_STRING = 5
+private const val VAR_MARKER_INT64 = 6
+private const val VAR_MARKER_BINARY = 8
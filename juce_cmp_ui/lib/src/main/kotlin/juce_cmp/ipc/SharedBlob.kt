@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.ipc
+
+import com.sun.jna.Pointer
+import java.nio.ByteBuffer
+import java.util.concurrent.atomic.AtomicBoolean
+
+/**
+ * Child side of a shared memory blob sent by the host (SharedBlob.h,
+ * ComposeComponent::sendBlob).
+ *
+ * [buffer] is a read-only direct view of the host's pages - samples, images or
+ * wavetables arrive without being copied. The mapping belongs to the receiver:
+ * call [close] once done with it. The host may already have dropped its side;
+ * the pages live until both processes have unmapped them. Accessing [buffer]
+ * after close() crashes the process.
+ */
+class SharedBlob internal constructor(
+    /** Id given by the host, e.g. to tell a newer version of the same payload. */
+    val id: Int,
+    private val base: Pointer,
+    private val mappedSize: Long,
+    size: Int
+) : AutoCloseable {
+    private val closed = AtomicBoolean(false)
+
+    /** The payload, size bytes starting at position 0. */
+    val buffer: ByteBuffer = base.getByteBuffer(0, size.toLong()).asReadOnlyBuffer()
+
+    /** Payload size in bytes. */
+    val size: Int get() = buffer.capacity()
+
+    /** Unmap the blob. Safe to call more than once. */
+    override fun close() {
+        if (closed.compareAndSet(false, true)) {
+            SocketLib.INSTANCE.shmUnmap(base, mappedSize)
+        }
+    }
+}
@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.ipc
+
+import java.lang.invoke.MethodHandles
+import java.lang.invoke.VarHandle
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Child side of the shared memory ring pair created by the host (SharedRing.h).
+ *
+ * - RX ring (host → UI): ring 0, read by the Ipc receiver thread
+ * - TX ring (UI → host): ring 1, written under the Ipc write lock
+ *
+ * Records are a 4-byte little-endian length followed by one message framed
+ * exactly as on the socket. Control words are accessed through a VarHandle
+ * so they have the same ordering guarantees as the host's std::atomic.
+ * See ipc_protocol.h for the layout.
+ */
+internal class SharedRing(private val region: ByteBuffer) {
+    private val capacity: Int
+    private val mask: Int
+    private val rxControl: Int
+    private val txControl: Int
+    private val scratch = ByteArray(ShmRing.RECORD_HEADER_SIZE)
+    private var frame = ByteArray(1024)
+
+    init {
+        region.order(ByteOrder.LITTLE_ENDIAN)
+        require(region.getInt(ShmRing.HEADER_MAGIC) == ShmRing.MAGIC) { "Invalid shared memory region" }
+        require(region.getInt(ShmRing.HEADER_VERSION) == ShmRing.VERSION) { "Unsupported shared memory version" }
+
+        capacity = region.getInt(ShmRing.HEADER_CAPACITY)
+        mask = capacity - 1
+        rxControl = ShmRing.HEADER_SIZE
+        txControl = ShmRing.HEADER_SIZE + ShmRing.CONTROL_SIZE + capacity
+    }
+
+    // ---- RX ring (Host → UI) ----
+
+    /**
+     * Pop one message. Returns a little-endian view positioned at the type byte,
+     * valid until the next call, or null if the ring is empty.
+     */
+    fun read(): ByteBuffer? {
+        val r = load(rxControl + ShmRing.READ_POS)
+        val w = load(rxControl + ShmRing.WRITE_POS)
+        val available = w - r
+        if (available < ShmRing.RECORD_HEADER_SIZE) return null
+
+        copyOut(rxControl, r, scratch, ShmRing.RECORD_HEADER_SIZE)
+        val length = ByteBuffer.wrap(scratch).order(ByteOrder.LITTLE_ENDIAN).int
+        if (length <= 0 || length > available - ShmRing.RECORD_HEADER_SIZE) {
+            // Corrupt record - discard everything written so far to resynchronize
+            store(rxControl + ShmRing.READ_POS, w)
+            return null
+        }
+
+        if (frame.size < length) frame = ByteArray(maxOf(length, frame.size * 2))
+        copyOut(rxControl, r + ShmRing.RECORD_HEADER_SIZE, frame, length)
+        store(rxControl + ShmRing.READ_POS, r + ShmRing.RECORD_HEADER_SIZE + length)
+
+        return ByteBuffer.wrap(frame, 0, length).order(ByteOrder.LITTLE_ENDIAN)
+    }
+
+    /** Check if the RX ring has unread data. */
+    val isReadable: Boolean
+        get() = load(rxControl + ShmRing.WRITE_POS) != load(rxControl + ShmRing.READ_POS)
+
+    /**
+     * Announce that the receiver is about to sleep on the socket.
+     * Returns false if data arrived meanwhile, in which case it must not sleep.
+     */
+    fun prepareWait(): Boolean {
+        store(rxControl + ShmRing.READER_WAITING, 1)
+        if (isReadable) {
+            store(rxControl + ShmRing.READER_WAITING, 0)
+            return false
+        }
+        return true
+    }
+
+    /**
+     * Returns true (and clears the flag) if the host waits for room in the RX ring
+     * and needs a wakeup. Call after read(): the volatile read position store comes first.
+     */
+    fun takeWriterWaiting(): Boolean =
+        load(rxControl + ShmRing.WRITER_WAITING) != 0 &&
+            INT.getAndSet(region, rxControl + ShmRing.WRITER_WAITING, 0) as Int != 0
+
+    // ---- TX ring (UI → Host) ----
+
+    /**
+     * Write one message (prefix + payload) as a single record.
+     * All-or-nothing: returns false without writing if there is not enough room.
+     * Callers must serialize writes.
+     */
+    fun write(prefix: ByteArray, payload: ByteArray? = null, payloadLength: Int = payload?.size ?: 0): Boolean {
+        val frameSize = prefix.size + payloadLength
+        val recordSize = ShmRing.RECORD_HEADER_SIZE + frameSize
+        if (frameSize == 0 || recordSize > capacity) return false
+
+        val w = load(txControl + ShmRing.WRITE_POS)
+        val r = load(txControl + ShmRing.READ_POS)
+        if (capacity - (w - r) < recordSize) return false
+
+        ByteBuffer.wrap(scratch).order(ByteOrder.LITTLE_ENDIAN).putInt(0, frameSize)
+        copyIn(txControl, w, scratch, ShmRing.RECORD_HEADER_SIZE)
+        copyIn(txControl, w + ShmRing.RECORD_HEADER_SIZE, prefix, prefix.size)
+        if (payload != null && payloadLength > 0) {
+            copyIn(txControl, w + ShmRing.RECORD_HEADER_SIZE + prefix.size, payload, payloadLength)
+        }
+
+        store(txControl + ShmRing.WRITE_POS, w + recordSize)
+        return true
+    }
+
+    /** Returns true (and clears the flag) if the host is sleeping and needs a wakeup. */
+    fun takeReaderWaiting(): Boolean =
+        INT.getAndSet(region, txControl + ShmRing.READER_WAITING, 0) as Int != 0
+
+    /** Check if a message of frameSize bytes fits the ring at all, once the host has read it empty. */
+    fun canHold(frameSize: Int): Boolean = frameSize > 0 && ShmRing.RECORD_HEADER_SIZE + frameSize <= capacity
+
+    /**
+     * Announce that the writer is about to wait for room. The host sends a RING
+     * wakeup once it has read from the ring; try write() again before waiting.
+     */
+    fun prepareWriterWait() = store(txControl + ShmRing.WRITER_WAITING, 1)
+
+    // ---- Wrap-around copies ----
+
+    private fun copyIn(control: Int, pos: Int, src: ByteArray, length: Int) {
+        val data = control + ShmRing.CONTROL_SIZE
+        val offset = pos and mask
+        val first = minOf(length, capacity - offset)
+        region.put(data + offset, src, 0, first)
+        if (first < length) region.put(data, src, first, length - first)
+    }
+
+    private fun copyOut(control: Int, pos: Int, dst: ByteArray, length: Int) {
+        val data = control + ShmRing.CONTROL_SIZE
+        val offset = pos and mask
+        val first = minOf(length, capacity - offset)
+        region.get(data + offset, dst, 0, first)
+        if (first < length) region.get(data, dst, first, length - first)
+    }
+
+    private fun load(offset: Int): Int = INT.getVolatile(region, offset) as Int
+
+    private fun store(offset: Int, value: Int) = INT.setVolatile(region, offset, value)
+
+    companion object {
+        // Control words are native std::atomic<uint32_t> on the host side
+        private val INT: VarHandle =
+            MethodHandles.byteBufferViewVarHandle(IntArray::class.java, ByteOrder.nativeOrder())
+    }
+}
@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.ipc
+
+import java.io.ByteArrayOutputStream
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * UI side of a ValueTree mirrored from the host (ValueTreeSync.h).
+ *
+ * The host sends the whole tree once, then one delta per change, addressed
+ * by the child-index path from the root (EventType.SYNC, in the format of
+ * juce::ValueTreeSynchroniser). Edits made through this class are applied
+ * locally and sent back the same way, so modify the tree only through it.
+ *
+ * Remote changes arrive on the Ipc thread; [onChange] is then invoked there
+ * with the node that changed. All access is serialized, so local edits may
+ * come from any thread.
+ */
+class SyncedValueTree internal constructor(private val send: (ByteArray) -> Unit) {
+    private val lock = Any()
+
+    /** The mirrored tree. Invalid until the host's first full sync. */
+    @Volatile
+    var root: JuceValueTree = JuceValueTree.invalid
+        private set
+
+    /** Called after a change from the host has been applied. */
+    @Volatile
+    var onChange: ((node: JuceValueTree) -> Unit)? = null
+
+    // ---- Host → UI ----
+
+    /**
+     * Apply one change received from the host. Returns false if its path
+     * does not exist in the mirror.
+     */
+    internal fun applyChange(data: ByteArray): Boolean {
+        if (data.isEmpty()) return false
+        val buffer = ByteBuffer.wrap(data).order(ByteOrder.LITTLE_ENDIAN)
+
+        val changed = synchronized(lock) {
+            val type = buffer.get().toInt() and 0xFF
+            if (type == SyncChange.FULL) {
+                root = JuceValueTree.readFrom(buffer)
+                return@synchronized root
+            }
+
+            val node = readPath(buffer) ?: return false
+            when (type) {
+                SyncChange.PROPERTY_CHANGED -> {
+                    val name = JuceIO.readString(buffer)
+                    node[name] = Var.readFrom(buffer)
+                }
+                SyncChange.PROPERTY_REMOVED -> node.removeProperty(JuceIO.readString(buffer))
+                SyncChange.CHILD_ADDED -> {
+                    val index = JuceIO.readCompressedInt(buffer)
+                    node.addChild(JuceValueTree.readFrom(buffer), index)
+                }
+                SyncChange.CHILD_REMOVED -> {
+                    val index = JuceIO.readCompressedInt(buffer)
+                    if (index !in 0 until node.numChildren) return false
+                    node.removeChild(index)
+                }
+                SyncChange.CHILD_MOVED -> {
+                    val oldIndex = JuceIO.readCompressedInt(buffer)
+                    val newIndex = JuceIO.readCompressedInt(buffer)
+                    if (oldIndex !in 0 until node.numChildren || newIndex !in 0 until node.numChildren) return false
+                    node.moveChild(oldIndex, newIndex)
+                }
+                else -> return false
+            }
+            node
+        }
+
+        onChange?.invoke(changed)
+        return true
+    }
+
+    private fun readPath(buffer: ByteBuffer): JuceValueTree? {
+        var node = root
+        if (!node.isValid) return null
+        val depth = JuceIO.readCompressedInt(buffer)
+        if (depth !in 0 until 65536) return null
+        repeat(depth) {
+            node = node.getChild(JuceIO.readCompressedInt(buffer)) ?: return null
+        }
+        return node
+    }
+
+    // ---- UI → Host ----
+
+    fun setProperty(node: JuceValueTree, name: String, value: Var) = edit(node, SyncChange.PROPERTY_CHANGED) { output ->
+        node[name] = value
+        JuceIO.writeString(output, name)
+        value.writeTo(output)
+    }
+
+    fun removeProperty(node: JuceValueTree, name: String) = edit(node, SyncChange.PROPERTY_REMOVED) { output ->
+        node.removeProperty(name)
+        JuceIO.writeString(output, name)
+    }
+
+    fun addChild(parent: JuceValueTree, child: JuceValueTree, index: Int = -1) = edit(parent, SyncChange.CHILD_ADDED) { output ->
+        parent.addChild(child, index)
+        JuceIO.writeCompressedInt(output, parent.indexOf(child))
+        child.writeTo(output)
+    }
+
+    fun removeChild(parent: JuceValueTree, index: Int) = edit(parent, SyncChange.CHILD_REMOVED) { output ->
+        parent.removeChild(index) ?: return@edit false
+        JuceIO.writeCompressedInt(output, index)
+    }
+
+    fun moveChild(parent: JuceValueTree, currentIndex: Int, newIndex: Int) = edit(parent, SyncChange.CHILD_MOVED) { output ->
+        if (currentIndex !in 0 until parent.numChildren || newIndex !in 0 until parent.numChildren) return@edit false
+        parent.moveChild(currentIndex, newIndex)
+        JuceIO.writeCompressedInt(output, currentIndex)
+        JuceIO.writeCompressedInt(output, newIndex)
+    }
+
+    /**
+     * Apply a local edit to node and send it to the host.
+     * Returns false (sending nothing) if node is not part of the tree or the edit was invalid.
+     */
+    private inline fun edit(node: JuceValueTree, type: Int, change: (ByteArrayOutputStream) -> Any?): Boolean {
+        val message = synchronized(lock) {
+            val path = pathOf(node) ?: return false
+            val output = ByteArrayOutputStream()
+            output.write(type)
+            JuceIO.writeCompressedInt(output, path.size)
+            path.forEach { JuceIO.writeCompressedInt(output, it) }
+            if (change(output) == false) return false
+            output.toByteArray()
+        }
+        send(message)
+        return true
+    }
+
+    /** Child indices from the root down to node, or null if node is not in the tree. */
+    private fun pathOf(node: JuceValueTree): IntArray? {
+        val path = ArrayList<Int>()
+        fun search(current: JuceValueTree): Boolean {
+            if (current === node) return true
+            for (i in 0 until current.numChildren) {
+                path.add(i)
+                if (search(current.getChild(i)!!)) return true
+                path.removeAt(path.size - 1)
+            }
+            return false
+        }
+        return if (root.isValid && search(root)) path.toIntArray() else null
+    }
+}
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.ipc
+
+import java.lang.invoke.MethodHandles
+import java.lang.invoke.VarHandle
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.FloatBuffer
+
+/**
+ * Child side of the host's visualization stream (VisualStream.h).
+ *
+ * Float frames published by the audio thread - meters, scopes, spectra, in a
+ * layout the app defines. Call [latest] once per rendered frame: it returns a
+ * view straight into shared memory, without copying or allocating, that stays
+ * unchanged until the next call. Only one thread should read.
+ */
+class VisualStream internal constructor(private val region: ByteBuffer) {
+    /** Number of floats in a frame. */
+    val size: Int
+
+    private val views: Array<FloatBuffer>
+    private var front: Int
+
+    init {
+        region.order(ByteOrder.LITTLE_ENDIAN)
+        require(region.getInt(Stream.HEADER_MAGIC) == Stream.MAGIC) { "Invalid visualization stream" }
+        require(region.getInt(Stream.HEADER_VERSION) == Stream.VERSION) { "Unsupported visualization stream version" }
+
+        size = region.getInt(Stream.HEADER_NUM_FLOATS)
+        val slotSize = region.getInt(Stream.HEADER_SLOT_SIZE)
+        views = Array(Stream.SLOT_COUNT) { index ->
+            region.duplicate()
+                .position(Stream.HEADER_SIZE + index * slotSize)
+                .limit(Stream.HEADER_SIZE + index * slotSize + size * 4)
+                .slice()
+                .order(ByteOrder.nativeOrder())
+                .asFloatBuffer()
+        }
+
+        // A previous child may have left the stream holding another slot
+        front = load(Stream.HEADER_READER_SLOT) and Stream.INDEX_MASK
+    }
+
+    /** True if a frame was published since the last [latest]. */
+    val hasNewFrame: Boolean
+        get() = load(Stream.HEADER_STATE) and Stream.FRESH != 0
+
+    /** The most recent frame, positioned at 0 with [size] floats. */
+    fun latest(): FloatBuffer {
+        if (hasNewFrame) {
+            val previous = INT.getAndSet(region, Stream.HEADER_STATE, front) as Int
+            front = previous and Stream.INDEX_MASK
+            INT.setVolatile(region, Stream.HEADER_READER_SLOT, front)
+        }
+        return views[front].also { it.rewind() }
+    }
+
+    private fun load(offset: Int): Int = INT.getVolatile(region, offset) as Int
+
+    companion object {
+        // Control words are native std::atomic<uint32_t> on the host side
+        private val INT: VarHandle =
+            MethodHandles.byteBufferViewVarHandle(IntArray::class.java, ByteOrder.nativeOrder())
+    }
+}
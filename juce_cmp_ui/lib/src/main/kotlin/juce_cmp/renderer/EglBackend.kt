@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.renderer
+
+import com.sun.jna.Library
+import com.sun.jna.Native
+import com.sun.jna.Pointer
+import com.sun.jna.ptr.IntByReference
+import juce_cmp.ipc.DmaBufSwapChain
+import org.jetbrains.skia.BackendRenderTarget
+import org.jetbrains.skia.ColorSpace
+import org.jetbrains.skia.DirectContext
+import org.jetbrains.skia.Surface
+import org.jetbrains.skia.SurfaceColorFormat
+import org.jetbrains.skia.SurfaceOrigin
+
+/**
+ * Native library for zero-copy DMA-BUF rendering (dmabuf_renderer.c).
+ *
+ * Provides a surfaceless EGL context and DMA-BUF-backed framebuffers.
+ */
+private interface EglLib : Library {
+    fun createEglContext(): Pointer?
+    fun makeEglContextCurrent(context: Pointer): Int
+    fun clearEglContextCurrent(context: Pointer)
+    fun createTextureFromDmaBuf(
+        context: Pointer, fd: Int, width: Int, height: Int, format: Int, stride: Int, offset: Int, modifier: Long,
+        outFramebuffer: IntByReference
+    ): Pointer?
+    fun releaseDmaBufTexture(context: Pointer, texture: Pointer)
+    fun commitFrameFence(context: Pointer, callback: FrameFenceCallback, token: Int)
+
+    companion object {
+        val INSTANCE: EglLib by lazy {
+            val libFile = Native.extractFromResourcePath("dmabuf_renderer")
+            Native.load(libFile.absolutePath, EglLib::class.java)
+        }
+    }
+}
+
+/** A swap chain the host sent on the socket. */
+internal class DmaBufChain(val chain: DmaBufSwapChain) : ReceivedSwapChain {
+    override val generation: Int get() = chain.generation
+    override fun release() = chain.close()
+}
+
+/**
+ * One DMA-BUF of the swap chain, imported as an EGLImage-backed texture and
+ * framebuffer, with its Skia surface.
+ */
+private class DmaBufBuffer(
+    val context: Pointer,
+    val texture: Pointer,
+    skiaSurface: Surface
+) : RenderBuffer(skiaSurface) {
+    override fun close() {
+        skiaSurface.close()
+        EglLib.INSTANCE.releaseDmaBufTexture(context, texture)
+    }
+}
+
+/**
+ * OpenGL on a surfaceless EGL context, rendering into the host's DMA-BUFs.
+ * The buffers stay in GPU memory; the host's X server presents the same pages.
+ */
+internal class EglBackend : GpuBackend {
+    private val eglContext: Pointer by lazy {
+        EglLib.INSTANCE.createEglContext() ?: error("Failed to create EGL context")
+    }
+
+    override fun makeDirectContext(): DirectContext = DirectContext.makeGL()
+
+    override fun makeCurrent() {
+        if (EglLib.INSTANCE.makeEglContextCurrent(eglContext) == 0) {
+            error("Failed to make EGL context current")
+        }
+    }
+
+    override fun doneCurrent() = EglLib.INSTANCE.clearEglContextCurrent(eglContext)
+
+    override fun openSwapChainChannel(machServiceName: String?, onSwapChain: (ReceivedSwapChain) -> Unit): AutoCloseable? = null
+
+    override fun createRenderBuffers(directContext: DirectContext, chain: ReceivedSwapChain): List<RenderBuffer> {
+        // EGL keeps its own references to the buffers, the fds can go right away
+        val dmaBufs = (chain as DmaBufChain).chain
+        try {
+            val framebuffer = IntByReference()
+            return dmaBufs.buffers.map { buffer ->
+                val texture = EglLib.INSTANCE.createTextureFromDmaBuf(
+                    eglContext, buffer.fd, dmaBufs.width, dmaBufs.height, dmaBufs.format,
+                    buffer.stride, buffer.offset, dmaBufs.modifier, framebuffer
+                ) ?: error("Failed to import DMA-BUF")
+
+                // The import bound a texture and framebuffer behind Skia's back
+                directContext.resetGLAll()
+
+                // GL_RGBA8: GL swizzles the ARGB8888 (B, G, R, A) buffer itself
+                val renderTarget = BackendRenderTarget.makeGL(
+                    dmaBufs.width, dmaBufs.height, 0, 0, framebuffer.value, GL_RGBA8
+                )
+
+                val skiaSurface = Surface.makeFromBackendRenderTarget(
+                    directContext,
+                    renderTarget,
+                    SurfaceOrigin.TOP_LEFT,
+                    SurfaceColorFormat.RGBA_8888,
+                    ColorSpace.sRGB
+                ) ?: error("Failed to create Skia Surface from BackendRenderTarget")
+
+                DmaBufBuffer(eglContext, texture, skiaSurface)
+            }
+        } finally {
+            dmaBufs.close()
+        }
+    }
+
+    override fun commitFrameFence(callback: FrameFenceCallback, token: Int) {
+        EglLib.INSTANCE.commitFrameFence(eglContext, callback, token)
+    }
+
+    private companion object {
+        const val GL_RGBA8 = 0x8058
+    }
+}
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.renderer
+
+import com.sun.jna.Callback
+import com.sun.jna.Platform
+import org.jetbrains.skia.DirectContext
+import org.jetbrains.skia.Surface
+
+/**
+ * GPU interop behind the swap chain renderer (IOSurfaceRenderer.kt).
+ *
+ * - macOS: Metal device, IOSurfaces received over the Mach channel (MetalBackend.kt)
+ * - Linux: EGL on a DRM render node, DMA-BUFs received on the socket (EglBackend.kt)
+ *
+ * There is one backend per process; SharedGpu creates the Skia context on it.
+ */
+internal interface GpuBackend {
+    /** Create Skia's context on this backend's device. Called once, with the backend current. */
+    fun makeDirectContext(): DirectContext
+
+    /**
+     * Bind the GPU context to the calling thread for Skia calls, and release it
+     * after. OpenGL contexts are current on one thread at a time; Metal needs neither.
+     */
+    fun makeCurrent() {}
+    fun doneCurrent() {}
+
+    /**
+     * Receive the host's swap chains on a background thread if they have a
+     * channel of their own (Mach on macOS). Returns null if they arrive on the socket.
+     */
+    fun openSwapChainChannel(machServiceName: String?, onSwapChain: (ReceivedSwapChain) -> Unit): AutoCloseable?
+
+    /** Wrap the buffers of a chain as Skia surfaces. Takes ownership of the chain. */
+    fun createRenderBuffers(directContext: DirectContext, chain: ReceivedSwapChain): List<RenderBuffer>
+
+    /** Invoke callback(token) once all GPU work submitted so far has completed. Call with the backend current. */
+    fun commitFrameFence(callback: FrameFenceCallback, token: Int)
+
+    companion object {
+        fun forCurrentOs(): GpuBackend = if (Platform.isMac()) MetalBackend() else EglBackend()
+    }
+}
+
+/** Invoked on a GPU driver thread once a frame's GPU work has completed. */
+internal interface FrameFenceCallback : Callback {
+    fun invoke(token: Int)
+}
+
+/**
+ * A swap chain as received from the host, before any GPU resources exist.
+ */
+internal interface ReceivedSwapChain {
+    val generation: Int
+
+    /** Release the buffers if the chain is never used. */
+    fun release()
+}
+
+/**
+ * One buffer of the swap chain with its Skia surface.
+ */
+internal abstract class RenderBuffer(val skiaSurface: Surface) : AutoCloseable {
+    /** True while another process still uses the buffer (e.g. the host's layer shows it). */
+    open val isInUse: Boolean get() = false
+}
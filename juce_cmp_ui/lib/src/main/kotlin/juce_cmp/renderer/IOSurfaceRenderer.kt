@@ -4,18 +4,20 @@
 package juce_cmp.renderer
 
 import androidx.compose.runtime.Composable
+import androidx.compose.runtime.snapshots.Snapshot
 import androidx.compose.ui.InternalComposeUiApi
 import androidx.compose.ui.graphics.asComposeCanvas
 import androidx.compose.ui.scene.CanvasLayersComposeScene
 import androidx.compose.ui.unit.Density
 import androidx.compose.ui.unit.IntSize
-import com.sun.jna.Library
-import com.sun.jna.Native
-import com.sun.jna.Pointer
-import com.sun.jna.ptr.IntByReference
 import kotlinx.coroutines.*
+import juce_cmp.ipc.FrameTiming
 import juce_cmp.ipc.Ipc
 import juce_cmp.ipc.JuceValueTree
+import juce_cmp.ipc.JuceValueTreeVisitor
+import juce_cmp.ipc.ParameterHandler
+import juce_cmp.ipc.SharedBlob
+import juce_cmp.ipc.SwapChain
 import juce_cmp.input.InputDispatcher
 import javax.sound.midi.MidiMessage
 import juce_cmp.input.InputEvent
@@ -23,12 +25,17 @@ import juce_cmp.input.InputType
 import org.jetbrains.skia.*
 import java.util.concurrent.ConcurrentLinkedQueue
 import java.util.concurrent.CountDownLatch
+import java.util.concurrent.Semaphore
 import java.util.concurrent.TimeUnit
 import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.concurrent.atomic.AtomicIntegerArray
+import java.util.concurrent.atomic.AtomicLong
 import java.util.concurrent.atomic.AtomicReference
 
 /**
- * Renders Compose content to an IOSurface using GPU-accelerated zero-copy rendering.
+ * Renders Compose content to the host's shared surfaces using GPU-accelerated
+ * zero-copy rendering: IOSurfaces on macOS, DMA-BUFs on Linux.
  *
  * @param socketFD The socket file descriptor for IPC
  * @param scaleFactor The display scale factor (e.g., 2.0 for Retina)
@@ -36,6 +43,9 @@ import java.util.concurrent.atomic.AtomicReference
  * @param onFrameRendered Optional callback invoked after each frame is rendered
  * @param onJuceEvent Optional callback when host sends events of type JUCE (JuceValueTree payload)
  * @param onMidiEvent Optional callback when host sends MIDI messages
+ * @param onParameter Optional callback for parameter values from the host
+ * @param onBlob Optional callback for shared memory blobs from the host (must close them)
+ * @param juceEventVisitor Optional decoder for JUCE events in place of onJuceEvent
  * @param content The Compose content to render
  */
 fun runIOSurfaceRenderer(
@@ -46,111 +56,132 @@ fun runIOSurfaceRenderer(
     onFrameRendered: ((frameNumber: Long, surface: Surface) -> Unit)? = null,
     onJuceEvent: ((tree: JuceValueTree) -> Unit)? = null,
     onMidiEvent: ((message: MidiMessage) -> Unit)? = null,
+    onParameter: ParameterHandler? = null,
+    onBlob: ((blob: SharedBlob) -> Unit)? = null,
+    juceEventVisitor: JuceValueTreeVisitor? = null,
     content: @Composable () -> Unit
 ) {
-    runIOSurfaceRendererImpl(socketFD, scaleFactor, machServiceName, ipc, onFrameRendered, onJuceEvent, onMidiEvent, content)
+    runIOSurfaceRendererImpl(socketFD, scaleFactor, machServiceName, ipc, onFrameRendered, onJuceEvent, onMidiEvent, onParameter, onBlob,
+        juceEventVisitor, content)
 }
 
 /**
- * Native library for zero-copy IOSurface rendering.
+ * Initialize the GPU context and compose content once offscreen, so the
+ * first real frame does not pay for Metal setup, class loading and JIT.
+ * Used by a shared UI process while it waits for its first editor, and by
+ * the build's training run (Library --training-run).
  *
- * Provides Metal device/queue pointers and IOSurface-backed textures.
+ * @param content The Compose content to render
+ * @param frames Number of frames to render, 16 ms apart
  */
-private interface NativeLib : Library {
-    fun createMetalContext(): Pointer?
-    fun destroyMetalContext(context: Pointer)
-    fun getMetalDevice(context: Pointer): Pointer?
-    fun getMetalQueue(context: Pointer): Pointer?
-    fun releaseIOSurfaceTexture(texturePtr: Pointer)
-    fun flushAndSync(context: Pointer)
-
-    // Mach channel for receiving IOSurface ports from parent
-    fun machChannelConnect(serviceName: String): Pointer?
-    fun machChannelReceiveSurface(channel: Pointer): Pointer?  // Returns IOSurfaceRef
-    fun machChannelClose(channel: Pointer)
-
-    // Create texture from IOSurface reference
-    fun createTextureFromIOSurface(context: Pointer, surface: Pointer, outWidth: IntByReference?, outHeight: IntByReference?): Pointer?
-
-    companion object {
-        val INSTANCE: NativeLib by lazy {
-            // Extract native library from JAR resources at runtime
-            val libFile = Native.extractFromResourcePath("iosurface_renderer")
-            Native.load(libFile.absolutePath, NativeLib::class.java)
+@OptIn(InternalComposeUiApi::class)
+fun warmUpIOSurfaceRenderer(content: @Composable () -> Unit, frames: Int = 1) {
+    SharedGpu.use {
+        val surface = Surface.makeRenderTarget(
+            SharedGpu.directContext, false, ImageInfo.makeN32Premul(WARM_UP_SIZE, WARM_UP_SIZE)
+        )
+        val scene = CanvasLayersComposeScene(
+            density = Density(1f),
+            size = IntSize(WARM_UP_SIZE, WARM_UP_SIZE),
+            coroutineContext = Dispatchers.Unconfined,
+            invalidate = {}
+        )
+        try {
+            scene.setContent(content)
+            val start = System.nanoTime()
+            repeat(frames) { frame ->
+                scene.render(surface.canvas.asComposeCanvas(), start + frame * WARM_UP_FRAME_NANOS)
+                surface.flushAndSubmit(syncCpu = true)
+            }
+        } finally {
+            scene.close()
+            surface.close()
         }
     }
 }
 
+private const val WARM_UP_SIZE = 256
+private const val WARM_UP_FRAME_NANOS = 16_000_000L
+
+// Frame pacing: refresh period until two vsyncs measured it, and how long a
+// FRAME_REQUEST may go unanswered (no view to refresh it) before rendering unpaced
+private const val DEFAULT_REFRESH_NANOS = 16_666_667L
+private const val VSYNC_TIMEOUT_NANOS = 100_000_000L
+
 /**
- * Holds the Skia/Metal resources for rendering to an IOSurface.
- * These need to be recreated when the window resizes.
+ * GPU backend and Skia DirectContext shared by every renderer in the process.
+ * A shared UI process runs one renderer per editor channel; they all reuse
+ * one GPU context instead of each creating their own. DirectContext is not
+ * thread-safe, so every use of it goes through [use]. Lives as long as the process.
+ */
+private object SharedGpu {
+    val lock = Any()
+
+    val backend: GpuBackend by lazy { GpuBackend.forCurrentOs() }
+
+    val directContext: DirectContext by lazy { backend.makeDirectContext() }
+
+    /** Run block with the lock held and the GPU context current on this thread. */
+    inline fun <T> use(block: () -> T): T = synchronized(lock) {
+        backend.makeCurrent()
+        try {
+            block()
+        } finally {
+            backend.doneCurrent()
+        }
+    }
+}
+
+/**
+ * Redraw request flag the render loop can sleep on.
+ * request() may be called from any thread.
+ */
+private class RedrawSignal {
+    private val lock = Object()
+    private var requested = true  // Render the first frame unconditionally
+
+    fun request() = synchronized(lock) {
+        requested = true
+        lock.notifyAll()
+    }
+
+    /** Wait up to timeoutMs for a request. Returns true (and clears it) if there was one. */
+    fun await(timeoutMs: Long): Boolean = synchronized(lock) {
+        if (!requested) lock.wait(timeoutMs)
+        val wasRequested = requested
+        requested = false
+        wasRequested
+    }
+}
+
+/**
+ * Holds the Skia/GPU resources for rendering to the host's swap chain.
+ * Recreated only when the host sends a new chain; the scene may be smaller
+ * than the buffers and renders into their top-left corner.
+ * The DirectContext belongs to SharedGpu; call close() within SharedGpu.use.
  */
 private class RenderResources(
-    val texturePtr: Pointer,
-    val directContext: DirectContext,
-    val skiaSurface: Surface,
+    val buffers: List<RenderBuffer>,
+    val generation: Int,
     val width: Int,
     val height: Int
 ) : AutoCloseable {
     override fun close() {
-        skiaSurface.close()
-        directContext.close()
-        NativeLib.INSTANCE.releaseIOSurfaceTexture(texturePtr)
+        buffers.forEach { it.close() }
     }
 }
 
 /**
- * Creates RenderResources from an IOSurface pointer (received via Mach channel).
+ * Creates RenderResources from a swap chain received from the host.
+ * Takes ownership of the chain. Call within SharedGpu.use.
  */
-private fun createRenderResourcesFromIOSurface(
-    metalContext: Pointer,
-    devicePtr: Pointer,
-    queuePtr: Pointer,
-    ioSurface: Pointer
-): RenderResources {
-    val widthRef = IntByReference()
-    val heightRef = IntByReference()
-    val texturePtr = NativeLib.INSTANCE.createTextureFromIOSurface(
-        metalContext, ioSurface, widthRef, heightRef
-    ) ?: error("Failed to create texture from IOSurface")
-
-    return createRenderResourcesFromTexture(metalContext, devicePtr, queuePtr, texturePtr, widthRef.value, heightRef.value)
+private fun createRenderResources(chain: ReceivedSwapChain): RenderResources {
+    val buffers = SharedGpu.backend.createRenderBuffers(SharedGpu.directContext, chain)
+    val first = buffers.first().skiaSurface
+    return RenderResources(buffers, chain.generation, first.width, first.height)
 }
 
-/**
- * Creates RenderResources from an already-created texture pointer.
- */
-private fun createRenderResourcesFromTexture(
-    metalContext: Pointer,
-    devicePtr: Pointer,
-    queuePtr: Pointer,
-    texturePtr: Pointer,
-    width: Int,
-    height: Int
-): RenderResources {
-    // Create Skia DirectContext using our Metal device/queue
-    val directContext = DirectContext.makeMetal(
-        Pointer.nativeValue(devicePtr),
-        Pointer.nativeValue(queuePtr)
-    )
-
-    // Create BackendRenderTarget wrapping the IOSurface-backed texture
-    val renderTarget = BackendRenderTarget.makeMetal(
-        width, height,
-        Pointer.nativeValue(texturePtr)
-    )
-
-    // Create Skia Surface from the render target
-    val skiaSurface = Surface.makeFromBackendRenderTarget(
-        directContext,
-        renderTarget,
-        SurfaceOrigin.TOP_LEFT,
-        SurfaceColorFormat.BGRA_8888,
-        ColorSpace.sRGB
-    ) ?: error("Failed to create Skia Surface from BackendRenderTarget")
-
-    return RenderResources(texturePtr, directContext, skiaSurface, width, height)
-}
+private fun micros(nanos: Long): Int = (nanos / 1000).toInt()
 
 /**
  * Zero-copy GPU-accelerated IOSurface renderer implementation.
@@ -161,16 +192,30 @@ private fun createRenderResourcesFromTexture(
  * process displays.
  *
  * Architecture:
- * 1. Host creates IOSurface and sends Mach port via bootstrap channel
- * 2. Native library receives IOSurface via Mach port IPC
- * 3. Native library creates an MTLTexture backed by the IOSurface
+ * 1. Host creates a swap chain of IOSurfaces and sends their Mach ports via bootstrap channel
+ * 2. Native library receives the IOSurfaces via Mach port IPC
+ * 3. Native library creates an MTLTexture backed by each IOSurface
  * 4. Skia's DirectContext.makeMetal() uses our Metal device/queue
- * 5. Skia's BackendRenderTarget.makeMetal() wraps the IOSurface texture
- * 6. Compose's CanvasLayersComposeScene renders to this surface
- * 7. GPU work goes directly to the IOSurface - host sees it immediately!
+ * 5. Skia's BackendRenderTarget.makeMetal() wraps each IOSurface texture
+ * 6. Compose's CanvasLayersComposeScene renders to a buffer the host is not showing
+ * 7. A Metal completion handler sends BUFFER_READY - the host flips to that buffer
+ *
+ * On Linux the chain is a set of DMA-BUFs sent on the socket (CMP_EVENT_SWAP_CHAIN),
+ * imported as EGLImage-backed GL framebuffers for DirectContext.makeGL(), and an
+ * EGL fence takes the place of the Metal completion handler (see GpuBackend).
+ *
+ * Frames are pipelined: the CPU does not wait for the GPU, except when every
+ * spare buffer is still in flight. Nothing is rendered while the scene is
+ * idle - the loop sleeps until invalidate, input, a state write or a new chain -
+ * or while the host's view is hidden (occluded, minimized).
  *
- * Surface updates (initial + resize) come through the Mach channel.
- * Input/events come through the socket.
+ * Frames are paced by the host's display: after a frame, the next one waits
+ * for a VSYNC (asked for with FRAME_REQUEST) and is timed at the refresh it
+ * will be shown on, so animations advance exactly one refresh per frame. The
+ * first frame after idle renders right away.
+ *
+ * Swap chain updates (initial + resize) come through the Mach channel on
+ * macOS and the socket on Linux. Input/events come through the socket.
  */
 @OptIn(InternalComposeUiApi::class)
 private fun runIOSurfaceRendererImpl(
@@ -181,38 +226,47 @@ private fun runIOSurfaceRendererImpl(
     onFrameRendered: ((frameNumber: Long, surface: Surface) -> Unit)? = null,
     onJuceEvent: ((tree: JuceValueTree) -> Unit)? = null,
     onMidiEvent: ((message: MidiMessage) -> Unit)? = null,
+    onParameter: ParameterHandler? = null,
+    onBlob: ((blob: SharedBlob) -> Unit)? = null,
+    juceEventVisitor: JuceValueTreeVisitor? = null,
     content: @Composable () -> Unit
 ) {
-    if (machServiceName == null) {
-        error("Mach service name is required for IOSurface sharing")
-    }
+    // Library.sendJuceEvent() from composables reaches this renderer's host
+    Ipc.current.set(ipc)
 
-    // Create Metal context (device + command queue)
-    val metalContext = NativeLib.INSTANCE.createMetalContext()
-        ?: error("Failed to create Metal context")
+    // Wakes the render loop on invalidate, input, state writes or a new swap chain
+    val redraw = RedrawSignal()
 
-    // Connect to parent's Mach channel for receiving IOSurfaces
-    val machChannel = NativeLib.INSTANCE.machChannelConnect(machServiceName)
-        ?: error("Failed to connect to Mach service '$machServiceName'")
+    // Pending swap chain from the Mach channel or the socket
+    val pendingSwapChain = AtomicReference<ReceivedSwapChain?>(null)
 
-    try {
-        // Get Metal device and queue pointers for Skia
-        val devicePtr = NativeLib.INSTANCE.getMetalDevice(metalContext)
-            ?: error("Failed to get Metal device")
-        val queuePtr = NativeLib.INSTANCE.getMetalQueue(metalContext)
-            ?: error("Failed to get Metal queue")
+    // Latch for initial surface arrival
+    val initialSurfaceLatch = CountDownLatch(1)
 
-        // Track if scene needs redraw (atomic for thread safety)
-        val needsRedraw = AtomicBoolean(true)
+    val onSwapChain = { chain: ReceivedSwapChain ->
+        // A chain superseded before the render loop picked it up is never used
+        pendingSwapChain.getAndSet(chain)?.release()
+        initialSurfaceLatch.countDown()
+        redraw.request()
+    }
+
+    // Connect to parent's Mach channel for receiving IOSurfaces (macOS)
+    val swapChainChannel = SharedGpu.backend.openSwapChainChannel(machServiceName, onSwapChain)
+
+    try {
+        val stateObserver = Snapshot.registerGlobalWriteObserver { redraw.request() }
 
         // Pending resize event from socket
         val pendingResize = AtomicReference<InputEvent?>(null)
 
-        // Pending IOSurface from Mach channel
-        val pendingIOSurface = AtomicReference<Pointer?>(null)
+        // Generation of a chain the host released when its editor closed (-1 = none)
+        val pendingDetach = AtomicInteger(-1)
 
-        // Latch for initial surface arrival
-        val initialSurfaceLatch = CountDownLatch(1)
+        // False while the host's view cannot be seen
+        val hostVisible = AtomicBoolean(true)
+
+        // Presentation time of the latest VSYNC not rendered for yet (0 = none)
+        val pendingVsync = AtomicLong(0L)
 
         // Event queue for input events
         val eventQueue = ConcurrentLinkedQueue<InputEvent>()
@@ -225,58 +279,123 @@ private fun runIOSurfaceRendererImpl(
                 } else {
                     eventQueue.offer(event)
                 }
-                needsRedraw.set(true)
+                redraw.request()
             },
             onJuceEvent = onJuceEvent,
-            onMidiEvent = onMidiEvent
+            onMidiEvent = onMidiEvent,
+            onParameter = onParameter,
+            onBlob = onBlob,
+            onDetach = { generation ->
+                pendingDetach.set(generation)
+                redraw.request()
+            },
+            onSwapChain = { chain -> onSwapChain(DmaBufChain(chain)) },
+            onVisibility = { visible ->
+                hostVisible.set(visible)
+                redraw.request()
+            },
+            onVsync = { _, presentNanos ->
+                pendingVsync.set(presentNanos)
+                redraw.request()
+            },
+            juceEventVisitor = juceEventVisitor
         )
 
-        // Start thread to receive IOSurfaces from Mach channel
-        val surfaceReceiverThread = Thread {
-            while (ipc.isRunning) {
-                val surface = NativeLib.INSTANCE.machChannelReceiveSurface(machChannel)
-                if (surface != null) {
-                    pendingIOSurface.set(surface)
-                    initialSurfaceLatch.countDown()
-                    needsRedraw.set(true)
-                } else {
-                    break  // Channel closed
-                }
-            }
-        }.apply {
-            name = "MachSurfaceReceiver"
-            isDaemon = true
-            start()
-        }
+        // Create the Skia context while the host sends the swap chain
+        SharedGpu.use { SharedGpu.directContext }
 
-        // Wait for initial IOSurface from Mach channel (non-blocking wait with timeout)
+        // Wait for the initial swap chain (non-blocking wait with timeout)
         if (!initialSurfaceLatch.await(5, TimeUnit.SECONDS)) {
-            error("Timeout waiting for initial IOSurface")
+            error("Timeout waiting for initial swap chain")
         }
-        val initialSurface = pendingIOSurface.getAndSet(null)
+        val initialSwapChain = pendingSwapChain.getAndSet(null)
 
-        if (initialSurface == null) {
-            error("Failed to receive initial IOSurface")
+        if (initialSwapChain == null) {
+            error("Failed to receive initial swap chain")
         }
 
-        // Create initial render resources
-        var resources = createRenderResourcesFromIOSurface(metalContext, devicePtr, queuePtr, initialSurface)
+        // Create initial render resources (null while the host editor is closed)
+        val initialResources = SharedGpu.use { createRenderResources(initialSwapChain) }
+        var resources: RenderResources? = initialResources
+
+        // Frame pacing: every buffer but the one the host shows can be in flight
+        val maxFramesInFlight = maxOf(1, initialResources.buffers.size - 1)
+        val framesInFlight = Semaphore(maxFramesInFlight)
+        val bufferInFlight = AtomicIntegerArray(SwapChain.MAX_BUFFERS)
+        val lastCompleted = AtomicInteger(-1)
+        var lastBuffer = -1
+
+        // Per-buffer costs, reported with BUFFER_READY while the host collects timings
+        val frameTimings = Array(SwapChain.MAX_BUFFERS) { FrameTiming() }
+        val submitNanos = LongArray(SwapChain.MAX_BUFFERS)
+
+        // Token: first-frame flag (bit 16) | generation (bits 8-15) | buffer index (bits 0-7)
+        val frameFence = object : FrameFenceCallback {
+            override fun invoke(token: Int) {
+                val index = token and 0xFF
+                lastCompleted.set(index)
+                bufferInFlight.set(index, 0)
+                framesInFlight.release()
+                if (ipc.isTimingEnabled) {
+                    val timing = frameTimings[index]
+                    timing.gpuMicros = micros(System.nanoTime() - submitNanos[index])
+                    ipc.sendFrameTiming((token shr 8) and 0xFF, index, timing)
+                }
+                ipc.sendBufferReady((token shr 8) and 0xFF, index)
+                if (token and 0x10000 != 0) {
+                    ipc.sendSurfaceReady()
+                }
+            }
+        }
+
+        // Pick a buffer that is neither in flight nor the latest one handed to the host
+        fun nextBuffer(resources: RenderResources): Int {
+            val count = resources.buffers.size
+            val shown = lastCompleted.get()
+            var fallback = -1
+            for (step in 1..count) {
+                val i = (lastBuffer + step).mod(count)
+                if (bufferInFlight.get(i) != 0 || (i == shown && count > 1)) continue
+                if (!resources.buffers[i].isInUse) return i
+                if (fallback < 0) fallback = i
+            }
+            return if (fallback >= 0) fallback else (lastBuffer + 1).mod(count)
+        }
 
         // Track current scale factor
         var currentScale = scaleFactor
 
+        // Scene size and scale the host asked for; the chain may be bigger
+        var sceneWidth = initialResources.width
+        var sceneHeight = initialResources.height
+        var sceneScale = scaleFactor
+
         // Create Compose scene
         var scene = CanvasLayersComposeScene(
             density = Density(currentScale),
-            size = IntSize(resources.width, resources.height),
+            size = IntSize(initialResources.width, initialResources.height),
             coroutineContext = Dispatchers.Unconfined,
-            invalidate = { needsRedraw.set(true) }
+            invalidate = { redraw.request() }
         )
         scene.setContent(content)
 
+        // Let in-flight frames finish before their buffers go away
+        fun awaitFramesInFlight() {
+            if (framesInFlight.tryAcquire(maxFramesInFlight, 1, TimeUnit.SECONDS)) {
+                framesInFlight.release(maxFramesInFlight)
+            }
+        }
+
         // Input dispatcher
         var inputDispatcher = InputDispatcher(scene, currentScale)
 
+        // Frame pacing state (render loop only)
+        var refreshNanos = DEFAULT_REFRESH_NANOS
+        var lastVsyncNanos = 0L
+        var pacedUntil = 0L         // A frame needed before this waits for a VSYNC
+        var frameRequestNanos = 0L  // When the outstanding FRAME_REQUEST was sent (0 = none)
+        var lastFrameTime = 0L
+
         try {
             // Render loop
             runBlocking {
@@ -285,32 +404,58 @@ private fun runIOSurfaceRendererImpl(
 
                 while (ipc.isRunning) {
                     try {
+                        // Idle until something changes; the timeout only lets us notice shutdown,
+                        // or a FRAME_REQUEST that went unanswered
+                        if (!redraw.await(100) && frameRequestNanos == 0L) continue
+                        Snapshot.sendApplyNotifications()
+
                         val frameStart = System.nanoTime()
 
-                        // Check for new IOSurface (resize)
-                        val newSurface = pendingIOSurface.getAndSet(null)
-                        val resizeEvent = pendingResize.getAndSet(null)
+                        // Editor closed - drop its chain but keep the scene and its state
+                        val detachedGeneration = pendingDetach.getAndSet(-1)
+                        if (detachedGeneration >= 0 && resources?.generation == detachedGeneration) {
+                            awaitFramesInFlight()
+                            SharedGpu.use { resources?.close() }
+                            resources = null
+                        }
 
-                        if (newSurface != null) {
-                            // New surface arrived - swap it in
-                            resources.close()
-                            resources = createRenderResourcesFromIOSurface(metalContext, devicePtr, queuePtr, newSurface)
+                        // Check for new swap chain (resize, or an editor reopening)
+                        val newSwapChain = pendingSwapChain.getAndSet(null)
+                        val resizeEvent = pendingResize.getAndSet(null)
 
-                            // Update scene size from resize event if available, otherwise from surface dimensions
-                            val newWidth = resizeEvent?.width ?: resources.width
-                            val newHeight = resizeEvent?.height ?: resources.height
-                            val newScale = resizeEvent?.scaleFactor ?: currentScale
+                        if (resizeEvent != null) {
+                            sceneWidth = resizeEvent.width
+                            sceneHeight = resizeEvent.height
+                            sceneScale = resizeEvent.scaleFactor
+                        }
 
-                            scene.size = IntSize(newWidth, newHeight)
+                        if (newSwapChain != null) {
+                            // New chain arrived - let in-flight frames finish, then swap it in
+                            awaitFramesInFlight()
+                            resources = SharedGpu.use {
+                                resources?.close()
+                                createRenderResources(newSwapChain)
+                            }
+                            lastBuffer = -1
+                            lastCompleted.set(-1)
+                        }
 
-                            if (newScale != currentScale) {
-                                currentScale = newScale
-                                scene.close()
+                        // The host over-allocates chains, so most resizes only change the
+                        // scene size within the current buffers. A size that does not fit
+                        // waits for the chain that follows it.
+                        val current = resources
+                        val fits = current != null && sceneWidth <= current.width && sceneHeight <= current.height
+                        if ((newSwapChain != null || resizeEvent != null) && fits) {
+                            scene.size = IntSize(sceneWidth, sceneHeight)
+
+                            if (sceneScale != currentScale) {
+                                currentScale = sceneScale
+                                SharedGpu.use { scene.close() }
                                 scene = CanvasLayersComposeScene(
                                     density = Density(currentScale),
-                                    size = IntSize(newWidth, newHeight),
+                                    size = IntSize(sceneWidth, sceneHeight),
                                     coroutineContext = Dispatchers.Unconfined,
-                                    invalidate = { needsRedraw.set(true) }
+                                    invalidate = { redraw.request() }
                                 )
                                 scene.setContent(content)
                                 inputDispatcher = InputDispatcher(scene, currentScale)
@@ -318,30 +463,82 @@ private fun runIOSurfaceRendererImpl(
                                 inputDispatcher.scaleFactor = currentScale
                             }
 
-                            needsRedraw.set(true)
+                            // SURFACE_READY tells the host the new size is on screen
                             surfaceChanged = true
                         }
 
-                        // Process input events
-                        while (true) {
-                            val event = eventQueue.poll() ?: break
-                            inputDispatcher.dispatch(event)
+                        // Process input events (moves and scrolls coalesced per frame)
+                        val dispatchStart = System.nanoTime()
+                        inputDispatcher.dispatchAll(eventQueue)
+                        val dispatchEnd = System.nanoTime()
+
+                        // Paused until an editor reattaches with a new chain, and while
+                        // hidden; the frame after the view shows again catches up
+                        val target = resources
+                        if (target == null || !hostVisible.get()) {
+                            frameRequestNanos = 0L
+                            continue
                         }
 
-                        // Render
-                        val canvas = resources.skiaSurface.canvas
-                        scene.render(canvas.asComposeCanvas(), frameStart)
-                        resources.skiaSurface.flushAndSubmit(syncCpu = true)
-
-                        onFrameRendered?.invoke(frameCount.toLong(), resources.skiaSurface)
+                        // Render on the host's refresh, at the time it will be shown
+                        var frameTime = frameStart
+                        val vsyncNanos = pendingVsync.getAndSet(0L)
+                        if (vsyncNanos != 0L) {
+                            val period = vsyncNanos - lastVsyncNanos
+                            if (lastVsyncNanos != 0L && period in 2_000_000L..50_000_000L) refreshNanos = period
+                            lastVsyncNanos = vsyncNanos
+                            frameTime = vsyncNanos
+                            frameRequestNanos = 0L
+                        } else if (frameStart < pacedUntil) {
+                            if (frameRequestNanos == 0L) {
+                                ipc.sendFrameRequest()
+                                frameRequestNanos = frameStart
+                            }
+                            if (frameStart - frameRequestNanos < VSYNC_TIMEOUT_NANOS) continue
+                            frameRequestNanos = 0L
+                        }
+                        pacedUntil = if (vsyncNanos != 0L) vsyncNanos else frameStart + refreshNanos
+                        frameTime = maxOf(frameTime, lastFrameTime)
+                        lastFrameTime = frameTime
+
+                        // Render into a spare buffer without waiting for the GPU
+                        framesInFlight.acquire()
+                        val index = nextBuffer(target)
+                        val buffer = target.buffers[index]
+                        val timing = frameTimings[index]
+                        try {
+                            SharedGpu.use {
+                                val renderStart = System.nanoTime()
+                                scene.render(buffer.skiaSurface.canvas.asComposeCanvas(), frameTime)
+                                val renderEnd = System.nanoTime()
+                                buffer.skiaSurface.flushAndSubmit(syncCpu = false)
+                                submitNanos[index] = System.nanoTime()
+                                timing.renderMicros = micros(renderEnd - renderStart)
+                                timing.flushMicros = micros(submitNanos[index] - renderEnd)
+                            }
+                        } catch (e: Exception) {
+                            framesInFlight.release()
+                            throw e
+                        }
 
-                        // Notify host when new surface is ready (initial or resize)
-                        if (surfaceChanged) {
-                            ipc.sendSurfaceReady()
-                            surfaceChanged = false
+                        timing.inputTimestamp = inputDispatcher.oldestTimestamp
+                        timing.queueMicros = if (timing.inputTimestamp != 0L) {
+                            micros(dispatchStart - inputDispatcher.oldestReceivedNanos)
+                        } else 0
+                        timing.dispatchMicros = micros(dispatchEnd - dispatchStart)
+
+                        // Host is notified (BUFFER_READY, plus SURFACE_READY on a new chain) once the GPU is done
+                        bufferInFlight.set(index, 1)
+                        lastBuffer = index
+                        val token = (if (surfaceChanged) 0x10000 else 0) or (target.generation shl 8) or index
+                        SharedGpu.use { SharedGpu.backend.commitFrameFence(frameFence, token) }
+                        surfaceChanged = false
+
+                        onFrameRendered?.let { callback ->
+                            SharedGpu.use { callback(frameCount.toLong(), buffer.skiaSurface) }
                         }
+
                         frameCount++
-                        needsRedraw.set(false)
                     } catch (e: CancellationException) {
                         throw e
                     } catch (e: Exception) {
@@ -350,12 +547,16 @@ private fun runIOSurfaceRendererImpl(
                 }
             }
         } finally {
+            stateObserver.dispose()
             ipc.stopReceiving()
-            scene.close()
-            resources.close()
+            framesInFlight.tryAcquire(maxFramesInFlight, 1, TimeUnit.SECONDS)
+            SharedGpu.use {
+                scene.close()
+                resources?.close()
+            }
+            pendingSwapChain.getAndSet(null)?.release()
         }
     } finally {
-        NativeLib.INSTANCE.machChannelClose(machChannel)
-        NativeLib.INSTANCE.destroyMetalContext(metalContext)
+        swapChainChannel?.close()
     }
 }
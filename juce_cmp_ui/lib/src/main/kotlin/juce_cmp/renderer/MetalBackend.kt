@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2026 Luciano Iam <oss@lucianoiam.com>
+// SPDX-License-Identifier: MIT
+
+package juce_cmp.renderer
+
+import com.sun.jna.Library
+import com.sun.jna.Memory
+import com.sun.jna.Native
+import com.sun.jna.Pointer
+import com.sun.jna.ptr.IntByReference
+import juce_cmp.ipc.SwapChain
+import org.jetbrains.skia.BackendRenderTarget
+import org.jetbrains.skia.ColorSpace
+import org.jetbrains.skia.DirectContext
+import org.jetbrains.skia.Surface
+import org.jetbrains.skia.SurfaceColorFormat
+import org.jetbrains.skia.SurfaceOrigin
+
+/**
+ * Native library for zero-copy IOSurface rendering.
+ *
+ * Provides Metal device/queue pointers and IOSurface-backed textures.
+ */
+private interface NativeLib : Library {
+    fun createMetalContext(): Pointer?
+    fun destroyMetalContext(context: Pointer)
+    fun getMetalDevice(context: Pointer): Pointer?
+    fun getMetalQueue(context: Pointer): Pointer?
+    fun releaseIOSurfaceTexture(texturePtr: Pointer)
+    fun flushAndSync(context: Pointer)
+    fun commitFrameFence(context: Pointer, callback: FrameFenceCallback, token: Int)
+
+    // Mach channel for receiving IOSurface ports from parent
+    fun machChannelConnect(serviceName: String): Pointer?
+    fun machChannelReceiveSwapChain(channel: Pointer, outSurfaces: Pointer, maxSurfaces: Int, outGeneration: IntByReference): Int
+    fun machChannelClose(channel: Pointer)
+    fun releaseIOSurface(surface: Pointer)
+    fun ioSurfaceIsInUse(surface: Pointer): Int
+
+    // Create texture from IOSurface reference
+    fun createTextureFromIOSurface(context: Pointer, surface: Pointer, outWidth: IntByReference?, outHeight: IntByReference?): Pointer?
+
+    companion object {
+        val INSTANCE: NativeLib by lazy {
+            // Extract native library from JAR resources at runtime
+            val libFile = Native.extractFromResourcePath("iosurface_renderer")
+            Native.load(libFile.absolutePath, NativeLib::class.java)
+        }
+    }
+}
+
+/**
+ * A swap chain of IOSurfaces received through the Mach channel.
+ */
+private class IOSurfaceSwapChain(override val generation: Int, val surfaces: List<Pointer>) : ReceivedSwapChain {
+    override fun release() = surfaces.forEach { NativeLib.INSTANCE.releaseIOSurface(it) }
+}
+
+/**
+ * One IOSurface of the swap chain with its Metal texture and Skia surface.
+ */
+private class IOSurfaceBuffer(
+    val ioSurface: Pointer,
+    val texturePtr: Pointer,
+    skiaSurface: Surface
+) : RenderBuffer(skiaSurface) {
+    override val isInUse: Boolean get() = NativeLib.INSTANCE.ioSurfaceIsInUse(ioSurface) != 0
+
+    override fun close() {
+        skiaSurface.close()
+        NativeLib.INSTANCE.releaseIOSurfaceTexture(texturePtr)
+        NativeLib.INSTANCE.releaseIOSurface(ioSurface)
+    }
+}
+
+/**
+ * Metal device and command queue, rendering into IOSurface-backed textures.
+ */
+internal class MetalBackend : GpuBackend {
+    private val metalContext: Pointer by lazy {
+        NativeLib.INSTANCE.createMetalContext() ?: error("Failed to create Metal context")
+    }
+
+    override fun makeDirectContext(): DirectContext {
+        val devicePtr = NativeLib.INSTANCE.getMetalDevice(metalContext)
+            ?: error("Failed to get Metal device")
+        val queuePtr = NativeLib.INSTANCE.getMetalQueue(metalContext)
+            ?: error("Failed to get Metal queue")
+        return DirectContext.makeMetal(Pointer.nativeValue(devicePtr), Pointer.nativeValue(queuePtr))
+    }
+
+    override fun openSwapChainChannel(machServiceName: String?, onSwapChain: (ReceivedSwapChain) -> Unit): AutoCloseable {
+        if (machServiceName == null) {
+            error("Mach service name is required for IOSurface sharing")
+        }
+
+        val machChannel = NativeLib.INSTANCE.machChannelConnect(machServiceName)
+            ?: error("Failed to connect to Mach service '$machServiceName'")
+
+        // Receives until the channel is closed
+        Thread {
+            val surfaces = Memory(Native.POINTER_SIZE.toLong() * SwapChain.MAX_BUFFERS)
+            val generation = IntByReference()
+            while (true) {
+                val count = NativeLib.INSTANCE.machChannelReceiveSwapChain(
+                    machChannel, surfaces, SwapChain.MAX_BUFFERS, generation
+                )
+                if (count <= 0) break
+                onSwapChain(IOSurfaceSwapChain(
+                    generation.value and 0xFF,
+                    List(count) { surfaces.getPointer(it.toLong() * Native.POINTER_SIZE) }
+                ))
+            }
+        }.apply {
+            name = "MachSurfaceReceiver"
+            isDaemon = true
+            start()
+        }
+
+        return AutoCloseable { NativeLib.INSTANCE.machChannelClose(machChannel) }
+    }
+
+    override fun createRenderBuffers(directContext: DirectContext, chain: ReceivedSwapChain): List<RenderBuffer> {
+        val widthRef = IntByReference()
+        val heightRef = IntByReference()
+
+        return (chain as IOSurfaceSwapChain).surfaces.map { ioSurface ->
+            val texturePtr = NativeLib.INSTANCE.createTextureFromIOSurface(
+                metalContext, ioSurface, widthRef, heightRef
+            ) ?: error("Failed to create texture from IOSurface")
+
+            // Create BackendRenderTarget wrapping the IOSurface-backed texture
+            val renderTarget = BackendRenderTarget.makeMetal(
+                widthRef.value, heightRef.value,
+                Pointer.nativeValue(texturePtr)
+            )
+
+            // Create Skia Surface from the render target
+            val skiaSurface = Surface.makeFromBackendRenderTarget(
+                directContext,
+                renderTarget,
+                SurfaceOrigin.TOP_LEFT,
+                SurfaceColorFormat.BGRA_8888,
+                ColorSpace.sRGB
+            ) ?: error("Failed to create Skia Surface from BackendRenderTarget")
+
+            IOSurfaceBuffer(ioSurface, texturePtr, skiaSurface)
+        }
+    }
+
+    override fun commitFrameFence(callback: FrameFenceCallback, token: Int) {
+        NativeLib.INSTANCE.commitFrameFence(metalContext, callback, token)
+    }
+}
@@ -7,13 +7,18 @@ import org.jetbrains.skia.*
 import java.io.File
 import java.nio.file.Files
 import java.nio.file.Paths
+import java.util.concurrent.ConcurrentLinkedQueue
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.Executors
+import java.util.concurrent.atomic.AtomicInteger
 
 /**
  * Captures the current Skia Surface content to a PNG file.
  *
  * This is a generic extension function that works with any Skia Surface, regardless of
  * the underlying backend (Metal, OpenGL, Raster, IOSurface-backed, etc.). It takes a
- * snapshot of the surface and encodes it as a PNG image file.
+ * snapshot of the surface and encodes it as a PNG image file. Everything happens on the
+ * calling thread; use [FrameCapture] to capture from the render loop.
  *
  * @param outputPath The file path where the PNG should be saved
  * @return true if the capture was successful, false otherwise
@@ -101,11 +106,120 @@ fun Surface.captureFrameToPNG(outputPath: String): Boolean {
  */
 fun captureFirstFrame(outputPath: String): (frameNumber: Long, surface: Surface) -> Unit {
     var captured = false
+    val capture = FrameCapture(poolSize = 1)
 
     return { frameNumber, surface ->
         if (!captured && frameNumber == 0L) {
             captured = true
-            surface.captureFrameToPNG(outputPath)
+            capture.captureToPNG(surface, outputPath) { capture.close() }
         }
     }
 }
+
+/**
+ * Captures frames from the render loop (onFrameRendered) without stalling it
+ * on encoding or file I/O.
+ *
+ * capture() reads the surface's pixels straight into a pooled bitmap and hands
+ * it to a background thread, which passes it to the callback and then returns
+ * it to the pool. Skiko exposes no asynchronous GPU readback, so that one read
+ * still waits for the GPU, but no raster surface or snapshot image is created
+ * per frame and nothing else runs on the render thread. At most poolSize
+ * captures are in flight; while they all are, capture() skips the frame.
+ * Suited to periodic thumbnails.
+ */
+class FrameCapture(private val poolSize: Int = 2) : AutoCloseable {
+    private val encoder: ExecutorService = Executors.newSingleThreadExecutor { runnable ->
+        Thread(runnable, "FrameCapture").apply { isDaemon = true }
+    }
+
+    // Bitmaps not in flight, reused while the captured size stays the same
+    private val pool = ConcurrentLinkedQueue<Bitmap>()
+    private val inFlight = AtomicInteger(0)
+
+    /**
+     * Read width x height pixels from the top-left of surface (the scene may be
+     * smaller than its swap chain buffer) and call onPixels with them on the
+     * capture thread. The bitmap is only valid during the call. Call on the
+     * thread that renders into surface. Returns false if the frame was skipped.
+     */
+    fun capture(
+        surface: Surface,
+        width: Int = surface.width,
+        height: Int = surface.height,
+        onPixels: (Bitmap) -> Unit
+    ): Boolean {
+        if (width <= 0 || height <= 0 || encoder.isShutdown) return false
+        if (inFlight.incrementAndGet() > poolSize) {
+            inFlight.decrementAndGet()
+            return false
+        }
+
+        val bitmap = takeBitmap(width, height)
+        if (!surface.readPixels(bitmap, 0, 0)) {
+            recycle(bitmap)
+            return false
+        }
+
+        encoder.execute {
+            try {
+                onPixels(bitmap)
+            } finally {
+                recycle(bitmap)
+            }
+        }
+        return true
+    }
+
+    /**
+     * Capture as capture() does and write the pixels to a PNG file on the capture
+     * thread. onDone runs there too, with whether the file was written.
+     */
+    fun captureToPNG(
+        surface: Surface,
+        outputPath: String,
+        width: Int = surface.width,
+        height: Int = surface.height,
+        onDone: ((success: Boolean) -> Unit)? = null
+    ): Boolean = capture(surface, width, height) { bitmap ->
+        val written = try {
+            writePNG(bitmap, outputPath)
+        } catch (e: Exception) {
+            false
+        }
+        onDone?.invoke(written)
+    }
+
+    /** Stop taking captures. Those in flight still complete, then free their bitmaps. */
+    override fun close() {
+        encoder.shutdown()
+        while (true) pool.poll()?.close() ?: break
+    }
+
+    private fun takeBitmap(width: Int, height: Int): Bitmap {
+        while (true) {
+            val bitmap = pool.poll() ?: break
+            if (bitmap.width == width && bitmap.height == height) return bitmap
+            bitmap.close()
+        }
+        return Bitmap().apply { allocN32Pixels(width, height) }
+    }
+
+    private fun recycle(bitmap: Bitmap) {
+        if (encoder.isShutdown) bitmap.close() else pool.offer(bitmap)
+        inFlight.decrementAndGet()
+    }
+
+    private fun writePNG(bitmap: Bitmap, outputPath: String): Boolean {
+        val image = Image.makeFromBitmap(bitmap)
+        val data = image.encodeToData(EncodedImageFormat.PNG)
+        image.close()
+        if (data == null) return false
+
+        val bytes = data.bytes
+        data.close()
+        File(outputPath).parentFile?.mkdirs()
+        Files.write(Paths.get(outputPath), bytes)
+        return true
+    }
+}